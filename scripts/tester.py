@@ -564,6 +564,13 @@ if __name__ == "__main__":
                    '--cegar',
                    '--case_splits',
                    '--cegar --case_splits',
+                   '--polarity phase',
+                   '--debugging --chrono',
+                   '--preprocess --cegar',
+                   '--cegar_cores --debugging --sat_by_qbf -c cert.aag',
+                   '--portfolio 4',
+                   '--portfolio 4 --debugging --sat_by_qbf -c cert.aag',
+                   '--preprocess --debugging --sat_by_qbf -c cert.aag',
                    '--debugging --sat_by_qbf -c cert.aag',
                    'RESULT_SAT --debugging --sat_by_qbf -f cert.aag',
                    'RESULT_SAT --debugging --sat_by_qbf -e cert.aag',
@@ -8,8 +8,11 @@
 
 #include "aiger_utils.h"
 #include "log.h"
+#include "util.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 int aiger_lit2lit(unsigned aigerlit, int truelit) {
     if (aigerlit == aiger_true) {
@@ -45,144 +48,368 @@ unsigned var2aigerlit(unsigned var_id) {
     return 2 * var_id;
 }
 
-unsigned aigeru_multiAND(aiger* a, unsigned* max_sym, int_vector* input_aigerlits) {
-    unsigned outputlit = inc(max_sym);
-    aigeru_add_multiAND(a, max_sym, outputlit, input_aigerlits);
-    return outputlit;
-}
-
-void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
-    assert(!is_negated(output_aigerlit));
-    if (int_vector_count(input_aigerlits) == 0) {
-        aiger_add_and(a, output_aigerlit, aiger_true, aiger_true); // empty AND is true
-        return;
-    }
-    unsigned cur_output = aiger_true;
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits) - 1; i++) {
-        unsigned input_aigerlit = (unsigned) int_vector_get(input_aigerlits, i);
-        cur_output = aigeru_AND(a, max_sym, cur_output, input_aigerlit);
-    }
-    unsigned last_lit = (unsigned) int_vector_get(input_aigerlits, int_vector_count(input_aigerlits) - 1);
-    aiger_add_and(a, output_aigerlit, cur_output, last_lit);
-}
-
-//void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
-//    assert(!is_negated(output_aigerlit));
-//    if (int_vector_count(input_aigerlits) == 0) {
-//        aiger_add_and(a, output_aigerlit, aiger_true, aiger_true); // empty AND is true
-//        return;
-//    }
-//    if (int_vector_count(input_aigerlits) == 1) {
-//        unsigned last_lit = (unsigned) int_vector_get(input_aigerlits, 0);
-//        aiger_add_and(a, output_aigerlit, last_lit, last_lit); // empty AND is true
-//        return;
-//    }
-//    assert(int_vector_count(input_aigerlits) >= 2); // can define a proper AND
-//    unsigned cur_outputlit = output_aigerlit;
-//    for (unsigned i = 0; i < int_vector_count(input_aigerlits) - 2; i++) {
-//        unsigned input_aigerlit = (unsigned) int_vector_get(input_aigerlits, i);
-//        unsigned next_outputlit = inc(max_sym);
-//        aiger_add_and(a, cur_outputlit, next_outputlit, input_aigerlit);
-//        cur_outputlit = next_outputlit;
-//    }
-//    unsigned last_lit = (unsigned) int_vector_get(input_aigerlits, int_vector_count(input_aigerlits) - 1);
-//    unsigned second_to_last_lit = (unsigned) int_vector_get(input_aigerlits, int_vector_count(input_aigerlits) - 2);
-//    aiger_add_and(a, cur_outputlit, last_lit, second_to_last_lit);
-//}
-
-void aigeru_add_OR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, unsigned i1, unsigned i2) {
-    unsigned negated_outputlit = 0;
-    if (is_negated(output_aigerlit)) {
-        negated_outputlit = negate(output_aigerlit);
-    } else {
-        negated_outputlit = inc(max_sym);
-        aiger_add_and(a, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
+AigerBuilder* aigeru_builder_init(unsigned max_sym) {
+    assert(!is_negated(max_sym));
+    AigerBuilder* b = malloc(sizeof(AigerBuilder));
+    b->max_sym = max_sym;
+    b->first_var = aiger_lit2var(max_sym) + 1;
+    b->fanins = int_vector_init();
+    b->strash_size = 1024; // must be a power of two
+    b->strash = calloc(b->strash_size, sizeof(unsigned));
+    b->inputs = int_vector_init();
+    b->input_index = int_vector_init();
+    b->input_names = vector_init();
+    b->outputs = int_vector_init();
+    b->output_names = vector_init();
+    b->hits = 0;
+    b->rewrites = 0;
+    return b;
+}
+
+void aigeru_builder_free(AigerBuilder* b) {
+    for (unsigned i = 0; i < vector_count(b->input_names); i++) {
+        free(vector_get(b->input_names, i));
     }
-    aiger_add_and(a, negated_outputlit, negate(i1), negate(i2));
+    for (unsigned i = 0; i < vector_count(b->output_names); i++) {
+        free(vector_get(b->output_names, i));
+    }
+    vector_free(b->input_names);
+    vector_free(b->output_names);
+    int_vector_free(b->inputs);
+    int_vector_free(b->input_index);
+    int_vector_free(b->outputs);
+    int_vector_free(b->fanins);
+    free(b->strash);
+    free(b);
 }
 
-unsigned aigeru_OR(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2) {
-    return negate(aigeru_AND(a, max_sym, negate(i1), negate(i2)));
+void aigeru_builder_print_statistics(AigerBuilder* b) {
+    V1("AIG builder created %u gates; %u requests answered by structural hashing, %u by folding and rewriting.\n",
+       aigeru_gates_num(b), b->hits, b->rewrites);
 }
 
-unsigned aigeru_AND(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2) {
-    if (i1 == aiger_true) {
-        return i2;
-    }
-    if (i2 == aiger_true) {
-        return i1;
-    }
-    if (i1 == aiger_false || i2 == aiger_false) {
-        return aiger_false;
+unsigned aigeru_gates_num(AigerBuilder* b) {
+    return int_vector_count(b->fanins) / 2;
+}
+
+static char* aigeru_copy_name(const char* name) {
+    if (name == NULL) {
+        return NULL;
     }
-    if (i1 == i2) {
-        return i1;
+    char* copy = malloc(strlen(name) + 1);
+    strcpy(copy, name);
+    return copy;
+}
+
+void aigeru_add_input(AigerBuilder* b, unsigned lit, const char* name) {
+    unsigned var = aiger_lit2var(lit);
+    abortif(is_negated(lit) || var == 0 || var >= b->first_var, "Input literal %u is not reserved for inputs.", lit);
+    assert(!aigeru_is_input(b, lit));
+    int_vector_add(b->inputs, (int) lit);
+    while (int_vector_count(b->input_index) <= var) {
+        int_vector_add(b->input_index, 0);
     }
-    if (i1 == negate(i2)) {
-        return aiger_false;
+    int_vector_set(b->input_index, var, (int) int_vector_count(b->inputs));
+    vector_add(b->input_names, aigeru_copy_name(name));
+}
+
+void aigeru_add_output(AigerBuilder* b, unsigned lit, const char* name) {
+    assert(aiger_lit2var(lit) == 0 || aigeru_is_input(b, lit) || aiger_lit2var(lit) >= b->first_var);
+    int_vector_add(b->outputs, (int) lit);
+    vector_add(b->output_names, aigeru_copy_name(name));
+}
+
+bool aigeru_is_input(AigerBuilder* b, unsigned lit) {
+    unsigned var = aiger_lit2var(lit);
+    return var < int_vector_count(b->input_index) && int_vector_get(b->input_index, var) != 0;
+}
+
+static bool aigeru_is_gate(AigerBuilder* b, unsigned lit) {
+    unsigned var = aiger_lit2var(lit);
+    return var >= b->first_var && 2 * (var - b->first_var) < int_vector_count(b->fanins);
+}
+
+static unsigned aigeru_fanin(AigerBuilder* b, unsigned lit, unsigned i) {
+    assert(aigeru_is_gate(b, lit));
+    return (unsigned) int_vector_get(b->fanins, 2 * (aiger_lit2var(lit) - b->first_var) + i);
+}
+
+static unsigned aigeru_hash(unsigned i1, unsigned i2) {
+    return i1 * 2654435761u + i2 * 40503u;
+}
+
+// Returns the slot holding the gate with the given fanins, or the empty slot where it belongs
+static unsigned* aigeru_strash_slot(AigerBuilder* b, unsigned i1, unsigned i2) {
+    unsigned mask = b->strash_size - 1;
+    for (unsigned pos = aigeru_hash(i1, i2) & mask; ; pos = (pos + 1) & mask) {
+        unsigned var = b->strash[pos];
+        if (var == 0) {
+            return &b->strash[pos];
+        }
+        unsigned lit = var2aigerlit(var);
+        if (aigeru_fanin(b, lit, 0) == i1 && aigeru_fanin(b, lit, 1) == i2) {
+            return &b->strash[pos];
+        }
     }
-    unsigned out = inc(max_sym);
-    aiger_add_and(a, out, i1, i2);
-    return out;
 }
 
-unsigned aigeru_multiOR(aiger* a, unsigned* max_sym, int_vector* input_aigerlits) {
-    unsigned outputlit = aiger_false;
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits); i++) {
-        outputlit = aigeru_OR(a, max_sym, outputlit, (unsigned) int_vector_get(input_aigerlits, i));
+static void aigeru_strash_grow(AigerBuilder* b) {
+    free(b->strash);
+    b->strash_size *= 2;
+    b->strash = calloc(b->strash_size, sizeof(unsigned));
+    for (unsigned var = b->first_var; var < b->first_var + aigeru_gates_num(b); var++) {
+        unsigned lit = var2aigerlit(var);
+        *aigeru_strash_slot(b, aigeru_fanin(b, lit, 0), aigeru_fanin(b, lit, 1)) = var;
     }
-    return outputlit;
 }
 
-void aigeru_add_multiOR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
-    unsigned negated_outputlit = 0;
-    if (is_negated(output_aigerlit)) {
-        negated_outputlit = negate(output_aigerlit);
+// Two-level rewriting for the case that x is a gate; y may or may not be a gate. Rules from
+// Brummayer and Biere, "Local Two-Level And-Inverter Graph Minimization without Blowup".
+static bool aigeru_rewrite(AigerBuilder* b, unsigned x, unsigned y, unsigned* res) {
+    if (!aigeru_is_gate(b, x)) {
+        return false;
+    }
+    unsigned x0 = aigeru_fanin(b, x, 0);
+    unsigned x1 = aigeru_fanin(b, x, 1);
+    bool y_is_gate = aigeru_is_gate(b, y);
+    unsigned y0 = y_is_gate ? aigeru_fanin(b, y, 0) : 0;
+    unsigned y1 = y_is_gate ? aigeru_fanin(b, y, 1) : 0;
+    if (!is_negated(x)) {
+        if (y == x0 || y == x1) { // idempotence
+            *res = x;
+            return true;
+        }
+        if (y == negate(x0) || y == negate(x1)) { // contradiction
+            *res = aiger_false;
+            return true;
+        }
+        if (y_is_gate && !is_negated(y)) {
+            if (y0 == negate(x0) || y0 == negate(x1) || y1 == negate(x0) || y1 == negate(x1)) { // contradiction
+                *res = aiger_false;
+                return true;
+            }
+        }
+        if (y_is_gate && is_negated(y)) {
+            if (y0 == negate(x0) || y0 == negate(x1) || y1 == negate(x0) || y1 == negate(x1)) { // subsumption
+                *res = x;
+                return true;
+            }
+            if (y0 == x0 || y0 == x1) { // substitution
+                *res = aigeru_AND(b, x, negate(y1));
+                return true;
+            }
+            if (y1 == x0 || y1 == x1) { // substitution
+                *res = aigeru_AND(b, x, negate(y0));
+                return true;
+            }
+        }
     } else {
-        negated_outputlit = inc(max_sym);
-        aiger_add_and(a, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
+        if (y == negate(x0) || y == negate(x1)) { // subsumption
+            *res = y;
+            return true;
+        }
+        if (y == x0) { // substitution
+            *res = aigeru_AND(b, y, negate(x1));
+            return true;
+        }
+        if (y == x1) { // substitution
+            *res = aigeru_AND(b, y, negate(x0));
+            return true;
+        }
+        if (y_is_gate && is_negated(y)) { // resolution
+            if ((x0 == y0 && x1 == negate(y1)) || (x0 == y1 && x1 == negate(y0))) {
+                *res = negate(x0);
+                return true;
+            }
+            if ((x1 == y1 && x0 == negate(y0)) || (x1 == y0 && x0 == negate(y1))) {
+                *res = negate(x1);
+                return true;
+            }
+        }
     }
-    int_vector* negated_inputlits = int_vector_init();
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits); i++) {
-        int_vector_add(negated_inputlits, (int) negate((unsigned) int_vector_get(input_aigerlits, i)));
+    return false;
+}
+
+unsigned aigeru_AND(AigerBuilder* b, unsigned i1, unsigned i2) {
+    if (i1 == aiger_true || i2 == aiger_true || i1 == aiger_false || i2 == aiger_false
+        || i1 == i2 || i1 == negate(i2)) {
+        b->rewrites++;
+        if (i1 == aiger_false || i2 == aiger_false || i1 == negate(i2)) {
+            return aiger_false;
+        }
+        return i1 == aiger_true ? i2 : i1;
+    }
+    if (i1 > i2) {
+        unsigned tmp = i1;
+        i1 = i2;
+        i2 = tmp;
     }
-    aigeru_add_multiAND(a, max_sym, negated_outputlit, negated_inputlits);
-    int_vector_free(negated_inputlits);
+    unsigned res = 0;
+    if (aigeru_rewrite(b, i1, i2, &res) || aigeru_rewrite(b, i2, i1, &res)) {
+        b->rewrites++;
+        return res;
+    }
+    unsigned* slot = aigeru_strash_slot(b, i1, i2);
+    if (*slot != 0) {
+        b->hits++;
+        return var2aigerlit(*slot);
+    }
+    unsigned out = inc(&b->max_sym);
+    assert(aiger_lit2var(out) == b->first_var + aigeru_gates_num(b));
+    int_vector_add(b->fanins, (int) i1);
+    int_vector_add(b->fanins, (int) i2);
+    *slot = aiger_lit2var(out);
+    if (int_vector_count(b->fanins) >= b->strash_size) { // load factor of one half
+        aigeru_strash_grow(b);
+    }
+    return out;
+}
+
+unsigned aigeru_OR(AigerBuilder* b, unsigned i1, unsigned i2) {
+    return negate(aigeru_AND(b, negate(i1), negate(i2)));
 }
 
+unsigned aigeru_multiAND(AigerBuilder* b, int_vector* input_aigerlits) {
+    // Sorting places complementary and duplicate inputs next to each other, where the rewriting
+    // catches them, and lets conjunctions over the same inputs share their prefixes.
+    int_vector* inputs = int_vector_copy(input_aigerlits);
+    int_vector_sort(inputs, compare_integers_natural_order);
+    unsigned out = aiger_true;
+    for (unsigned i = 0; i < int_vector_count(inputs) && out != aiger_false; i++) {
+        out = aigeru_AND(b, out, (unsigned) int_vector_get(inputs, i));
+    }
+    int_vector_free(inputs);
+    return out;
+}
 
-void aigeru_add_multiplexer(aiger* a, unsigned* max_sym, unsigned output,
-                               unsigned selector, unsigned if_signal, unsigned else_signal) {
-    LOG_WARNING("Not sure if this component is correct.");
-    unsigned if_component = inc(max_sym);
-    aiger_add_and(a, if_component, selector, if_signal);
-    unsigned else_component = inc(max_sym);
-    aiger_add_and(a, else_component, negate(selector), else_signal);
-    unsigned negation_of_output = inc(max_sym); // need extra symbol as we cannot define left side of the final and as negated signal.
-    aiger_add_and(a, negation_of_output, negate(if_component), negate(else_component));
-    aiger_add_and(a, output, negate(negation_of_output), negate(negation_of_output));
+unsigned aigeru_multiOR(AigerBuilder* b, int_vector* input_aigerlits) {
+    int_vector* negated_inputs = int_vector_init();
+    for (unsigned i = 0; i < int_vector_count(input_aigerlits); i++) {
+        int_vector_add(negated_inputs, (int) negate((unsigned) int_vector_get(input_aigerlits, i)));
+    }
+    unsigned out = negate(aigeru_multiAND(b, negated_inputs));
+    int_vector_free(negated_inputs);
+    return out;
 }
 
-unsigned aigeru_MUX(aiger* a, unsigned* max_sym, unsigned selector, unsigned i1, unsigned i2) {
-    unsigned i1_out = aigeru_AND(a, max_sym, selector, i1);
-    unsigned i2_out = aigeru_AND(a, max_sym, negate(selector), i2);
-    return aigeru_OR(a, max_sym, i1_out, i2_out);
+unsigned aigeru_MUX(AigerBuilder* b, unsigned selector, unsigned i1, unsigned i2) {
+    unsigned i1_out = aigeru_AND(b, selector, i1);
+    unsigned i2_out = aigeru_AND(b, negate(selector), i2);
+    return aigeru_OR(b, i1_out, i2_out);
 }
 
 
-unsigned aigeru_multiMUX(aiger* a, unsigned* max_sym, int_vector* selectors, int_vector* inputs) {
+unsigned aigeru_multiMUX(AigerBuilder* b, int_vector* selectors, int_vector* inputs) {
     assert(int_vector_count(selectors) == int_vector_count(inputs));
     unsigned out = aiger_false;
     unsigned previous_case_applies = aiger_false;
     for (unsigned i = 0; i < int_vector_count(selectors); i++) {
         unsigned selector = (unsigned) int_vector_get(selectors, i);
         unsigned value = (unsigned) int_vector_get(inputs, i);
-        unsigned this_case_applies = aigeru_AND(a, max_sym, negate(previous_case_applies), selector);
-        unsigned selected_value = aigeru_AND(a, max_sym, this_case_applies, value);
-        out = aigeru_OR(a, max_sym, out, selected_value);
+        unsigned this_case_applies = aigeru_AND(b, negate(previous_case_applies), selector);
+        unsigned selected_value = aigeru_AND(b, this_case_applies, value);
+        out = aigeru_OR(b, out, selected_value);
         if (i + 1 < int_vector_count(selectors)) {
-            previous_case_applies = aigeru_OR(a, max_sym, previous_case_applies, selector);
+            previous_case_applies = aigeru_OR(b, previous_case_applies, selector);
         }
     }
     return out;
 }
+
+void aigeru_get_gate(AigerBuilder* b, unsigned i, unsigned* lhs, unsigned* rhs0, unsigned* rhs1) {
+    assert(i < aigeru_gates_num(b));
+    *lhs = var2aigerlit(b->first_var + i);
+    *rhs0 = (unsigned) int_vector_get(b->fanins, 2 * i);
+    *rhs1 = (unsigned) int_vector_get(b->fanins, 2 * i + 1);
+}
+
+// Inputs take the first variables, gates follow in the order of creation
+static unsigned aigeru_binary_lit(AigerBuilder* b, unsigned lit) {
+    unsigned var = aiger_lit2var(lit);
+    if (var == 0) {
+        return lit;
+    }
+    unsigned res = 0;
+    if (var >= b->first_var) {
+        assert(aigeru_is_gate(b, lit));
+        res = int_vector_count(b->inputs) + 1 + var - b->first_var;
+    } else {
+        abortif(!aigeru_is_input(b, lit), "Literal %u is neither an input nor a gate.", lit);
+        res = (unsigned) int_vector_get(b->input_index, var);
+    }
+    return var2aigerlit(res) | aiger_sign(lit);
+}
+
+static void aigeru_write_delta(FILE* file, unsigned delta) {
+    while (delta & ~0x7fu) {
+        putc((int) ((delta & 0x7f) | 0x80), file);
+        delta >>= 7;
+    }
+    putc((int) delta, file);
+}
+
+static void aigeru_write_symbols(FILE* file, char type, vector* names) {
+    for (unsigned i = 0; i < vector_count(names); i++) {
+        char* name = vector_get(names, i);
+        if (name) {
+            fprintf(file, "%c%u %s\n", type, i, name);
+        }
+    }
+}
+
+bool aigeru_write(AigerBuilder* b, FILE* file, bool binary) {
+    unsigned inputs = int_vector_count(b->inputs);
+    unsigned outputs = int_vector_count(b->outputs);
+    unsigned gates = aigeru_gates_num(b);
+    if (binary) {
+        fprintf(file, "aig %u %u 0 %u %u\n", inputs + gates, inputs, outputs, gates);
+        for (unsigned i = 0; i < outputs; i++) {
+            fprintf(file, "%u\n", aigeru_binary_lit(b, (unsigned) int_vector_get(b->outputs, i)));
+        }
+        for (unsigned i = 0; i < gates; i++) {
+            unsigned lhs = var2aigerlit(inputs + 1 + i);
+            unsigned rhs0 = aigeru_binary_lit(b, (unsigned) int_vector_get(b->fanins, 2 * i));
+            unsigned rhs1 = aigeru_binary_lit(b, (unsigned) int_vector_get(b->fanins, 2 * i + 1));
+            if (rhs0 < rhs1) {
+                unsigned tmp = rhs0;
+                rhs0 = rhs1;
+                rhs1 = tmp;
+            }
+            assert(lhs > rhs0 && rhs0 > rhs1);
+            aigeru_write_delta(file, lhs - rhs0);
+            aigeru_write_delta(file, rhs0 - rhs1);
+        }
+    } else {
+        fprintf(file, "aag %u %u 0 %u %u\n", aiger_lit2var(b->max_sym), inputs, outputs, gates);
+        for (unsigned i = 0; i < inputs; i++) {
+            fprintf(file, "%u\n", (unsigned) int_vector_get(b->inputs, i));
+        }
+        for (unsigned i = 0; i < outputs; i++) {
+            fprintf(file, "%u\n", (unsigned) int_vector_get(b->outputs, i));
+        }
+        for (unsigned i = 0; i < gates; i++) {
+            unsigned lhs, rhs0, rhs1;
+            aigeru_get_gate(b, i, &lhs, &rhs0, &rhs1);
+            fprintf(file, "%u %u %u\n", lhs, rhs0, rhs1);
+        }
+    }
+    aigeru_write_symbols(file, 'i', b->input_names);
+    aigeru_write_symbols(file, 'o', b->output_names);
+    return ferror(file) == 0;
+}
+
+aiger* aigeru_builder_to_aiger(AigerBuilder* b) {
+    aiger* a = aiger_init();
+    for (unsigned i = 0; i < int_vector_count(b->inputs); i++) {
+        aiger_add_input(a, (unsigned) int_vector_get(b->inputs, i), vector_get(b->input_names, i));
+    }
+    for (unsigned i = 0; i < aigeru_gates_num(b); i++) {
+        unsigned lhs, rhs0, rhs1;
+        aigeru_get_gate(b, i, &lhs, &rhs0, &rhs1);
+        aiger_add_and(a, lhs, rhs0, rhs1);
+    }
+    for (unsigned i = 0; i < int_vector_count(b->outputs); i++) {
+        aiger_add_output(a, (unsigned) int_vector_get(b->outputs, i), vector_get(b->output_names, i));
+    }
+    return a;
+}
@@ -11,8 +11,10 @@
 
 #include "aiger.h"
 #include "int_vector.h"
+#include "vector.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 
 int aiger_lit2lit(unsigned aigerlit, int truelit); // truelit indicates a literal that represents true
 unsigned inc(unsigned* sym);
@@ -21,18 +23,47 @@ unsigned negate(unsigned signal);
 unsigned var2aigerlit(unsigned var_id);
 
 
-void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits);
-void aigeru_add_OR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, unsigned i1, unsigned i2);
-void aigeru_add_multiOR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits);
-void aigeru_add_multiplexer(aiger* a, unsigned* max_sym,
-                            unsigned output, unsigned selector, unsigned if_signal, unsigned else_signal);
-unsigned aigeru_MUX(aiger* a, unsigned* max_sym, unsigned selector, unsigned i1, unsigned i2);
-unsigned aigeru_multiMUX(aiger* a, unsigned* max_sym, int_vector* selectors, int_vector* inputs);
+// Builds AIGs with constant folding, two-level rewriting, and structural
+// hashing: requesting the same AND gate twice returns the first one. The
+// builder holds the circuit itself, compactly enough for certificates with
+// tens of millions of gates, and writes it without an intermediate aiger.
+typedef struct {
+    unsigned max_sym;    // largest aiger literal in use; new gates are numbered from here
+    unsigned first_var;  // first variable defined by the builder
+    int_vector* fanins;  // two aiger literals per gate, in the order of creation
+    unsigned* strash;    // open addressing; variables of gates, 0 is empty
+    unsigned strash_size;
+    int_vector* inputs;  // aiger literals
+    int_vector* input_index; // var -> position in inputs + 1; 0 for non-inputs
+    vector* input_names;
+    int_vector* outputs; // aiger literals
+    vector* output_names;
+    unsigned hits;       // requests answered by the hash table
+    unsigned rewrites;   // requests answered by folding or rewriting
+} AigerBuilder;
 
-unsigned aigeru_OR(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2);
-unsigned aigeru_AND(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2);
-unsigned aigeru_multiOR(aiger* a, unsigned* max_sym, int_vector* input_aigerlits);
-unsigned aigeru_multiAND(aiger* a, unsigned* max_sym, int_vector* input_aigerlits);
+// Variables up to max_sym are reserved for inputs
+AigerBuilder* aigeru_builder_init(unsigned max_sym);
+void aigeru_builder_free(AigerBuilder*);
+void aigeru_builder_print_statistics(AigerBuilder*);
+unsigned aigeru_gates_num(AigerBuilder*);
+void aigeru_add_input(AigerBuilder*, unsigned lit, const char* name);
+void aigeru_add_output(AigerBuilder*, unsigned lit, const char* name);
+bool aigeru_is_input(AigerBuilder*, unsigned lit);
+// Fanins of the given gate, which is the variable of the i-th gate created
+void aigeru_get_gate(AigerBuilder*, unsigned i, unsigned* lhs, unsigned* rhs0, unsigned* rhs1);
+// Binary mode renumbers inputs and gates as the format requires, streaming the gates
+// delta-encoded in the order of creation. ASCII mode keeps the numbering of the builder.
+bool aigeru_write(AigerBuilder*, FILE*, bool binary);
+// Copies the circuit into an aiger with the numbering of the builder
+aiger* aigeru_builder_to_aiger(AigerBuilder*);
+
+unsigned aigeru_AND(AigerBuilder*, unsigned i1, unsigned i2);
+unsigned aigeru_OR(AigerBuilder*, unsigned i1, unsigned i2);
+unsigned aigeru_multiAND(AigerBuilder*, int_vector* input_aigerlits);
+unsigned aigeru_multiOR(AigerBuilder*, int_vector* input_aigerlits);
+unsigned aigeru_MUX(AigerBuilder*, unsigned selector, unsigned i1, unsigned i2);
+unsigned aigeru_multiMUX(AigerBuilder*, int_vector* selectors, int_vector* inputs);
 
 
 #endif /* aiger_utils_h */
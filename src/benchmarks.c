@@ -0,0 +1,121 @@
+//
+//  benchmarks.c
+//  cadet
+//
+//  Micro-benchmarks for the data structures on the hot paths of the solver.
+//  The workloads imitate the call sites: literal-keyed maps as in the SAT
+//  solver wrappers and in Casesplits, and pointer sets as used for the
+//  membership checks of worklists and priority queues.
+//
+
+#include "benchmarks.h"
+#include "log.h"
+#include "util.h"
+#include "map.h"
+#include "set.h"
+#include "mersenne_twister.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_ROUNDS 20
+
+static void benchmark_report(const char* name, double start, size_t ops) {
+    double seconds = get_seconds() - start;
+    V0("  %-36s %10zu ops %10.2f ns/op\n", name, ops, seconds * 1e9 / (double) ops);
+}
+
+// Keys are the literals of n variables, as in the mapping of original_satlits.
+static void benchmark_map_literals(unsigned n) {
+    map* m = map_init();
+    size_t ops = 0;
+    long checksum = 0;
+    double start = get_seconds();
+    for (unsigned r = 0; r < BENCHMARK_ROUNDS; r++) {
+        for (int v = 1; v <= (int) n; v++) {
+            map_add(m,   v, (void*) (long) v);
+            map_add(m, - v, (void*) (long) - v);
+        }
+        ops += 2 * n;
+        for (int v = 1; v <= (int) n; v++) {
+            checksum += (long) map_get(m, v) + (long) map_get(m, - v);
+        }
+        ops += 2 * n;
+        for (int v = (int) n + 1; v <= 2 * (int) n; v++) {
+            checksum += map_contains(m, v);
+        }
+        ops += n;
+        for (int v = 1; v <= (int) n; v++) {
+            map_remove(m, v);
+        }
+        ops += n;
+        map_reset(m);
+    }
+    char name[64];
+    snprintf(name, 64, "map add/get/remove (%u vars)", n);
+    benchmark_report(name, start, ops);
+    abortif(checksum != 0, "Map benchmark computed wrong values.");
+    map_free(m);
+}
+
+// Random mix of membership checks, adds and removes on a pool of pointers,
+// as in the worklists with unique computation.
+static void benchmark_set_worklist(unsigned n) {
+    void** pool = malloc(sizeof(void*) * n);
+    for (unsigned i = 0; i < n; i++) {
+        pool[i] = malloc(16);
+    }
+    MersenneTwister* mt = mersenne_twister_init(1);
+    set* s = set_init();
+    size_t ops = 0;
+    double start = get_seconds();
+    for (unsigned r = 0; r < BENCHMARK_ROUNDS; r++) {
+        for (unsigned i = 0; i < 4 * n; i++) {
+            void* p = pool[genrand_int32(mt) % n];
+            if (set_contains(s, p)) {
+                set_remove(s, p);
+            } else {
+                set_add(s, p);
+            }
+        }
+        ops += 8 * n; // each step is a lookup followed by an update
+        set_reset(s);
+    }
+    char name[64];
+    snprintf(name, 64, "set worklist (%u pointers)", n);
+    benchmark_report(name, start, ops);
+    set_free(s);
+    mersenne_twister_free(mt);
+    for (unsigned i = 0; i < n; i++) {
+        free(pool[i]);
+    }
+    free(pool);
+}
+
+// Many resets of a set that holds few elements at a time
+static void benchmark_set_reset(unsigned n) {
+    set* s = set_init();
+    size_t ops = 0;
+    double start = get_seconds();
+    for (unsigned r = 0; r < BENCHMARK_ROUNDS * 1000; r++) {
+        for (unsigned i = 0; i < n; i++) {
+            set_add(s, (void*) (size_t) (8 * (i + 1)));
+        }
+        set_reset(s);
+        ops += n + 1;
+    }
+    char name[64];
+    snprintf(name, 64, "set fill and reset (%u pointers)", n);
+    benchmark_report(name, start, ops);
+    set_free(s);
+}
+
+void benchmark_all() {
+    V0("Micro-benchmarks:\n");
+    benchmark_map_literals(100);
+    benchmark_map_literals(100000);
+    benchmark_set_worklist(100);
+    benchmark_set_worklist(100000);
+    benchmark_set_reset(10);
+    benchmark_set_reset(1000);
+}
@@ -0,0 +1,11 @@
+//
+//  benchmarks.h
+//  cadet
+//
+
+#ifndef benchmarks_h
+#define benchmarks_h
+
+void benchmark_all();
+
+#endif /* benchmarks_h */
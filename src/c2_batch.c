@@ -0,0 +1,400 @@
+//
+//  c2_batch.c
+//  cadet
+//
+//  Batch mode: solves the formulas listed in a manifest (or on stdin), one
+//  file name per line, on a fixed pool of worker threads. Results and
+//  statistics are streamed to stdout as JSON lines, in order of completion.
+//
+//  Parsed formulas are cached by file name, and each job solves a private
+//  copy (see c2_portfolio_copy_formula), so repeated queries do not parse
+//  again. The worker threads live for the whole batch, so their heap arenas
+//  stay warm between jobs.
+//
+//  A watchdog thread enforces the per-job time limit and a global memory
+//  limit on the resident set size of the process, cancelling jobs
+//  cooperatively through c2->terminate. Jobs share one heap, so memory is not
+//  attributed to jobs: when the process exceeds batch_memory_limit, the
+//  longest running job is cancelled, whether or not it caused the growth.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "cadet_internal.h"
+#include "log.h"
+#include "util.h"
+#include "vector.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef enum {
+    BATCH_LIMIT_NONE,
+    BATCH_LIMIT_TIME,
+    BATCH_LIMIT_MEMORY
+} batch_limit;
+
+typedef struct {
+    unsigned id;
+    char* file_name;
+    atomic_bool terminate;
+    double start_time; // guarded by the batch lock; 0 while queued
+    batch_limit limit_hit; // guarded by the batch lock
+} Batch_Job;
+
+typedef struct {
+    char* file_name;
+    C2* parsed; // read only
+} Batch_Cache_Entry;
+
+typedef struct {
+    Options* options;
+    Log_Settings log_settings;
+
+    pthread_mutex_t lock;
+    pthread_cond_t jobs_available;
+    vector* queue; // Batch_Job*, pending
+    unsigned queue_head;
+    bool input_done;
+    vector* running; // Batch_Job* for each worker; NULL if idle
+    unsigned running_num;
+    bool finished; // all workers returned; stops the watchdog
+
+    pthread_mutex_t cache_lock;
+    vector* cache; // Batch_Cache_Entry*
+
+    pthread_mutex_t output_lock;
+} Batch;
+
+typedef struct {
+    Batch* batch;
+    unsigned id;
+} Batch_Worker;
+
+void c2_batch_print_json_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (const char* c = s; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', f);
+            fputc(*c, f);
+        } else if ((unsigned char) *c < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned) *c);
+        } else {
+            fputc(*c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+// Resident set size of the process in megabytes; 0 if unknown.
+double c2_batch_resident_memory() {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (! f) {
+        return 0.0;
+    }
+    unsigned long size = 0, resident = 0;
+    int matched = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    if (matched != 2) {
+        return 0.0;
+    }
+    return (double) resident * (double) sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+// Returns the parsed formula for the file, or NULL and an error message if the file cannot be read or parsed.
+// Sets cached if the formula was parsed before. Formulas are kept for the whole batch, up to batch_cache_size many.
+C2* c2_batch_get_formula(Batch* b, const char* file_name, bool* cached, const char** error) {
+    pthread_mutex_lock(&b->cache_lock);
+    for (unsigned i = 0; i < vector_count(b->cache); i++) {
+        Batch_Cache_Entry* entry = vector_get(b->cache, i);
+        if (strcmp(entry->file_name, file_name) == 0) {
+            pthread_mutex_unlock(&b->cache_lock);
+            *cached = true;
+            return entry->parsed;
+        }
+    }
+    pthread_mutex_unlock(&b->cache_lock);
+    *cached = false;
+
+    FILE* test = fopen(file_name, "r");
+    if (! test) {
+        *error = "cannot open file";
+        return NULL;
+    }
+    fclose(test);
+    FILE* file = open_possibly_zipped_file(file_name);
+    bool is_aiger = false; // batch mode does not write certificates, so the format does not matter
+    const char* parse_error = NULL;
+    C2* parsed = c2_parse_file(file, b->options, &is_aiger, &parse_error);
+    close_possibly_zipped_file(file_name, file);
+    if (! parsed) {
+        V1("Cannot parse %s: %s\n", file_name, parse_error);
+        *error = "malformed file";
+        return NULL;
+    }
+
+    pthread_mutex_lock(&b->cache_lock);
+    for (unsigned i = 0; i < vector_count(b->cache); i++) { // another worker may have parsed it meanwhile
+        Batch_Cache_Entry* entry = vector_get(b->cache, i);
+        if (strcmp(entry->file_name, file_name) == 0) {
+            pthread_mutex_unlock(&b->cache_lock);
+            c2_free(parsed);
+            return entry->parsed;
+        }
+    }
+    if (vector_count(b->cache) < b->options->batch_cache_size) {
+        Batch_Cache_Entry* entry = malloc(sizeof(Batch_Cache_Entry));
+        entry->file_name = malloc(strlen(file_name) + 1);
+        strcpy(entry->file_name, file_name);
+        entry->parsed = parsed;
+        vector_add(b->cache, entry);
+    } else {
+        V1("Formula cache is full; not caching %s\n", file_name);
+        // The caller owns the formula now; signaled by not being in the cache.
+    }
+    pthread_mutex_unlock(&b->cache_lock);
+    return parsed;
+}
+
+bool c2_batch_is_cached(Batch* b, C2* parsed) {
+    pthread_mutex_lock(&b->cache_lock);
+    bool found = false;
+    for (unsigned i = 0; i < vector_count(b->cache); i++) {
+        Batch_Cache_Entry* entry = vector_get(b->cache, i);
+        found = found || entry->parsed == parsed;
+    }
+    pthread_mutex_unlock(&b->cache_lock);
+    return found;
+}
+
+void c2_batch_solve_job(Batch* b, Batch_Job* job) {
+    double start = get_seconds();
+    bool cached = false;
+    const char* error = NULL;
+    C2* parsed = c2_batch_get_formula(b, job->file_name, &cached, &error);
+
+    cadet_res res = CADET_RESULT_UNKNOWN;
+    C2* c2 = NULL;
+    if (parsed) {
+        c2 = c2_portfolio_copy_formula(parsed, b->options);
+        if (! c2_batch_is_cached(b, parsed)) {
+            c2_free(parsed);
+        }
+        c2->terminate = &job->terminate;
+        if (qcnf_is_propositional(c2->qcnf) && ! b->options->use_qbf_engine_also_for_propositional_problems) {
+            res = c2_check_propositional(c2->qcnf, b->options);
+        } else {
+            c2_apply_formula_transformations(c2);
+            res = c2_sat(c2);
+        }
+    }
+
+    pthread_mutex_lock(&b->lock);
+    batch_limit limit_hit = job->limit_hit;
+    pthread_mutex_unlock(&b->lock);
+
+    pthread_mutex_lock(&b->output_lock);
+    fprintf(stdout, "{\"job\": %u, \"file\": ", job->id);
+    c2_batch_print_json_string(stdout, job->file_name);
+    if (! parsed) {
+        fprintf(stdout, ", \"error\": \"%s\"}\n", error);
+    } else {
+        const char* result = res == CADET_RESULT_SAT ? "SAT" : (res == CADET_RESULT_UNSAT ? "UNSAT" : "UNKNOWN");
+        fprintf(stdout, ", \"result\": \"%s\", \"exit_code\": %d", result, (int) res);
+        if (limit_hit != BATCH_LIMIT_NONE) {
+            fprintf(stdout, ", \"limit\": \"%s\"", limit_hit == BATCH_LIMIT_TIME ? "time" : "memory");
+        }
+        fprintf(stdout, ", \"time\": %.3f, \"cached\": %s, \"decisions\": %zu, \"conflicts\": %zu, \"restarts\": %zu, \"cases\": %zu}\n",
+                get_seconds() - start,
+                cached ? "true" : "false",
+                c2->statistics.decisions,
+                c2->statistics.conflicts,
+                c2->restarts,
+                c2->statistics.cases_closed);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&b->output_lock);
+
+    if (c2) {
+        c2_free(c2);
+    }
+}
+
+void* c2_batch_worker_run(void* arg) {
+    Batch_Worker* w = (Batch_Worker*) arg;
+    Batch* b = w->batch;
+    log_set_settings(b->log_settings);
+
+    while (true) {
+        pthread_mutex_lock(&b->lock);
+        while (b->queue_head == vector_count(b->queue) && ! b->input_done) {
+            pthread_cond_wait(&b->jobs_available, &b->lock);
+        }
+        if (b->queue_head == vector_count(b->queue)) {
+            assert(b->input_done);
+            pthread_mutex_unlock(&b->lock);
+            break;
+        }
+        Batch_Job* job = vector_get(b->queue, b->queue_head);
+        vector_set(b->queue, b->queue_head, NULL);
+        b->queue_head += 1;
+        job->start_time = get_seconds();
+        vector_set(b->running, w->id, job);
+        b->running_num += 1;
+        pthread_mutex_unlock(&b->lock);
+
+        c2_batch_solve_job(b, job);
+
+        pthread_mutex_lock(&b->lock);
+        vector_set(b->running, w->id, NULL);
+        b->running_num -= 1;
+        pthread_mutex_unlock(&b->lock);
+        free(job->file_name);
+        free(job);
+    }
+    return NULL;
+}
+
+// Cancels jobs exceeding the time limit. If the process exceeds the global memory limit, cancels the job
+// that runs the longest, but only one at a time: the memory of a cancelled job is released when it returns.
+void* c2_batch_watchdog_run(void* arg) {
+    Batch* b = (Batch*) arg;
+    struct timespec interval = {0, 20 * 1000 * 1000};
+    while (true) {
+        nanosleep(&interval, NULL);
+        double now = get_seconds();
+        double memory = b->options->batch_memory_limit > 0 ? c2_batch_resident_memory() : 0.0;
+
+        pthread_mutex_lock(&b->lock);
+        if (b->finished) {
+            pthread_mutex_unlock(&b->lock);
+            break;
+        }
+        Batch_Job* oldest = NULL;
+        bool memory_cancel_pending = false;
+        for (unsigned i = 0; i < vector_count(b->running); i++) {
+            Batch_Job* job = vector_get(b->running, i);
+            if (job == NULL) {
+                continue;
+            }
+            if (job->limit_hit != BATCH_LIMIT_NONE) {
+                memory_cancel_pending = memory_cancel_pending || job->limit_hit == BATCH_LIMIT_MEMORY;
+                continue;
+            }
+            if (b->options->job_time_limit > 0 && now - job->start_time > b->options->job_time_limit) {
+                job->limit_hit = BATCH_LIMIT_TIME;
+                atomic_store(&job->terminate, true);
+            } else if (oldest == NULL || job->start_time < oldest->start_time) {
+                oldest = job;
+            }
+        }
+        if (oldest && ! memory_cancel_pending && memory > (double) b->options->batch_memory_limit) {
+            oldest->limit_hit = BATCH_LIMIT_MEMORY;
+            atomic_store(&oldest->terminate, true);
+        }
+        pthread_mutex_unlock(&b->lock);
+    }
+    return NULL;
+}
+
+int c2_batch(const char* manifest, Options* options) {
+    FILE* input = stdin;
+    if (manifest) {
+        input = fopen(manifest, "r");
+        abortif(! input, "Cannot open manifest \"%s\".", manifest);
+    }
+    unsigned workers_num = options->batch_workers > 0 ? options->batch_workers : 1;
+
+    Batch b;
+    b.options = options;
+    b.log_settings = log_get_settings();
+    b.log_settings.silent = true; // stdout is reserved for the JSON lines
+    pthread_mutex_init(&b.lock, NULL);
+    pthread_cond_init(&b.jobs_available, NULL);
+    b.queue = vector_init();
+    b.queue_head = 0;
+    b.input_done = false;
+    b.running = vector_init();
+    b.running_num = 0;
+    b.finished = false;
+    pthread_mutex_init(&b.cache_lock, NULL);
+    b.cache = vector_init();
+    pthread_mutex_init(&b.output_lock, NULL);
+
+    Batch_Worker* workers = malloc(sizeof(Batch_Worker) * workers_num);
+    pthread_t* threads = malloc(sizeof(pthread_t) * workers_num);
+    for (unsigned i = 0; i < workers_num; i++) {
+        vector_add(b.running, NULL);
+    }
+    for (unsigned i = 0; i < workers_num; i++) {
+        workers[i].batch = &b;
+        workers[i].id = i;
+        int err = pthread_create(&threads[i], NULL, c2_batch_worker_run, &workers[i]);
+        abortif(err != 0, "Could not create thread for batch worker %u.", i);
+    }
+    pthread_t watchdog;
+    int err = pthread_create(&watchdog, NULL, c2_batch_watchdog_run, &b);
+    abortif(err != 0, "Could not create watchdog thread.");
+
+    // Jobs are dispatched while reading, so that streamed input is processed immediately
+    char line[4096];
+    unsigned job_num = 0;
+    while (fgets(line, sizeof(line), input)) {
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == ' ')) {
+            line[--len] = '\0';
+        }
+        if (len == 0 || line[0] == '#') {
+            continue;
+        }
+        Batch_Job* job = malloc(sizeof(Batch_Job));
+        job->id = job_num++;
+        job->file_name = malloc(len + 1);
+        strcpy(job->file_name, line);
+        atomic_init(&job->terminate, false);
+        job->start_time = 0.0;
+        job->limit_hit = BATCH_LIMIT_NONE;
+
+        pthread_mutex_lock(&b.lock);
+        vector_add(b.queue, job);
+        pthread_cond_signal(&b.jobs_available);
+        pthread_mutex_unlock(&b.lock);
+    }
+    if (manifest) {
+        fclose(input);
+    }
+
+    pthread_mutex_lock(&b.lock);
+    b.input_done = true;
+    pthread_cond_broadcast(&b.jobs_available);
+    pthread_mutex_unlock(&b.lock);
+
+    for (unsigned i = 0; i < workers_num; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_lock(&b.lock);
+    b.finished = true;
+    pthread_mutex_unlock(&b.lock);
+    pthread_join(watchdog, NULL);
+
+    for (unsigned i = 0; i < vector_count(b.cache); i++) {
+        Batch_Cache_Entry* entry = vector_get(b.cache, i);
+        c2_free(entry->parsed);
+        free(entry->file_name);
+        free(entry);
+    }
+    vector_free(b.cache);
+    vector_free(b.queue);
+    vector_free(b.running);
+    pthread_mutex_destroy(&b.lock);
+    pthread_cond_destroy(&b.jobs_available);
+    pthread_mutex_destroy(&b.cache_lock);
+    pthread_mutex_destroy(&b.output_lock);
+    free(workers);
+    free(threads);
+    return 0;
+}
@@ -46,10 +46,11 @@ void c2_backtrack_casesplit(C2* c2) {
     c2->restarts_since_last_major = 0;
 }
 
-// Returns the number of propagations for this assumption
-unsigned c2_case_split_probe(C2* c2, Lit lit) {
+// Returns the number of propagations for this assumption. Adds the variables that became deterministic to determinized.
+unsigned c2_case_split_probe(C2* c2, Lit lit, int_vector* determinized) {
     assert(!skolem_can_propagate(c2->skolem));
     statistics_start_timer(c2->statistics.failed_literals_stats);
+    profiler_begin(c2->profiler, PROFILER_CASE_SPLIT_PROBE);
 
     debug_verbosity -= 1;
     
@@ -73,22 +74,202 @@ unsigned c2_case_split_probe(C2* c2, Lit lit) {
             case_split_decision_metric = UINT_MAX; //ensure the variable is chosen
         } else {
             V2("Number of propagations when assigning %d: %zu\n", lit, c2->skolem->statistics.propagations - case_split_decision_metric);
+            for (unsigned i = (unsigned) case_split_decision_metric; i < int_vector_count(c2->skolem->determinization_order); i++) {
+                int_vector_add(determinized, int_vector_get(c2->skolem->determinization_order, i));
+            }
             case_split_decision_metric = int_vector_count(c2->skolem->determinization_order) - case_split_decision_metric;
         }
 //    }
 
     skolem_pop(c2->skolem);
     statistics_stop_and_record_timer(c2->statistics.failed_literals_stats);
+    profiler_end(c2->profiler, PROFILER_CASE_SPLIT_PROBE);
 
     debug_verbosity += 1;
     
     return (unsigned) case_split_decision_metric;
 }
 
+C2_Probe_Cache* c2_probe_cache_init(C2* c2) {
+    C2_Probe_Cache* pc = malloc(sizeof(C2_Probe_Cache));
+    pc->assumptions = int_vector_copy(c2->skolem->universals_assumptions);
+    pc->results = int_vector_init();
+    pc->dependents = vector_init();
+    for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+        int_vector_add(pc->results, -1);
+        int_vector_add(pc->results, -1);
+        vector_add(pc->dependents, NULL);
+    }
+    pc->determinized = int_vector_count(c2->skolem->determinization_order);
+    pc->level0_epoch = c2->skolem->level0_epoch;
+    return pc;
+}
+
+void c2_probe_cache_free(C2_Probe_Cache* pc) {
+    for (unsigned i = 0; i < vector_count(pc->dependents); i++) {
+        int_vector* deps = vector_get(pc->dependents, i);
+        if (deps) {
+            int_vector_free(deps);
+        }
+    }
+    vector_free(pc->dependents);
+    int_vector_free(pc->results);
+    int_vector_free(pc->assumptions);
+    free(pc);
+}
+
+// Needed whenever the Skolem domain is rebuilt.
+void c2_probe_caches_invalidate(C2* c2) {
+    for (unsigned i = 0; i < vector_count(c2->probe_caches); i++) {
+        C2_Probe_Cache* pc = vector_get(c2->probe_caches, i);
+        if (pc) {
+            c2_probe_cache_free(pc);
+        }
+    }
+    vector_reset(c2->probe_caches);
+}
+
+bool c2_probe_cache_matches_assumptions(C2_Probe_Cache* pc, int_vector* assumptions) {
+    if (int_vector_count(pc->assumptions) != int_vector_count(assumptions)) {
+        return false;
+    }
+    for (unsigned i = 0; i < int_vector_count(assumptions); i++) {
+        if (int_vector_get(pc->assumptions, i) != int_vector_get(assumptions, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the cache for the current base decision level. Probes that determinized variables that
+// became deterministic on this level since the last update are invalidated. New clauses and
+// constants on level 0 invalidate all probes.
+C2_Probe_Cache* c2_probe_cache_get(C2* c2) {
+    unsigned lvl = c2->restart_base_decision_lvl;
+    while (vector_count(c2->probe_caches) <= lvl) {
+        vector_add(c2->probe_caches, NULL);
+    }
+    C2_Probe_Cache* pc = vector_get(c2->probe_caches, lvl);
+    unsigned determinized = int_vector_count(c2->skolem->determinization_order);
+    if (pc && (! c2_probe_cache_matches_assumptions(pc, c2->skolem->universals_assumptions)
+               || determinized < pc->determinized
+               || pc->level0_epoch != c2->skolem->level0_epoch)) {
+        c2_probe_cache_free(pc);
+        pc = NULL;
+    }
+    if (pc == NULL) {
+        pc = c2_probe_cache_init(c2);
+        vector_set(c2->probe_caches, lvl, pc);
+        return pc;
+    }
+    for (unsigned i = pc->determinized; i < determinized; i++) {
+        unsigned var_id = (unsigned) int_vector_get(c2->skolem->determinization_order, i);
+        int_vector* deps = var_id < vector_count(pc->dependents) ? vector_get(pc->dependents, var_id) : NULL;
+        if (deps) {
+            for (unsigned j = 0; j < int_vector_count(deps); j++) {
+                int_vector_set(pc->results, (unsigned) int_vector_get(deps, j), -1);
+            }
+            int_vector_free(deps);
+            vector_set(pc->dependents, var_id, NULL);
+        }
+    }
+    pc->determinized = determinized;
+    return pc;
+}
+
+unsigned c2_case_split_cached_probe(C2* c2, C2_Probe_Cache* pc, Lit lit) {
+    unsigned idx = 2 * lit_to_var(lit) + (lit < 0 ? 1 : 0);
+    while (int_vector_count(pc->results) <= idx) {
+        int_vector_add(pc->results, -1);
+    }
+    int cached = int_vector_get(pc->results, idx);
+    if (cached != -1) {
+        c2->statistics.probe_cache_hits += 1;
+        return (unsigned) cached;
+    }
+    unsigned determinized_before = int_vector_count(c2->skolem->determinization_order);
+    int_vector* determinized = int_vector_init();
+    unsigned propagations = c2_case_split_probe(c2, lit, determinized);
+    assert(determinized_before == int_vector_count(c2->skolem->determinization_order));
+    if (c2_termination_requested(c2)) {
+        int_vector_free(determinized);
+        return propagations; // not cached, the probe may have been interrupted
+    }
+    if (propagations != UINT_MAX) { // failed literals are not cached; the case split on them leads to a learnt clause
+        int_vector_set(pc->results, idx, (int) propagations);
+    }
+    for (unsigned i = 0; i < int_vector_count(determinized); i++) {
+        unsigned var_id = (unsigned) int_vector_get(determinized, i);
+        while (vector_count(pc->dependents) <= var_id) {
+            vector_add(pc->dependents, NULL);
+        }
+        int_vector* deps = vector_get(pc->dependents, var_id);
+        if (deps == NULL) {
+            deps = int_vector_init();
+            vector_set(pc->dependents, var_id, deps);
+        }
+        int_vector_add(deps, (int) idx);
+    }
+    int_vector_free(determinized);
+    return propagations;
+}
+
+bool c2_case_split_is_candidate(C2* c2, unsigned var_id) {
+    return var_id != 0
+        && skolem_is_deterministic(c2->skolem, var_id)
+        && skolem_get_constant_value(c2->skolem, (Lit) var_id) == 0;
+}
+
+float c2_case_split_cost_factor(C2* c2, unsigned var_id) {
+    return (float) 1 + (float) 2.0 * /*sqrtf*/(casesplits_get_interface_activity(c2->cs, var_id));
+}
+
+float c2_case_split_combined_factor(C2* c2, unsigned var_id) {
+    return ((float) 1.0 + (float) c2_get_activity(c2, var_id)) * c2_case_split_cost_factor(c2, var_id);
+}
+
+int c2_compare_floats_descending(const void* a, const void* b) {
+    float x = *(const float*) a;
+    float y = *(const float*) b;
+    return (x < y) - (x > y);
+}
+
+// Probing is the expensive part of picking a case split literal. The activity-based factor of
+// the quality is cheap, so we only probe the candidates with the highest factors. Returns the
+// minimal factor a candidate must have to be probed. Of the candidates whose factor equals the
+// threshold, only the first probes_at_threshold are probed, so ties cannot exceed the budget.
+float c2_case_split_probe_threshold(C2* c2, unsigned* probes_at_threshold) {
+    float_vector* factors = float_vector_init();
+    for (unsigned i = 1; i < int_vector_count(c2->cs->interface_vars); i++) {
+        unsigned var_id = (unsigned) int_vector_get(c2->cs->interface_vars, i);
+        if (c2_case_split_is_candidate(c2, var_id)) {
+            float_vector_add(factors, c2_case_split_combined_factor(c2, var_id));
+        }
+    }
+    float threshold = 0.0;
+    *probes_at_threshold = UINT_MAX;
+    if (float_vector_count(factors) > c2->magic.case_split_probe_budget) {
+        float_vector_sort(factors, c2_compare_floats_descending);
+        threshold = float_vector_get(factors, c2->magic.case_split_probe_budget - 1);
+        *probes_at_threshold = 0;
+        for (unsigned i = 0; i < c2->magic.case_split_probe_budget; i++) {
+            if (float_vector_get(factors, i) == threshold) {
+                *probes_at_threshold += 1;
+            }
+        }
+        c2->statistics.case_split_probes_skipped += float_vector_count(factors) - c2->magic.case_split_probe_budget;
+    }
+    float_vector_free(factors);
+    return threshold;
+}
+
 Lit c2_case_split_pick_literal(C2* c2) {
     float max_total = 0.0;
     float cost_factor_of_max = 0.0;
     Lit lit = 0;
+    unsigned probes_at_threshold = 0;
+    float probe_threshold = c2_case_split_probe_threshold(c2, &probes_at_threshold);
+    C2_Probe_Cache* pc = c2_probe_cache_get(c2);
     for (unsigned i = 1; i < int_vector_count(c2->cs->interface_vars); i++) {
         unsigned var_id = (unsigned) int_vector_get(c2->cs->interface_vars, i);
         assert(int_vector_get(c2->cs->interface_vars, i) > 0);
@@ -96,12 +277,30 @@ Lit c2_case_split_pick_literal(C2* c2) {
 //        unsigned var_id = i;
         Var* v = var_vector_get(c2->qcnf->vars, var_id);
         assert(v->var_id == var_id);
-        if (var_id != 0
-            && skolem_is_deterministic(c2->skolem, var_id)
-            && skolem_get_constant_value(c2->skolem, (Lit) v->var_id) == 0) {
+        if (c2_case_split_is_candidate(c2, var_id)) {
             
-            unsigned propagations_pos = c2_case_split_probe(c2,   (Lit) v->var_id);
-            unsigned propagations_neg = c2_case_split_probe(c2, - (Lit) v->var_id);
+            float combined_factor = c2_case_split_combined_factor(c2, v->var_id);
+            if (combined_factor < probe_threshold) {
+                continue;
+            }
+            if (combined_factor == probe_threshold) {
+                if (probes_at_threshold == 0) {
+                    continue;
+                }
+                probes_at_threshold -= 1;
+            }
+            
+            // An interrupted probe leaves work in the propagation queues and its result is incomplete.
+            unsigned propagations_pos = c2_case_split_cached_probe(c2, pc,   (Lit) v->var_id);
+            if (c2_termination_requested(c2)) {
+                lit = 0;
+                break;
+            }
+            unsigned propagations_neg = c2_case_split_cached_probe(c2, pc, - (Lit) v->var_id);
+            if (c2_termination_requested(c2)) {
+                lit = 0;
+                break;
+            }
             
             if (propagations_pos == UINT_MAX || propagations_neg == UINT_MAX) {
                 // we found a failed literal
@@ -112,17 +311,11 @@ Lit c2_case_split_pick_literal(C2* c2) {
             
             assert(propagations_pos < 1000000 && propagations_neg < 1000000); // avoid overflows
             
-            float cost_factor = (float) 1 + (float) 2.0 * /*sqrtf*/(casesplits_get_interface_activity(c2->cs, v->var_id));
-            
-            float combined_factor =
-                ((float) 1.0
-                    + (float) c2_get_activity(c2, v->var_id))
-                * cost_factor;
             float combined_quality = combined_factor * (float) (propagations_pos * propagations_neg + propagations_pos + propagations_neg + 1);
             if (combined_quality > max_total) {
                 lit = (propagations_pos > propagations_neg ? 1 : - 1) * (Lit) v->var_id;
                 max_total = combined_quality;
-                cost_factor_of_max = cost_factor;
+                cost_factor_of_max = c2_case_split_cost_factor(c2, v->var_id);
             }
         }
     }
@@ -190,6 +383,7 @@ bool c2_make_universal_assumption_unless_vacuous(C2* c2, Lit lit) {
 
 bool c2_casesplits_assume_single_lit(C2* c2) {
     if (! c2->options->casesplits
+        || int_vector_count(c2->assumptions) > 0 // the assumptions occupy the case split level
         || c2->restarts < c2->magic.num_restarts_before_case_splits
         || c2->conflicts_between_case_splits_countdown > 0
         || c2->skolem->decision_lvl != c2->restart_base_decision_lvl) {
@@ -217,9 +411,9 @@ bool c2_casesplits_assume_single_lit(C2* c2) {
 float c2_notoriousity(C2* c2, Lit lit) {
     Var* v = var_vector_get(c2->qcnf->vars, lit_to_var(lit));
     float n = 0.0;
-    vector* occs = lit>0 ? &v->pos_occs : &v->neg_occs;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = lit>0 ? &v->pos_occs : &v->neg_occs;
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         if (! c->original && c->consistent_with_originals) { // is a learnt clause
             n += 1.0;
         }
@@ -43,6 +43,7 @@ Clause* c2_minimize_clause(C2* c2, Clause* c) {
     }
     
     statistics_start_timer(c2->statistics.minimization_stats);
+    profiler_begin(c2->profiler, PROFILER_MINIMIZATION);
     unsigned initial_size = c->size;
     int_vector* to_remove = int_vector_init();
     int_vector* permutation = int_vector_init(); // Create random permutation of indices of the clause
@@ -50,7 +51,7 @@ Clause* c2_minimize_clause(C2* c2, Clause* c) {
     for (unsigned i = 0; i < c->size; i++) {
         int_vector_add(permutation, (int) i);
     }
-    int_vector_shuffle(permutation);
+    int_vector_shuffle(permutation, c2->rng);
     assert(c->size == int_vector_count(permutation));
     
     partial_assignment_push(c2->minimization_pa);
@@ -115,6 +116,7 @@ Clause* c2_minimize_clause(C2* c2, Clause* c) {
     int_vector_free(to_remove);
     assert(removed <= c->size);
     statistics_stop_and_record_timer(c2->statistics.minimization_stats);
+    profiler_end(c2->profiler, PROFILER_MINIMIZATION);
     c2->statistics.successful_conflict_clause_minimizations += removed;
     
     return new_clause;
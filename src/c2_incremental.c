@@ -0,0 +1,431 @@
+//
+//  c2_incremental.c
+//  cadet
+//
+//  Incremental solving: clauses, variables, and assumptions may be added after
+//  each call of c2_sat. Learnt clauses and activities are kept between calls.
+//
+//  Assumptions occupy decision level 1, the level that case splits use
+//  otherwise. Universal assumptions are universal assumptions of the Skolem
+//  domain; their cores come from the generalization of the closed case.
+//  Existential assumptions are constants on that level without reason, so
+//  conflict analysis keeps them in learnt clauses. The existential solver of
+//  CEGAR does not know them, so CEGAR is disabled while they are present, and
+//  cases closed under them are not kept.
+//
+//  Closed cases (including CEGAR cubes) are blocked in the SAT solver of the
+//  Skolem domain. They become invalid when constraints are added, in which case
+//  the Skolem domain is rebuilt from the clauses, including the learnt ones.
+//
+
+#include "cadet_internal.h"
+#include "casesplits.h"
+#include "skolem.h"
+#include "log.h"
+
+#include <assert.h>
+
+void c2_assume(C2* c2, int lit) {
+    abortif(lit == 0 || ! qcnf_var_exists(c2->qcnf, lit_to_var(lit)), "Assumption %d refers to unknown variable.", lit);
+    abortif(c2->solving, "Cannot add assumptions while solving.");
+    if (! int_vector_contains(c2->assumptions, lit)) {
+        int_vector_add(c2->assumptions, lit);
+    }
+}
+
+bool c2_is_core(C2* c2, int lit) {
+    abortif(c2->state != C2_SAT && c2->state != C2_UNSAT, "Failed assumptions are only defined after a result.");
+    return int_vector_contains(c2->failed_assumptions, lit);
+}
+
+// Fresh case splits for the current clauses; keeps the activities and statistics.
+void c2_reset_casesplits(C2* c2) {
+    Casesplits* old_cs = c2->cs;
+    c2->cs = casesplits_init(c2->qcnf);
+
+    float_vector_free(c2->cs->interface_activities);
+    c2->cs->interface_activities = old_cs->interface_activities;
+    old_cs->interface_activities = NULL;
+    c2->cs->cegar_stats = old_cs->cegar_stats;
+    c2->cs->case_generalizations = old_cs->case_generalizations;
+
+    casesplits_free(old_cs);
+    c2_probe_caches_invalidate(c2);
+}
+
+void c2_rebuild_domains(C2* c2) {
+    assert(c2->skolem->decision_lvl == 0);
+    assert(c2->restart_base_decision_lvl == 0);
+    V1("Rebuilding the Skolem domain; closed cases do not hold for the new constraints.\n");
+
+    skolem_free(c2->skolem);
+    c2->skolem = skolem_init(c2->qcnf, c2->options);
+    c2_reset_casesplits(c2);
+    int_vector_reset(c2->out_of_order_clauses);
+    c2->statistics.domain_rebuilds += 1;
+
+    if (skolem_is_conflicted(c2->skolem)) {
+        c2->state = C2_UNSAT;
+    }
+}
+
+// Returns to decision level 0, which may find the formula to be false.
+void c2_leave_assumptions_level(C2* c2) {
+    assert(c2->restart_base_decision_lvl > 0);
+    c2->state = C2_READY;
+    c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
+    c2_backtrack_casesplit(c2);
+}
+
+void c2_reopen(C2* c2, bool adds_clauses) {
+    if (c2->statistics.sat_calls == 0) {
+        return;
+    }
+    assert(! c2->solving);
+    bool adds_constraints = adds_clauses || c2->assumes_existentials;
+    if (c2->refuted) { // stays false; the last result may have been conditional
+        c2->state = C2_UNSAT;
+        c2->result_is_conditional = false;
+        return;
+    }
+    if (c2->state == C2_SAT && ! c2->result_is_conditional && ! adds_constraints) {
+        return; // stays true
+    }
+
+    c2_miniscoping_free(c2); // the partitions do not see the new constraints
+    c2->state = C2_READY;
+    c2->result_is_conditional = false;
+    if (c2->restart_base_decision_lvl > 0) {
+        c2_leave_assumptions_level(c2);
+    } else {
+        c2_backtrack_to_decision_lvl(c2, 0);
+    }
+    if (skolem_is_conflicted(c2->skolem)) {
+        c2->state = C2_UNSAT;
+    } else if (skolem_has_empty_domain(c2->skolem) && ! adds_constraints) {
+        c2->state = C2_SAT;
+    }
+    if (c2->state != C2_READY) {
+        return;
+    }
+
+    if (c2->skolem->interrupted) {
+        c2_rebuild_domains(c2); // a global conflict check of the last call was interrupted
+    } else if (adds_clauses && c2->options->pure_literals && c2->skolem->statistics.pure_vars > 0) {
+        c2_rebuild_domains(c2); // pure literals are chosen for the current clauses
+    } else if (! casesplits_is_initialized(c2->cs)) {
+        return;
+    } else if (adds_constraints && vector_count(c2->cs->closed_cases) > 0) {
+        c2_rebuild_domains(c2);
+    } else if (adds_clauses) { // the interface depends on the clauses
+        c2_reset_casesplits(c2);
+    }
+}
+
+// Leaves the level of the assumptions after they were found to contradict constants of level 0 or each other.
+void c2_assumptions_contradict(C2* c2, Lit assumption) {
+    unsigned var_id = lit_to_var(assumption);
+    bool is_universal = qcnf_is_universal(c2->qcnf, var_id);
+    int_vector_reset(c2->failed_assumptions);
+    int_vector_add(c2->failed_assumptions, assumption);
+    if (is_universal) { // the universal assumptions cannot be met
+        if (int_vector_contains(c2->assumptions, - assumption)) {
+            int_vector_add(c2->failed_assumptions, - assumption);
+        }
+    } else {
+        bool earlier = true;
+        for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+            Lit lit = int_vector_get(c2->assumptions, i);
+            earlier = earlier && lit != assumption;
+            if (qcnf_is_universal(c2->qcnf, lit_to_var(lit))) { // applied before the existential assumptions
+                int_vector_add(c2->refutation_under_assumptions, lit);
+            } else if (earlier && skolem_get_dlvl_for_constant(c2->skolem, var_id) > 0) {
+                int_vector_add(c2->failed_assumptions, lit); // the earlier assumptions may have caused the constant
+            }
+        }
+    }
+
+    c2_leave_assumptions_level(c2);
+    if (c2->state == C2_READY) {
+        c2->state = is_universal ? C2_SAT : C2_UNSAT;
+        c2->result_is_conditional = true;
+    } else { // false even without the assumptions
+        int_vector_reset(c2->failed_assumptions);
+        int_vector_reset(c2->refutation_under_assumptions);
+    }
+}
+
+// No universal assignment satisfies the assumptions, so the formula is trivially true under them.
+bool c2_universal_assumptions_contradict(C2* c2) {
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_universal(c2->qcnf, lit_to_var(lit)) && int_vector_contains(c2->assumptions, - lit)) {
+            int_vector_reset(c2->failed_assumptions);
+            int_vector_add(c2->failed_assumptions, lit);
+            int_vector_add(c2->failed_assumptions, - lit);
+            c2->state = C2_SAT;
+            c2->result_is_conditional = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Conflicts are left to conflict analysis in c2_run
+bool c2_may_apply_assumption(C2* c2) {
+    return c2->state == C2_READY && c2->restart_base_decision_lvl > 0 && ! skolem_is_conflicted(c2->skolem);
+}
+
+void c2_apply_assumption(C2* c2, Lit lit) {
+    int val = skolem_get_constant_value(c2->skolem, lit);
+    if (val == 1) {
+        return;
+    }
+    if (val == -1) {
+        c2_assumptions_contradict(c2, lit);
+    } else if (qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+        skolem_make_universal_assumption(c2->skolem, lit);
+    } else {
+        skolem_assign_constant_value(c2->skolem, lit, skolem_create_fresh_empty_dep(c2->skolem), NULL);
+    }
+}
+
+void c2_apply_assumptions(C2* c2) {
+    abortif(c2->options->cegar_only, "Assumptions are not supported in CEGAR-only mode.");
+    abortif(c2->assumes_existentials && c2->options->pure_literals,
+            "Existential assumptions require disabling pure literal detection; see --pure_literals.");
+    assert(c2->state == C2_READY);
+    assert(c2->skolem->decision_lvl == 0 && c2->restart_base_decision_lvl == 0);
+    V1("Solving under %u assumptions.\n", int_vector_count(c2->assumptions));
+    if (c2_universal_assumptions_contradict(c2)) {
+        return;
+    }
+
+    // Case generalization refers to the satlits of level 0
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_universal(c2->qcnf, lit_to_var(lit)) && ! map_contains(c2->cs->original_satlits, lit)) {
+            cegar_remember_original_satlit(c2->cs, lit_to_var(lit));
+        }
+    }
+
+    skolem_push(c2->skolem);
+    examples_push(c2->examples);
+    skolem_increase_decision_lvl(c2->skolem);
+    c2->restart_base_decision_lvl += 1;
+
+    // Universal assumptions come first, as a universal assumption that cannot be met makes the formula true
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions) && c2_may_apply_assumption(c2); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+            c2_apply_assumption(c2, lit);
+        }
+    }
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions) && c2_may_apply_assumption(c2); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (! qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+            c2_apply_assumption(c2, lit);
+        }
+    }
+}
+
+void c2_close_case_under_assumptions(C2* c2) {
+    assert(c2->state == C2_CLOSE_CASE);
+    unsigned cases = vector_count(c2->cs->closed_cases);
+    if (c2->assumes_existentials) {
+        // The Skolem functions only hold under the existential assumptions; the case cannot be kept.
+        c2_leave_assumptions_level(c2);
+    } else {
+        c2_close_case(c2);
+    }
+
+    int_vector_reset(c2->failed_assumptions);
+    if (skolem_has_empty_domain(c2->skolem)) { // the closed cases cover all universal assignments
+        c2->state = C2_SAT;
+        return;
+    }
+    if (vector_count(c2->cs->closed_cases) > cases) {
+        Case* c = vector_get(c2->cs->closed_cases, vector_count(c2->cs->closed_cases) - 1);
+        for (unsigned i = 0; i < int_vector_count(c->universal_assumptions); i++) {
+            int_vector_add(c2->failed_assumptions, int_vector_get(c->universal_assumptions, i));
+        }
+    } else {
+        for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+            Lit lit = int_vector_get(c2->assumptions, i);
+            if (qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+                int_vector_add(c2->failed_assumptions, lit);
+            }
+        }
+    }
+    c2->state = C2_SAT;
+    c2->result_is_conditional = true;
+}
+
+// The existential assumptions that the conflict depends on; all of them if the conflict is not over constants only.
+void c2_determine_failed_existential_assumptions(C2* c2) {
+    int_vector_reset(c2->failed_assumptions);
+    Clause* c = c2->skolem->conflicted_clause;
+    bool exact = c != NULL;
+    for (unsigned i = 0; exact && i < c->size; i++) {
+        Lit lit = c->occs[i];
+        unsigned var_id = lit_to_var(lit);
+        if (skolem_get_constant_value(c2->skolem, lit) != -1) {
+            exact = false;
+        } else if (skolem_get_dlvl_for_constant(c2->skolem, var_id) == 0) {
+            continue;
+        } else if (int_vector_contains(c2->assumptions, - lit)) {
+            if (! qcnf_is_universal(c2->qcnf, var_id)) {
+                int_vector_add(c2->failed_assumptions, - lit);
+            }
+        } else {
+            exact = false; // propagated on the level of the assumptions
+        }
+    }
+    if (! exact) {
+        int_vector_reset(c2->failed_assumptions);
+        for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+            Lit lit = int_vector_get(c2->assumptions, i);
+            if (! qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+                int_vector_add(c2->failed_assumptions, lit);
+            }
+        }
+    }
+}
+
+// Refutations of constants conflicts may leave universals unassigned that the conflict depends on; so we require
+// the refutation to confirm each universal assumption. The refutation is gone once the SAT solver of the Skolem
+// domain was used again, e.g. for clauses added after an earlier call.
+bool c2_refutation_confirms_assumptions(C2* c2) {
+    bool universal_assumptions = false;
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        universal_assumptions = universal_assumptions || qcnf_is_universal(c2->qcnf, lit_to_var(int_vector_get(c2->assumptions, i)));
+    }
+    if (! universal_assumptions) {
+        return true;
+    }
+    bool refutation_available = satsolver_state(c2->cs->exists_solver) == SATSOLVER_UNSAT
+                             || c2->skolem->state == SKOLEM_STATE_CONSTANTS_CONLICT
+                             || satsolver_state(c2->skolem->skolem) == SATSOLVER_SAT;
+    if (! refutation_available) {
+        return false;
+    }
+    int_vector* refutation = c2_refuting_assignment(c2);
+    bool confirms = true;
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_universal(c2->qcnf, lit_to_var(lit)) && ! int_vector_contains(refutation, lit)) {
+            confirms = false;
+        }
+    }
+    int_vector_free(refutation);
+    return confirms;
+}
+
+// The formula is false, but the refutation may violate the universal assumptions. The Skolem domain cannot recover from
+// conflicts on level 0, so we solve a copy of the formula in which the universal assumptions are substituted.
+void c2_solve_copy_under_assumptions(C2* c2) {
+    int_vector_reset(c2->failed_assumptions);
+    int_vector_reset(c2->refutation_under_assumptions);
+    if (c2_universal_assumptions_contradict(c2)) {
+        return;
+    }
+    V1("Refutation does not confirm the universal assumptions; solving a copy of the formula.\n");
+    C2* copy = c2_init(c2->options);
+    copy->terminate = c2->terminate;
+    copy->terminate_callback = c2->terminate_callback;
+    copy->terminate_state = c2->terminate_state;
+    // The copy accounts to our profile; it must not export one of its own
+    if (copy->profiler) {
+        profiler_free(copy->profiler);
+    }
+    copy->profiler = c2->profiler;
+    copy->skolem->profiler = c2->profiler;
+    for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+        if (qcnf_var_exists(c2->qcnf, i)) {
+            Var* v = var_vector_get(c2->qcnf->vars, i);
+            c2_new_variable(copy, v->is_universal, v->scope_id, v->var_id);
+        }
+    }
+    for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
+        Clause* c = vector_get(c2->qcnf->all_clauses, i);
+        if (! c->original || ! c->active) {
+            continue;
+        }
+        bool satisfied = false;
+        for (unsigned j = 0; j < c->size; j++) {
+            satisfied = satisfied || (qcnf_is_universal(c2->qcnf, lit_to_var(c->occs[j])) && int_vector_contains(c2->assumptions, c->occs[j]));
+        }
+        if (satisfied) {
+            continue;
+        }
+        for (unsigned j = 0; j < c->size; j++) {
+            if (! int_vector_contains(c2->assumptions, - c->occs[j])) {
+                c2_add_lit(copy, c->occs[j]);
+            }
+        }
+        c2_add_lit(copy, 0);
+    }
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (! qcnf_is_universal(c2->qcnf, lit_to_var(lit))) {
+            c2_assume(copy, lit);
+        }
+    }
+
+    cadet_res res = c2_sat(copy);
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        bool is_universal = qcnf_is_universal(c2->qcnf, lit_to_var(lit));
+        if (res == CADET_RESULT_SAT && is_universal) {
+            int_vector_add(c2->failed_assumptions, lit);
+        }
+        if (res == CADET_RESULT_UNSAT && is_universal) {
+            int_vector_add(c2->refutation_under_assumptions, lit);
+        }
+        if (res == CADET_RESULT_UNSAT && ! is_universal && c2_is_core(copy, lit)) {
+            int_vector_add(c2->failed_assumptions, lit);
+        }
+    }
+    if (res == CADET_RESULT_UNSAT) {
+        for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+            if (qcnf_var_exists(c2->qcnf, i) && qcnf_is_universal(c2->qcnf, i)
+                && ! int_vector_contains(c2->assumptions, (Lit) i) && ! int_vector_contains(c2->assumptions, - (Lit) i)) {
+                int val = c2_val(copy, (Lit) i);
+                if (val != 0) {
+                    int_vector_add(c2->refutation_under_assumptions, val);
+                }
+            }
+        }
+    }
+    copy->profiler = NULL;
+    c2_free(copy);
+
+    // The next call returns to the refuted Skolem domain
+    c2->state = res == CADET_RESULT_SAT ? C2_SAT : res == CADET_RESULT_UNSAT ? C2_UNSAT : C2_READY;
+    c2->result_is_conditional = res != CADET_RESULT_UNKNOWN;
+}
+
+void c2_conclude_assumptions(C2* c2) {
+    if (c2->state == C2_UNSAT && int_vector_count(c2->assumptions) > 0 && c2->restart_base_decision_lvl > 0) {
+        c2_determine_failed_existential_assumptions(c2);
+        int_vector* refutation = c2_refuting_assignment(c2);
+        int_vector_free(c2->refutation_under_assumptions);
+        c2->refutation_under_assumptions = refutation;
+
+        c2_leave_assumptions_level(c2);
+        if (c2->state == C2_READY) {
+            c2->state = C2_UNSAT;
+            c2->result_is_conditional = true;
+        } else { // false even without the assumptions
+            int_vector_reset(c2->failed_assumptions);
+            int_vector_reset(c2->refutation_under_assumptions);
+        }
+    }
+    c2->refuted = c2->state == C2_UNSAT && ! c2->result_is_conditional;
+    // Universal assumptions make the formula easier; a refutation only carries over if it satisfies them
+    if (c2->refuted && ! c2_refutation_confirms_assumptions(c2)) {
+        c2_solve_copy_under_assumptions(c2);
+    }
+    int_vector_reset(c2->assumptions);
+    c2->assumes_existentials = false;
+}
@@ -0,0 +1,181 @@
+//
+//  c2_miniscoping.c
+//  cadet
+//
+//  Miniscoping: after the initial propagation, the existentials that are not
+//  functions of the universals on dlvl0 often fall into independent partitions
+//  (see partitions.c). Each partition is solved as a separate 2QBF with the
+//  universals, the shared variables, and the clauses over them. The partitions
+//  are solved on a pool of threads; the first UNSAT partition refutes the
+//  formula and cancels the others cooperatively through c2->terminate.
+//
+//  Partitions keep the variable numbers of the formula, so their certificates
+//  can be merged on the same inputs (see c2_write_AIG_certificate).
+//
+
+#include "cadet_internal.h"
+#include "log.h"
+#include "util.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    C2* c2;
+    int_vector* partition_numbers; // read only while the workers run
+    vector* partition_clauses; // int_vector of clause indices for each partition; index 0 holds the shared clauses
+    Log_Settings log_settings; // log settings are thread local; workers inherit them from the main thread
+    atomic_bool terminate;
+    atomic_uint next_partition;
+} Miniscoping;
+
+static int c2_miniscoping_parent_terminated(void* state) {
+    C2* c2 = (C2*) state;
+    return c2->terminate != NULL && atomic_load(c2->terminate);
+}
+
+static C2* c2_miniscoping_build_partition(Miniscoping* m, unsigned pn) {
+    QCNF* qcnf = m->c2->qcnf;
+    Options* o = malloc(sizeof(Options));
+    memcpy(o, m->c2->options, sizeof(Options));
+    o->miniscoping = false;
+    o->profile_file_name = NULL;
+    C2* partition = c2_init(o);
+    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+        int var_pn = int_vector_get(m->partition_numbers, i);
+        if (qcnf_var_exists(qcnf, i) && (var_pn == 0 || var_pn == (int) pn)) {
+            Var* v = var_vector_get(qcnf->vars, i);
+            c2_new_variable(partition, v->is_universal, v->scope_id, v->var_id);
+        }
+    }
+    int_vector* clause_sets[2] = {vector_get(m->partition_clauses, 0), vector_get(m->partition_clauses, pn)};
+    for (unsigned s = 0; s < 2; s++) {
+        for (unsigned i = 0; i < int_vector_count(clause_sets[s]); i++) {
+            Clause* c = vector_get(qcnf->all_clauses, (unsigned) int_vector_get(clause_sets[s], i));
+            for (unsigned j = 0; j < c->size; j++) {
+                c2_add_lit(partition, c->occs[j]);
+            }
+            c2_add_lit(partition, 0);
+        }
+    }
+    partition->terminate = &m->terminate;
+    c2_set_terminate(partition, m->c2, c2_miniscoping_parent_terminated);
+    return partition;
+}
+
+static void* c2_miniscoping_worker_run(void* arg) {
+    Miniscoping* m = (Miniscoping*) arg;
+    log_set_settings(m->log_settings);
+    unsigned p = atomic_fetch_add(&m->next_partition, 1);
+    while (p < vector_count(m->c2->partitions) && ! atomic_load(&m->terminate)) {
+        C2* partition = vector_get(m->c2->partitions, p);
+        cadet_res res = c2_sat(partition);
+        V1("Partition %u: %s\n", p + 1, res == CADET_RESULT_SAT ? "SAT" : res == CADET_RESULT_UNSAT ? "UNSAT" : "UNKNOWN");
+        if (res == CADET_RESULT_UNSAT) {
+            atomic_store(&m->terminate, true);
+        }
+        p = atomic_fetch_add(&m->next_partition, 1);
+    }
+    return NULL;
+}
+
+// Splits the formula into its partitions and solves them if there are at least two. Sets c2->partitions
+// and the state of c2 to the combined result; c2 stays in C2_READY if some partition remained unsolved.
+void c2_miniscoping(C2* c2) {
+    assert(c2->partitions == NULL);
+    unsigned partitions_num = 0;
+    int_vector* partition_numbers = c2_analysis_determine_partitions(c2, &partitions_num);
+    if (partitions_num < 2
+        || c2->options->functional_synthesis
+        || c2->options->reinforcement_learning
+        || int_vector_count(c2->assumptions) > 0) {
+        int_vector_free(partition_numbers);
+        return;
+    }
+
+    Miniscoping m;
+    m.c2 = c2;
+    m.partition_numbers = partition_numbers;
+    m.partition_clauses = vector_init();
+    m.log_settings = log_get_settings();
+    atomic_init(&m.terminate, false);
+    atomic_init(&m.next_partition, 0);
+    for (unsigned pn = 0; pn <= partitions_num; pn++) {
+        vector_add(m.partition_clauses, int_vector_init());
+    }
+    for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
+        Clause* c = vector_get(c2->qcnf->all_clauses, i);
+        if (! c->original || ! c->active) {
+            continue;
+        }
+        int clause_pn = 0;
+        for (unsigned j = 0; j < c->size; j++) {
+            int var_pn = int_vector_get(partition_numbers, lit_to_var(c->occs[j]));
+            clause_pn = var_pn > clause_pn ? var_pn : clause_pn;
+        }
+        int_vector_add(vector_get(m.partition_clauses, (unsigned) clause_pn), (int) i);
+    }
+
+    V1("Solving %u partitions separately.\n", partitions_num);
+    c2->partitions = vector_init();
+    for (unsigned pn = 1; pn <= partitions_num; pn++) {
+        vector_add(c2->partitions, c2_miniscoping_build_partition(&m, pn));
+    }
+
+    unsigned threads_num = c2->options->miniscoping_threads < partitions_num ? c2->options->miniscoping_threads : partitions_num;
+    pthread_t* threads = malloc(sizeof(pthread_t) * threads_num);
+    for (unsigned i = 0; i < threads_num; i++) {
+        int err = pthread_create(&threads[i], NULL, c2_miniscoping_worker_run, &m);
+        abortif(err != 0, "Could not create thread for miniscoping worker %u.", i);
+    }
+    for (unsigned i = 0; i < threads_num; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    bool all_sat = true;
+    for (unsigned p = 0; p < vector_count(c2->partitions); p++) {
+        C2* partition = vector_get(c2->partitions, p);
+        all_sat = all_sat && partition->state == C2_SAT;
+    }
+    if (c2_miniscoping_refuted_partition(c2)) {
+        c2->state = C2_UNSAT;
+        c2->refuted = true;
+    } else if (all_sat) {
+        c2->state = C2_SAT;
+    } else {
+        c2->terminated = true;
+    }
+
+    for (unsigned pn = 0; pn < vector_count(m.partition_clauses); pn++) {
+        int_vector_free(vector_get(m.partition_clauses, pn));
+    }
+    vector_free(m.partition_clauses);
+    int_vector_free(partition_numbers);
+}
+
+// Returns a partition that was found to be UNSAT; NULL if there is none.
+C2* c2_miniscoping_refuted_partition(C2* c2) {
+    for (unsigned p = 0; c2->partitions && p < vector_count(c2->partitions); p++) {
+        C2* partition = vector_get(c2->partitions, p);
+        if (partition->state == C2_UNSAT) {
+            return partition;
+        }
+    }
+    return NULL;
+}
+
+void c2_miniscoping_free(C2* c2) {
+    if (c2->partitions == NULL) {
+        return;
+    }
+    for (unsigned p = 0; p < vector_count(c2->partitions); p++) {
+        C2* partition = vector_get(c2->partitions, p);
+        Options* o = partition->options;
+        c2_free(partition);
+        options_free(o);
+    }
+    vector_free(c2->partitions);
+    c2->partitions = NULL;
+}
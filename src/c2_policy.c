@@ -0,0 +1,213 @@
+//
+//  c2_policy.c
+//  cadet
+//
+//  The features of all candidates are gathered into one column per feature,
+//  so that the model is evaluated by loops over contiguous floats that the
+//  compiler vectorizes. Each solver loads its own copy of the policy; the
+//  columns are scratch space of the solver's thread.
+//
+
+#include "c2_policy.h"
+#include "skolem_var.h"
+#include "log.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define POLICY_MAX_HIDDEN 4096
+
+struct Policy {
+    unsigned hidden_num; // 0 for a linear model
+    float* hidden_weights; // hidden_num x POLICY_FEATURES_NUM, row major
+    float* hidden_biases;
+    float* output_weights; // hidden_num many; POLICY_FEATURES_NUM many for a linear model
+    float output_bias;
+
+    // Scratch space for the candidates of one decision
+    unsigned capacity;
+    float* features[POLICY_FEATURES_NUM]; // one column per feature
+    float* hidden; // preactivation of the current hidden unit
+    float* scores;
+};
+
+static unsigned policy_weights_num(unsigned hidden_num) {
+    if (hidden_num == 0) {
+        return POLICY_FEATURES_NUM + 1;
+    }
+    return hidden_num * POLICY_FEATURES_NUM + hidden_num + hidden_num + 1;
+}
+
+Policy* policy_init(unsigned hidden_num, const float* weights) {
+    Policy* p = malloc(sizeof(Policy));
+    p->hidden_num = hidden_num;
+    unsigned output_num = hidden_num == 0 ? POLICY_FEATURES_NUM : hidden_num;
+    p->hidden_weights = malloc(sizeof(float) * (hidden_num * POLICY_FEATURES_NUM + 1));
+    p->hidden_biases = malloc(sizeof(float) * (hidden_num + 1));
+    p->output_weights = malloc(sizeof(float) * output_num);
+    unsigned pos = 0;
+    for (unsigned i = 0; i < hidden_num * POLICY_FEATURES_NUM; i++) {
+        p->hidden_weights[i] = weights[pos++];
+    }
+    for (unsigned j = 0; j < hidden_num; j++) {
+        p->hidden_biases[j] = weights[pos++];
+    }
+    for (unsigned j = 0; j < output_num; j++) {
+        p->output_weights[j] = weights[pos++];
+    }
+    p->output_bias = weights[pos++];
+    assert(pos == policy_weights_num(hidden_num));
+
+    p->capacity = 0;
+    for (unsigned f = 0; f < POLICY_FEATURES_NUM; f++) {
+        p->features[f] = NULL;
+    }
+    p->hidden = NULL;
+    p->scores = NULL;
+    return p;
+}
+
+Policy* policy_load(const char* file_name) {
+    FILE* file = fopen(file_name, "r");
+    abortif(file == NULL, "Could not open decision policy file %s.", file_name);
+    unsigned features_num = 0;
+    unsigned hidden_num = 0;
+    abortif(fscanf(file, " cadet_policy %u %u", &features_num, &hidden_num) != 2,
+            "Decision policy file %s must start with 'cadet_policy <features> <hidden>'.", file_name);
+    abortif(features_num != POLICY_FEATURES_NUM,
+            "Decision policy in %s has %u features; expected %u.", file_name, features_num, POLICY_FEATURES_NUM);
+    abortif(hidden_num > POLICY_MAX_HIDDEN,
+            "Decision policy in %s has %u hidden units; at most %u are supported.", file_name, hidden_num, POLICY_MAX_HIDDEN);
+
+    unsigned weights_num = policy_weights_num(hidden_num);
+    float* weights = malloc(sizeof(float) * weights_num);
+    for (unsigned i = 0; i < weights_num; i++) {
+        abortif(fscanf(file, " %f", &weights[i]) != 1,
+                "Decision policy in %s has %u weights; expected %u.", file_name, i, weights_num);
+        abortif(!isfinite(weights[i]), "Decision policy in %s has a weight that is not finite.", file_name);
+    }
+    float extra;
+    abortif(fscanf(file, " %f", &extra) != EOF,
+            "Decision policy in %s has more than the expected %u weights.", file_name, weights_num);
+    fclose(file);
+
+    Policy* p = policy_init(hidden_num, weights);
+    free(weights);
+    V1("Loaded decision policy from %s (%s).\n", file_name, hidden_num == 0 ? "linear" : "MLP");
+    return p;
+}
+
+void policy_free(Policy* p) {
+    free(p->hidden_weights);
+    free(p->hidden_biases);
+    free(p->output_weights);
+    for (unsigned f = 0; f < POLICY_FEATURES_NUM; f++) {
+        free(p->features[f]);
+    }
+    free(p->hidden);
+    free(p->scores);
+    free(p);
+}
+
+static void policy_reserve(Policy* p, unsigned n) {
+    if (n <= p->capacity) {
+        return;
+    }
+    unsigned capacity = p->capacity == 0 ? 64 : p->capacity;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    for (unsigned f = 0; f < POLICY_FEATURES_NUM; f++) {
+        p->features[f] = realloc(p->features[f], sizeof(float) * capacity);
+    }
+    p->hidden = realloc(p->hidden, sizeof(float) * capacity);
+    p->scores = realloc(p->scores, sizeof(float) * capacity);
+    p->capacity = capacity;
+}
+
+// Scores the first n candidates. The inner loops run over contiguous columns and are vectorized.
+static void policy_score(Policy* p, unsigned n) {
+    float* restrict scores = p->scores;
+    for (unsigned i = 0; i < n; i++) {
+        scores[i] = p->output_bias;
+    }
+    if (p->hidden_num == 0) {
+        for (unsigned f = 0; f < POLICY_FEATURES_NUM; f++) {
+            const float* restrict x = p->features[f];
+            float w = p->output_weights[f];
+            for (unsigned i = 0; i < n; i++) {
+                scores[i] += w * x[i];
+            }
+        }
+        return;
+    }
+    float* restrict hidden = p->hidden;
+    for (unsigned j = 0; j < p->hidden_num; j++) {
+        float b = p->hidden_biases[j];
+        for (unsigned i = 0; i < n; i++) {
+            hidden[i] = b;
+        }
+        for (unsigned f = 0; f < POLICY_FEATURES_NUM; f++) {
+            const float* restrict x = p->features[f];
+            float w = p->hidden_weights[j * POLICY_FEATURES_NUM + f];
+            for (unsigned i = 0; i < n; i++) {
+                hidden[i] += w * x[i];
+            }
+        }
+        float v = p->output_weights[j];
+        for (unsigned i = 0; i < n; i++) {
+            scores[i] += v * (hidden[i] > 0.0f ? hidden[i] : 0.0f);
+        }
+    }
+}
+
+Var* c2_pick_policy_variable(C2* c2) {
+    Policy* p = c2->policy;
+    assert(p);
+    unsigned count = skolem_nondeterministic_vars_count(c2->skolem);
+    if (count == 0) {
+        return NULL;
+    }
+    policy_reserve(p, count);
+
+    float max_activity = 0.0f;
+    for (unsigned i = 0; i < count; i++) {
+        unsigned var_id = skolem_nondeterministic_vars_get(c2->skolem, i);
+        Var* v = var_vector_get(c2->qcnf->vars, var_id);
+        assert(!v->is_universal);
+        skolem_var si = skolem_get_info(c2->skolem, var_id);
+        float activity = c2_get_activity(c2, var_id);
+        max_activity = activity > max_activity ? activity : max_activity;
+        p->features[POLICY_FEATURE_ACTIVITY][i] = activity;
+        p->features[POLICY_FEATURE_POS_OCCS][i] = log1pf((float) occ_vector_count(&v->pos_occs));
+        p->features[POLICY_FEATURE_NEG_OCCS][i] = log1pf((float) occ_vector_count(&v->neg_occs));
+        p->features[POLICY_FEATURE_PURE_POS][i] = si.pure_pos ? 1.0f : 0.0f;
+        p->features[POLICY_FEATURE_PURE_NEG][i] = si.pure_neg ? 1.0f : 0.0f;
+        p->features[POLICY_FEATURE_SAVED_PHASE][i] = (float) int_vector_get(c2->saved_phases, var_id);
+    }
+    if (max_activity > 0.0f) {
+        float* restrict activities = p->features[POLICY_FEATURE_ACTIVITY];
+        float inverse = 1.0f / max_activity;
+        for (unsigned i = 0; i < count; i++) {
+            activities[i] *= inverse;
+        }
+    }
+
+    policy_score(p, count);
+
+    // ties are broken towards the smaller var_id, as the set is unordered
+    unsigned best = 0;
+    unsigned best_var_id = skolem_nondeterministic_vars_get(c2->skolem, 0);
+    for (unsigned i = 1; i < count; i++) {
+        unsigned var_id = skolem_nondeterministic_vars_get(c2->skolem, i);
+        if (p->scores[best] < p->scores[i]
+            || (p->scores[best] == p->scores[i] && var_id < best_var_id)) {
+            best = i;
+            best_var_id = var_id;
+        }
+    }
+    V3("Policy picked var %u with score %f\n", best_var_id, p->scores[best]);
+    return var_vector_get(c2->qcnf->vars, best_var_id);
+}
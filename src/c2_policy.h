@@ -0,0 +1,50 @@
+//
+//  c2_policy.h
+//  cadet
+//
+//  Learned decision policies evaluated in-process. A policy scores the
+//  nondeterministic existentials by a linear model or a small MLP over
+//  per-variable features and replaces the pure activity heuristic.
+//
+//  Policy file (text, whitespace separated; see policy_load):
+//      cadet_policy <features> <hidden>
+//      <hidden x features weights, row major>   only if hidden > 0
+//      <hidden biases>                          only if hidden > 0
+//      <output weights>                         hidden many, or features many for a linear model
+//      <output bias>
+//  The score is  output_bias + sum_j output_weights[j] * relu(hidden_biases[j] + sum_f W[j][f] * x[f])
+//  for an MLP, and  output_bias + sum_f output_weights[f] * x[f]  for a linear model.
+//
+//  The features differ from those of the RL protocol (c2_rl.h). The RL state vector describes
+//  the solver and is the same for all candidates, so it cannot rank them. The per-variable RL
+//  records (activity, conflicts, constants, membership in D) are events from which the trainer
+//  derives its own features; for nondeterministic candidates only the activity varies. The
+//  policy therefore uses the activity and cheap per-variable features of the formula and of
+//  the search, listed in policy_feature in the order of the columns. Models trained on the RL
+//  protocol have to be retrained on these features.
+//
+
+#ifndef c2_policy_h
+#define c2_policy_h
+
+#include "cadet_internal.h"
+
+// Per-variable features; the order of the feature columns in policy files.
+typedef enum {
+    POLICY_FEATURE_ACTIVITY, // activity relative to the most active candidate; in [0,1]
+    POLICY_FEATURE_POS_OCCS, // log(1 + number of positive occurrences)
+    POLICY_FEATURE_NEG_OCCS, // log(1 + number of negative occurrences)
+    POLICY_FEATURE_PURE_POS, // 1 if the positive literal is pure, else 0
+    POLICY_FEATURE_PURE_NEG, // 1 if the negative literal is pure, else 0
+    POLICY_FEATURE_SAVED_PHASE, // last value before backtracking: -1, 0 (unknown), or 1
+    POLICY_FEATURES_NUM
+} policy_feature;
+
+Policy* policy_load(const char* file_name); // aborts on malformed files
+Policy* policy_init(unsigned hidden_num, const float* weights); // weights in the order of the policy file
+void policy_free(Policy*);
+
+// Returns the nondeterministic variable with the highest score; NULL, if all variables are deterministic
+Var* c2_pick_policy_variable(C2*);
+
+#endif /* c2_policy_h */
@@ -0,0 +1,251 @@
+//
+//  c2_portfolio.c
+//  cadet
+//
+//  Portfolio mode: runs several diversified configurations of C2 in parallel
+//  threads on a formula that was parsed only once. The first worker to find a
+//  result wins; the others are cancelled cooperatively through c2->terminate.
+//
+//  C2 extends its QCNF during solving (learnt clauses, undo stack), so each
+//  worker builds its own copy from the parsed formula instead of sharing it.
+//  The parsed formula is only read by the workers.
+//
+//  Workers share short learnt clauses through an append-only buffer: writers
+//  reserve space with an atomic increment and publish a record by writing its
+//  header last. Learnt clauses hold in every Skolem function of the original
+//  formula, so they may be added to any worker, with two exceptions: workers
+//  using Plaisted-Greenbaum completion do not export, and workers that ran
+//  preprocessing do not import, as imported clauses could constrain eliminated
+//  variables and break certificate reconstruction.
+//
+
+#include "cadet_internal.h"
+#include "log.h"
+#include "util.h"
+#include "c2_rl.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct C2_Clause_Exchange {
+    atomic_int* buffer; // records [size + 1, worker id, literals...]; the header is written last
+    size_t capacity;
+    atomic_size_t end; // end of the reserved part of the buffer; may exceed the capacity
+};
+
+typedef struct {
+    C2* parsed; // read only while the workers run
+    C2_Clause_Exchange* exchange; // NULL if clause sharing is disabled
+    Log_Settings log_settings; // log settings are thread local; workers inherit them from the main thread
+    atomic_bool terminate;
+    atomic_int winner; // id of the first worker with a result; -1 if none
+} Portfolio;
+
+typedef struct {
+    Portfolio* portfolio;
+    unsigned id;
+    Options* options;
+    C2* c2;
+    cadet_res result;
+    pthread_t thread;
+} Portfolio_Worker;
+
+// Worker 0 runs the given configuration; the other workers flip one feature each and use different seeds.
+Options* c2_portfolio_worker_options(Options* base, unsigned worker_id) {
+    Options* o = malloc(sizeof(Options));
+    memcpy(o, base, sizeof(Options));
+    o->portfolio_workers = 0;
+    o->seed = base->seed + worker_id;
+    switch (worker_id % 6) {
+        case 0:
+            break;
+        case 1:
+            o->cegar = ! o->cegar;
+            break;
+        case 2:
+            o->polarity = o->polarity == POLARITY_PHASE_SAVING ? POLARITY_JEROSLOW_WANG : POLARITY_PHASE_SAVING;
+            break;
+        case 3:
+            o->casesplits = ! o->casesplits && ! o->certify_SAT; // case splits are not reliable with certificates yet
+            break;
+        case 4:
+            o->chronological_backtracking = ! o->chronological_backtracking;
+            break;
+        case 5:
+            o->preprocess = ! o->preprocess;
+            break;
+    }
+    return o;
+}
+
+C2_Clause_Exchange* c2_clause_exchange_init(size_t capacity) {
+    C2_Clause_Exchange* e = malloc(sizeof(C2_Clause_Exchange));
+    e->buffer = calloc(capacity, sizeof(atomic_int));
+    e->capacity = capacity;
+    atomic_init(&e->end, 0);
+    return e;
+}
+
+void c2_clause_exchange_free(C2_Clause_Exchange* e) {
+    free(e->buffer);
+    free(e);
+}
+
+void c2_export_clause(C2* c2, Clause* c) {
+    if (c->size > c2->magic.exchange_max_clause_size || c2->options->plaisted_greenbaum_completion) {
+        return;
+    }
+    C2_Clause_Exchange* e = c2->exchange;
+    size_t len = c->size + 2;
+    size_t pos = atomic_fetch_add(&e->end, len);
+    if (pos + len > e->capacity) {
+        return; // exchange is full; the header of a partial reservation stays 0 and blocks readers there
+    }
+    atomic_store_explicit(&e->buffer[pos + 1], (int) c2->exchange_id, memory_order_relaxed);
+    for (unsigned i = 0; i < c->size; i++) {
+        atomic_store_explicit(&e->buffer[pos + 2 + i], c->occs[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&e->buffer[pos], (int) c->size + 1, memory_order_release);
+    c2->statistics.exported_clauses += 1;
+}
+
+// Adds the clauses published by other workers since the last import. Only called on decision level 0.
+void c2_import_clauses(C2* c2) {
+    if (c2->restart_base_decision_lvl != 0 || c2->options->preprocess || c2->options->qbce) {
+        return;
+    }
+    assert(c2->skolem->decision_lvl == 0);
+    C2_Clause_Exchange* e = c2->exchange;
+    while (c2->state == C2_READY && c2->exchange_position + 2 <= e->capacity) {
+        size_t pos = c2->exchange_position;
+        int header = atomic_load_explicit(&e->buffer[pos], memory_order_acquire);
+        if (header == 0) {
+            break; // not yet published
+        }
+        unsigned size = (unsigned) header - 1;
+        c2->exchange_position += size + 2;
+        if (atomic_load_explicit(&e->buffer[pos + 1], memory_order_relaxed) == (int) c2->exchange_id) {
+            continue;
+        }
+        bool known_vars = true;
+        for (unsigned i = 0; i < size; i++) {
+            Lit lit = atomic_load_explicit(&e->buffer[pos + 2 + i], memory_order_relaxed);
+            unsigned var_id = lit_to_var(lit);
+            known_vars = known_vars && qcnf_var_exists(c2->qcnf, var_id) && qcnf_is_original(c2->qcnf, var_id);
+        }
+        if (! known_vars) {
+            continue;
+        }
+        for (unsigned i = 0; i < size; i++) {
+            qcnf_add_lit(c2->qcnf, atomic_load_explicit(&e->buffer[pos + 2 + i], memory_order_relaxed));
+        }
+        Clause* c = qcnf_close_clause(c2->qcnf);
+        if (c) { // else duplicate
+            c->original = 0;
+            c2_new_clause(c2, c); // can bring c2->state in c2_unsat
+            c2_rl_new_clause(c);
+            c2->statistics.imported_clauses += 1;
+        }
+    }
+}
+
+// Builds a fresh solver for the original clauses of the parsed formula. Does not use the clause
+// iterator, as it modifies the QCNF it iterates over.
+C2* c2_portfolio_copy_formula(C2* parsed, Options* options) {
+    QCNF* qcnf = parsed->qcnf;
+    C2* c2 = c2_init(options);
+    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+        if (qcnf_var_exists(qcnf, i)) {
+            Var* v = var_vector_get(qcnf->vars, i);
+            c2_new_variable(c2, v->is_universal, v->scope_id, v->var_id);
+            char* name = qcnf_get_variable_name(qcnf, i);
+            if (name) {
+                qcnf_set_variable_name(c2->qcnf, i, name);
+            }
+        }
+    }
+    for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
+        Clause* c = vector_get(qcnf->all_clauses, i);
+        if (! c->original || ! c->active) {
+            continue;
+        }
+        for (unsigned j = 0; j < c->size; j++) {
+            c2_add_lit(c2, c->occs[j]);
+        }
+        c2_add_lit(c2, 0);
+    }
+    return c2;
+}
+
+void* c2_portfolio_worker_run(void* arg) {
+    Portfolio_Worker* w = (Portfolio_Worker*) arg;
+    Portfolio* p = w->portfolio;
+    log_set_settings(p->log_settings);
+
+    w->c2 = c2_portfolio_copy_formula(p->parsed, w->options);
+    w->c2->terminate = &p->terminate;
+    w->c2->exchange = p->exchange;
+    w->c2->exchange_id = w->id;
+    c2_apply_formula_transformations(w->c2);
+    w->result = c2_sat(w->c2);
+
+    if (w->result != CADET_RESULT_UNKNOWN) {
+        int no_winner = -1;
+        if (atomic_compare_exchange_strong(&p->winner, &no_winner, (int) w->id)) {
+            atomic_store(&p->terminate, true);
+        }
+    }
+    return NULL;
+}
+
+cadet_res c2_solve_portfolio(C2* parsed) {
+    Options* options = parsed->options;
+    unsigned workers_num = options->portfolio_workers;
+    V0("Portfolio with %u workers.\n", workers_num);
+
+    Portfolio p;
+    p.parsed = parsed;
+    p.log_settings = log_get_settings();
+    p.exchange = options->portfolio_clause_sharing ? c2_clause_exchange_init(1 << 22) : NULL; // 16MB of literals
+    atomic_init(&p.terminate, false);
+    atomic_init(&p.winner, -1);
+
+    Portfolio_Worker* workers = malloc(sizeof(Portfolio_Worker) * workers_num);
+    for (unsigned i = 0; i < workers_num; i++) {
+        workers[i].portfolio = &p;
+        workers[i].id = i;
+        workers[i].options = c2_portfolio_worker_options(options, i);
+        workers[i].c2 = NULL;
+        workers[i].result = CADET_RESULT_UNKNOWN;
+        int err = pthread_create(&workers[i].thread, NULL, c2_portfolio_worker_run, &workers[i]);
+        abortif(err != 0, "Could not create thread for portfolio worker %u.", i);
+    }
+    for (unsigned i = 0; i < workers_num; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    cadet_res res = CADET_RESULT_UNKNOWN;
+    int winner = atomic_load(&p.winner);
+    if (winner >= 0) {
+        Portfolio_Worker* w = &workers[winner];
+        V0("Portfolio worker %d found the result.\n", winner);
+        res = w->result;
+        if (debug_verbosity >= VERBOSITY_LOW) {
+            c2_print_statistics(w->c2);
+        }
+        c2_print_result(w->c2, res);
+    } else {
+        c2_print_result(workers[0].c2, res);
+    }
+
+    for (unsigned i = 0; i < workers_num; i++) {
+        c2_free(workers[i].c2);
+        options_free(workers[i].options);
+    }
+    free(workers);
+    if (p.exchange) {
+        c2_clause_exchange_free(p.exchange);
+    }
+    return res;
+}
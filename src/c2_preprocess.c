@@ -0,0 +1,308 @@
+//
+//  c2_preprocess.c
+//  cadet
+//
+//  In-process preprocessing for 2QBF: universal reduction, pure literals,
+//  equivalent literal substitution, bounded variable elimination, and
+//  blocked clause elimination.
+//
+//  Only innermost existentials are eliminated. Every removed clause is pushed
+//  together with a witness literal onto c2->reconstruction_stack, so that the
+//  certificate can be extended to the eliminated variables (see
+//  cert_reconstruct_eliminated_variables).
+//
+
+#include "cadet_internal.h"
+#include "log.h"
+#include "c2_rl.h"
+#include "util.h"
+
+#include <stdlib.h>
+
+bool c2_preprocess_is_eliminable(C2* c2, unsigned var_id) {
+    return qcnf_var_exists(c2->qcnf, var_id)
+        && qcnf_is_existential(c2->qcnf, var_id)
+        && qcnf_var_has_unique_maximal_dependency(c2->qcnf, var_id);
+}
+
+void c2_preprocess_eliminate_clause(C2* c2, Clause* c, Lit witness) {
+    assert(c->active);
+    assert(qcnf_contains_literal(c, witness));
+    int_vector_add(c2->reconstruction_stack, (int) c->clause_idx);
+    int_vector_add(c2->reconstruction_stack, witness);
+    qcnf_unregister_clause(c2->qcnf, c);
+}
+
+// Eliminates all clauses containing lit, using witness as the witness literal.
+void c2_preprocess_eliminate_clauses_of_lit(C2* c2, Lit lit, Lit witness) {
+    occ_vector* occs = qcnf_get_occs_of_lit(c2->qcnf, lit);
+    vector* clauses = vector_init();
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        vector_add(clauses, occ_vector_get(occs, i));
+    }
+    for (unsigned i = 0; i < vector_count(clauses); i++) {
+        c2_preprocess_eliminate_clause(c2, vector_get(clauses, i), witness);
+    }
+    vector_free(clauses);
+}
+
+// Refuting assignments and certificates are computed on the clauses the solver sees; after universal
+// reduction they may not fit the original clauses anymore.
+bool c2_preprocess_may_reduce_universals(C2* c2) {
+    return ! c2->options->certify_internally_UNSAT && ! c2->options->certify_SAT;
+}
+
+// Adds the clause and applies universal reduction if allowed. Returns NULL for duplicates and tautologies.
+Clause* c2_preprocess_add_clause(C2* c2, int_vector* lits) {
+    assert(int_vector_count(lits) > 0);
+    for (unsigned i = 0; i < int_vector_count(lits); i++) {
+        qcnf_add_lit(c2->qcnf, int_vector_get(lits, i));
+    }
+    Clause* c = qcnf_close_clause(c2->qcnf);
+    if (c == NULL) {
+        return NULL;
+    }
+    Clause* reduced = c2_preprocess_may_reduce_universals(c2) ? qcnf_universal_reduction(c2->qcnf, c) : c;
+    if (reduced) {
+        c2_rl_new_clause(reduced);
+    }
+    return reduced;
+}
+
+unsigned c2_preprocess_universal_reduction(C2* c2) {
+    if (! c2_preprocess_may_reduce_universals(c2)) {
+        return 0;
+    }
+    unsigned reduced_clauses = 0;
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); Clause* c = NULL;
+    while ((c = qcnf_next_clause(&ci)) != NULL) {
+        Clause* reduced = qcnf_universal_reduction(c2->qcnf, c);
+        if (reduced != c) {
+            reduced_clauses += 1;
+            if (reduced) {
+                c2_rl_new_clause(reduced);
+            }
+        }
+    }
+    return reduced_clauses;
+}
+
+unsigned c2_preprocess_pure_literals(C2* c2) {
+    unsigned pure_literals = 0;
+    for (unsigned var_id = 1; var_id < var_vector_count(c2->qcnf->vars); var_id++) {
+        if (! c2_preprocess_is_eliminable(c2, var_id)) {
+            continue;
+        }
+        unsigned pos = occ_vector_count(qcnf_get_occs_of_lit(c2->qcnf, (Lit) var_id));
+        unsigned neg = occ_vector_count(qcnf_get_occs_of_lit(c2->qcnf, - (Lit) var_id));
+        if ((pos == 0) == (neg == 0)) {
+            continue;
+        }
+        Lit pure = pos > 0 ? (Lit) var_id : - (Lit) var_id;
+        V3("Pure literal %d\n", pure);
+        c2_preprocess_eliminate_clauses_of_lit(c2, pure, pure);
+        pure_literals += 1;
+    }
+    return pure_literals;
+}
+
+// Searches for binary clauses (x, l) and (-x, -l), which make x equivalent to -l.
+// Returns the literal equivalent to x, or 0, and the two binary clauses.
+Lit c2_preprocess_find_equivalent_literal(C2* c2, Lit x, Clause** pos_clause, Clause** neg_clause) {
+    occ_vector* pos_occs = qcnf_get_occs_of_lit(c2->qcnf, x);
+    occ_vector* neg_occs = qcnf_get_occs_of_lit(c2->qcnf, - x);
+    for (unsigned i = 0; i < occ_vector_count(pos_occs); i++) {
+        Clause* c = occ_vector_get(pos_occs, i);
+        if (c->size != 2) {
+            continue;
+        }
+        Lit other = c->occs[0] == x ? c->occs[1] : c->occs[0];
+        for (unsigned j = 0; j < occ_vector_count(neg_occs); j++) {
+            Clause* d = occ_vector_get(neg_occs, j);
+            if (d->size == 2 && qcnf_contains_literal(d, - other)) {
+                *pos_clause = c;
+                *neg_clause = d;
+                return - other;
+            }
+        }
+    }
+    return 0;
+}
+
+// Replaces x by the equivalent literal r in all clauses.
+void c2_preprocess_substitute(C2* c2, unsigned var_id, Lit r) {
+    assert(lit_to_var(r) != var_id);
+    int_vector* lits = int_vector_init();
+    vector* clauses = vector_init();
+    for (int polarity = -1; polarity <= 1; polarity += 2) {
+        occ_vector* occs = qcnf_get_occs_of_lit(c2->qcnf, polarity * (Lit) var_id);
+        for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+            vector_add(clauses, occ_vector_get(occs, i));
+        }
+    }
+    for (unsigned i = 0; i < vector_count(clauses); i++) {
+        Clause* c = vector_get(clauses, i);
+        int_vector_reset(lits);
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit l = c->occs[j];
+            if (lit_to_var(l) == var_id) {
+                int_vector_add(lits, l > 0 ? r : - r);
+            } else {
+                int_vector_add(lits, l);
+            }
+        }
+        qcnf_unregister_clause(c2->qcnf, c);
+        c2_preprocess_add_clause(c2, lits); // tautologies are satisfied by x == r
+    }
+    vector_free(clauses);
+    int_vector_free(lits);
+}
+
+unsigned c2_preprocess_equivalences(C2* c2) {
+    unsigned equivalences = 0;
+    for (unsigned var_id = 1; var_id < var_vector_count(c2->qcnf->vars); var_id++) {
+        if (! c2_preprocess_is_eliminable(c2, var_id)) {
+            continue;
+        }
+        Clause* pos_clause = NULL;
+        Clause* neg_clause = NULL;
+        Lit r = c2_preprocess_find_equivalent_literal(c2, (Lit) var_id, &pos_clause, &neg_clause);
+        if (r == 0) {
+            continue;
+        }
+        V3("Equivalence %u == %d\n", var_id, r);
+        // The two binary clauses define x as r during reconstruction; all other clauses are substituted.
+        c2_preprocess_eliminate_clause(c2, pos_clause, (Lit) var_id);
+        c2_preprocess_eliminate_clause(c2, neg_clause, - (Lit) var_id);
+        c2_preprocess_substitute(c2, var_id, r);
+        equivalences += 1;
+    }
+    return equivalences;
+}
+
+// Computes the resolvent of c1 and c2 on var_id into lits. Returns false if the resolvent is tautological.
+bool c2_preprocess_resolve(Clause* c1, Clause* c2, unsigned var_id, int_vector* lits) {
+    int_vector_reset(lits);
+    for (unsigned i = 0; i < c1->size; i++) {
+        if (lit_to_var(c1->occs[i]) != var_id) {
+            int_vector_add(lits, c1->occs[i]);
+        }
+    }
+    unsigned c1_lits = int_vector_count(lits);
+    for (unsigned i = 0; i < c2->size; i++) {
+        Lit l = c2->occs[i];
+        if (lit_to_var(l) == var_id) {
+            continue;
+        }
+        bool duplicate = false;
+        for (unsigned j = 0; j < c1_lits; j++) {
+            Lit other = int_vector_get(lits, j);
+            if (other == - l) {
+                return false;
+            }
+            duplicate = duplicate || other == l;
+        }
+        if (! duplicate) {
+            int_vector_add(lits, l);
+        }
+    }
+    return true;
+}
+
+// Bounded variable elimination: replaces the clauses of var_id by their resolvents,
+// if this does not increase the number of clauses.
+bool c2_preprocess_eliminate_variable(C2* c2, unsigned var_id) {
+    occ_vector* pos_occs = qcnf_get_occs_of_lit(c2->qcnf, (Lit) var_id);
+    occ_vector* neg_occs = qcnf_get_occs_of_lit(c2->qcnf, - (Lit) var_id);
+    unsigned pos = occ_vector_count(pos_occs);
+    unsigned neg = occ_vector_count(neg_occs);
+    if (pos == 0 || neg == 0 || pos + neg > c2->magic.bve_max_occurrences) {
+        return false;
+    }
+
+    vector* resolvents = vector_init();
+    int_vector* lits = int_vector_init();
+    bool bounded = true;
+    for (unsigned i = 0; i < pos && bounded; i++) {
+        for (unsigned j = 0; j < neg && bounded; j++) {
+            if (! c2_preprocess_resolve(occ_vector_get(pos_occs, i), occ_vector_get(neg_occs, j), var_id, lits)) {
+                continue;
+            }
+            if (int_vector_count(lits) == 0
+                || int_vector_count(lits) > c2->magic.bve_max_resolvent_size
+                || vector_count(resolvents) + 1 > pos + neg) {
+                bounded = false;
+            } else {
+                vector_add(resolvents, int_vector_copy(lits));
+            }
+        }
+    }
+    int_vector_free(lits);
+
+    if (bounded) {
+        V3("Eliminating variable %u with %u resolvents\n", var_id, vector_count(resolvents));
+        for (unsigned i = 0; i < vector_count(resolvents); i++) {
+            if (c2_preprocess_add_clause(c2, vector_get(resolvents, i))) {
+                c2->statistics.preprocessing_resolvents += 1;
+            }
+        }
+        c2_preprocess_eliminate_clauses_of_lit(c2, (Lit) var_id, (Lit) var_id);
+        c2_preprocess_eliminate_clauses_of_lit(c2, - (Lit) var_id, - (Lit) var_id);
+    }
+    for (unsigned i = 0; i < vector_count(resolvents); i++) {
+        int_vector_free(vector_get(resolvents, i));
+    }
+    vector_free(resolvents);
+    return bounded;
+}
+
+unsigned c2_preprocess_variable_elimination(C2* c2) {
+    unsigned eliminated = 0;
+    for (unsigned var_id = 1; var_id < var_vector_count(c2->qcnf->vars); var_id++) {
+        if (c2_preprocess_is_eliminable(c2, var_id) && c2_preprocess_eliminate_variable(c2, var_id)) {
+            eliminated += 1;
+        }
+    }
+    return eliminated;
+}
+
+// Rebuilds the reasoning domains, which were built while parsing, for the simplified formula.
+void c2_preprocess_rebuild_domains(C2* c2) {
+    skolem_free(c2->skolem);
+    c2->skolem = skolem_init(c2->qcnf, c2->options);
+    if (skolem_is_conflicted(c2->skolem)) {
+        c2->state = C2_UNSAT;
+    }
+    examples_free(c2->examples);
+    c2->examples = examples_init(c2->qcnf, c2->options->examples_max_num, c2->rng);
+    assert(!examples_is_conflicted(c2->examples));
+    c2_probe_caches_invalidate(c2);
+}
+
+void c2_preprocess(C2* c2) {
+    if (! qcnf_is_2QBF(c2->qcnf) || c2->options->functional_synthesis || c2->state != C2_READY) {
+        V1("Preprocessing is only available for 2QBF and not in functional synthesis mode.\n");
+        return;
+    }
+    double start_time = get_seconds();
+
+    c2->statistics.preprocessing_reduced_clauses += c2_preprocess_universal_reduction(c2);
+    for (unsigned round = 0; round < c2->magic.preprocessing_rounds; round++) {
+        unsigned pure = c2_preprocess_pure_literals(c2);
+        unsigned equivalences = c2_preprocess_equivalences(c2);
+        unsigned eliminated = c2_preprocess_variable_elimination(c2);
+        c2->statistics.preprocessing_pure_literals += pure;
+        c2->statistics.preprocessing_equivalences += equivalences;
+        c2->statistics.preprocessing_eliminated_vars += eliminated;
+        V1("Preprocessing round %u: %u pure literals, %u equivalences, %u eliminated variables\n",
+           round, pure, equivalences, eliminated);
+        if (pure + equivalences + eliminated == 0) {
+            break;
+        }
+    }
+    qcnf_blocked_clause_detection(c2->qcnf, c2->reconstruction_stack);
+
+    c2_preprocess_rebuild_domains(c2);
+    c2->statistics.preprocessing_time += get_seconds() - start_time;
+    V1("Preprocessing took %.2fs\n", c2->statistics.preprocessing_time);
+}
@@ -6,6 +6,8 @@
 //  Copyright © 2018 UC Berkeley. All rights reserved.
 //
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "c2_rl.h"
 #include "log.h"
 #include "statistics.h"
@@ -13,6 +15,15 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // a closed connection then raises SIGPIPE
+#endif
 
 typedef struct {
     Stats* stats;
@@ -24,8 +35,15 @@ typedef struct {
     bool mute;
 } RL;
 
-RL* rl = NULL;
-char* mock_file = NULL;
+// The RL protocol owns stdin and stdout, so there is at most one RL session per process. The
+// state is thread local so that solver instances on other threads never see it.
+_Thread_local RL* rl = NULL;
+_Thread_local char* mock_file = NULL;
+
+// Binary protocol; see c2_rl.h. The connection lives for the whole RL session.
+_Thread_local int rl_socket = -1; // -1 for the text protocol on stdin and stdout
+_Thread_local int_vector* rl_out = NULL; // records not yet sent
+_Thread_local int_vector* rl_in = NULL; // payload of the last record received
 
 void rl_init() {
     assert(rl == NULL);
@@ -63,33 +81,162 @@ void rl_free() {
     rl = NULL;
 }
 
+static void rl_socket_connect(const char* path) {
+    assert(rl_socket == -1);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    abortif(strlen(path) >= sizeof(addr.sun_path), "Socket path too long: %s", path);
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    abortif(fd < 0, "Could not create socket for reinforcement learning: %s", strerror(errno));
+    int err = connect(fd, (struct sockaddr*) &addr, sizeof(addr));
+    abortif(err != 0, "Could not connect to socket %s: %s", path, strerror(errno));
+    rl_socket_attach(fd);
+}
+
+static void rl_socket_flush(void);
+
+// Sends the records that are still pending, e.g. those of a mock run, which never waits for replies.
+static void rl_socket_close() {
+    if (int_vector_count(rl_out) > 0) {
+        rl_socket_flush();
+    }
+    close(rl_socket);
+    rl_socket = -1;
+    int_vector_free(rl_out);
+    int_vector_free(rl_in);
+    rl_out = NULL;
+    rl_in = NULL;
+}
+
+static void rl_socket_add_record(rl_record_type type, unsigned payload_words) {
+    int_vector_add(rl_out, (int) type);
+    int_vector_add(rl_out, (int) payload_words);
+}
+
+static void rl_socket_add_float(float f) {
+    int word;
+    memcpy(&word, &f, sizeof(word));
+    int_vector_add(rl_out, word);
+}
+
+void rl_socket_attach(int fd) {
+    assert(rl_socket == -1);
+    rl_socket = fd;
+    rl_out = int_vector_init();
+    rl_in = int_vector_init();
+}
+
+static void rl_socket_flush() {
+    const char* data = (const char*) int_vector_get_data(rl_out);
+    size_t remaining = sizeof(int) * int_vector_count(rl_out);
+    while (remaining > 0) {
+        ssize_t written = send(rl_socket, data, remaining, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        abortif(written < 0, "Connection to the trainer lost: %s", strerror(errno));
+        data += written;
+        remaining -= (size_t) written;
+    }
+    int_vector_reset(rl_out);
+}
+
+// Returns false if the connection was closed before the first byte.
+static bool rl_socket_read_words(int* words, unsigned num) {
+    char* data = (char*) words;
+    size_t remaining = sizeof(int) * num;
+    while (remaining > 0) {
+        ssize_t received = recv(rl_socket, data, remaining, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        abortif(received < 0, "Connection to the trainer lost: %s", strerror(errno));
+        if (received == 0) {
+            abortif(remaining != sizeof(int) * num, "Connection to the trainer closed within a record.");
+            return false;
+        }
+        data += received;
+        remaining -= (size_t) received;
+    }
+    return true;
+}
+
+// Sends the pending records and waits for the next record of the trainer; its payload is in rl_in.
+// Returns 0 if the trainer closed the connection.
+static rl_record_type rl_socket_read_record() {
+    rl_socket_flush();
+    int header[2];
+    if (! rl_socket_read_words(header, 2)) {
+        return 0;
+    }
+    abortif(header[1] < 0, "Illegal record length %d.", header[1]);
+    int_vector_reset(rl_in);
+    for (int i = 0; i < header[1]; i++) {
+        int_vector_add(rl_in, 0);
+    }
+    bool complete = rl_socket_read_words(int_vector_get_data(rl_in), (unsigned) header[1]);
+    abortif(header[1] > 0 && ! complete, "Connection to the trainer closed within a record.");
+    return (rl_record_type) header[0];
+}
+
 void c2_rl_print_activity(unsigned var_id, float activity) {
     if (rl && !rl->mute && activity > 0.5) {
-        LOG_PRINTF("a %u,%f\n", var_id, activity);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_ACTIVITY, 2);
+            int_vector_add(rl_out, (int) var_id);
+            rl_socket_add_float(activity);
+        } else {
+            LOG_PRINTF("a %u,%f\n", var_id, activity);
+        }
     }
 }
 
 void c2_rl_conflict(unsigned var_id) {
     if (rl && !rl->mute) {
-        LOG_PRINTF("conflict %u\n", var_id);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_CONFLICT, 1);
+            int_vector_add(rl_out, (int) var_id);
+        } else {
+            LOG_PRINTF("conflict %u\n", var_id);
+        }
     }
 }
 
 void c2_rl_update_constant_value(unsigned var_id, int val) {
     if (rl && !rl->mute) {
-        LOG_PRINTF("v %u %d\n", var_id, val);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_CONSTANT, 2);
+            int_vector_add(rl_out, (int) var_id);
+            int_vector_add(rl_out, val);
+        } else {
+            LOG_PRINTF("v %u %d\n", var_id, val);
+        }
     }
 }
 
 void c2_rl_update_unique_consequence(unsigned clause_idx, Lit lit) {
     if (rl && !rl->mute) {
-        LOG_PRINTF("uc %u %d\n", clause_idx, lit);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_UNIQUE_CONSEQUENCE, 2);
+            int_vector_add(rl_out, (int) clause_idx);
+            int_vector_add(rl_out, lit);
+        } else {
+            LOG_PRINTF("uc %u %d\n", clause_idx, lit);
+        }
     }
 }
 
 void c2_rl_update_D(unsigned var_id, bool deterministic) {
     if (rl && !rl->mute) {
-        LOG_PRINTF("u%c %u\n", deterministic?'+':'-',var_id);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_DETERMINISTIC, 2);
+            int_vector_add(rl_out, (int) var_id);
+            int_vector_add(rl_out, deterministic);
+        } else {
+            LOG_PRINTF("u%c %u\n", deterministic?'+':'-',var_id);
+        }
     }
 }
 
@@ -98,6 +245,15 @@ void c2_rl_new_clause(Clause* c) {
         if (!c->original) {
             map_add(rl->conflicts_in_reward_vector, (int) c->clause_idx, (void*) (size_t) (float_vector_count(rl->rewards) - 1));
         }
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_CLAUSE, c->size + 2);
+            int_vector_add(rl_out, (int) c->clause_idx);
+            int_vector_add(rl_out, !c->original);
+            for (unsigned i = 0; i < c->size; i++) {
+                int_vector_add(rl_out, c->occs[i]);
+            }
+            return;
+        }
         LOG_PRINTF("clause %u %u lits", c->clause_idx, !c->original);
         for (unsigned i = 0; i < c->size; i++) {
             LOG_PRINTF(" %d",c->occs[i]);
@@ -108,7 +264,12 @@ void c2_rl_new_clause(Clause* c) {
 
 void c2_rl_delete_clause(Clause* c) {
     if (rl && !rl->mute) {
-        LOG_PRINTF("delete_clause %u\n", c->clause_idx);
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_DELETE_CLAUSE, 1);
+            int_vector_add(rl_out, (int) c->clause_idx);
+        } else {
+            LOG_PRINTF("delete_clause %u\n", c->clause_idx);
+        }
     }
 }
 
@@ -125,10 +286,32 @@ void c2_rl_print_slim_state(C2* c2, unsigned conflicts_until_next_restart) {
                conflicts_until_next_restart);
 }
 
-void c2_rl_print_state(C2* c2, unsigned conflicts_until_next_restart, float max_activity) {
-    if (!rl || rl->mute) {
-        return;
-    }
+#define RL_STATE_MAX_FEATURES 40
+
+typedef struct {
+    double values[RL_STATE_MAX_FEATURES];
+    bool integral[RL_STATE_MAX_FEATURES]; // printed without decimals in the text protocol
+    unsigned count;
+} RL_State;
+
+static void rl_state_add(RL_State* state, double value, bool integral) {
+    assert(state->count < RL_STATE_MAX_FEATURES);
+    state->values[state->count] = value;
+    state->integral[state->count] = integral;
+    state->count += 1;
+}
+
+// Values that are floats in the text protocol are rounded to float before they are stored.
+static void rl_state_add_float(RL_State* state, float value) {
+    rl_state_add(state, value, false);
+}
+
+static void rl_state_add_int(RL_State* state, double value) {
+    rl_state_add(state, value, true);
+}
+
+static void c2_rl_get_state(C2* c2, unsigned conflicts_until_next_restart, float max_activity, RL_State* state) {
+    state->count = 0;
     
     // this makes sure that very large values are mapped to -1, which helps us avoid normalization ...
     int conflicts_until_next_restart_int = (int) conflicts_until_next_restart;
@@ -144,72 +327,92 @@ void c2_rl_print_state(C2* c2, unsigned conflicts_until_next_restart, float max_
     }
     float var_ratio = (float) uvar_num / (float) (var_num + 1);
     if (c2->options->rl_slim_state) {
-        LOG_PRINTF("s %u,%u,%f,%zu,%zu,%d,%f\n",
-                   c2->restart_base_decision_lvl,
-                   c2->skolem->decision_lvl,
-                   (float) int_vector_count(c2->skolem->determinization_order) / (float) (var_num + 1),
-                   c2->restarts,
-                   c2->restarts_since_last_major,
-                   conflicts_until_next_restart_int,
-                   max_activity
-                   );
-    } else {
-        // Solver state
-        LOG_PRINTF("s %u,%u,%u,%f,%zu,%zu,%d,",
-                   c2->restart_base_decision_lvl,
-                   c2->skolem->decision_lvl,
-                   int_vector_count(c2->skolem->determinization_order),
-                   (float) int_vector_count(c2->skolem->determinization_order) / (float) (var_num + 1),
-                   c2->restarts,
-                   c2->restarts_since_last_major,
-                   conflicts_until_next_restart_int
-                   );
-        
-        // Formula statistics
-        LOG_PRINTF("%u,%u,%f,",
-                   var_num,
-                   vector_count(c2->qcnf->active_clauses),
-                   var_ratio);
-        
-        // Solver statistics
-        LOG_PRINTF("%zu,%zu,%f,%f,%zu,%f,%zu,%f,%zu,%f,%zu,%f,%zu,%f,%zu,%zu,%f,%f,%zu,%f,%zu,%f,%zu,%f,%zu,%f\n",
-                   c2->statistics.decisions,
-                   c2->statistics.conflicts,
-                   (float) c2->statistics.decisions / (float) (c2->statistics.conflicts + 1),
-                   (float) c2->statistics.decisions / (float) (c2->restarts + 1),
-                   c2->skolem->statistics.propagations,
-                   (float) c2->skolem->statistics.propagations / (float) (c2->statistics.decisions + 1),
-                   c2->skolem->statistics.explicit_propagations,
-                   (float) c2->skolem->statistics.explicit_propagations / (float) (c2->skolem->statistics.propagations + 1),
-                   c2->skolem->statistics.pure_vars,
-                   (float) c2->skolem->statistics.pure_vars / (float) (c2->skolem->statistics.propagations + 1),
-                   c2->skolem->statistics.pure_constants,
-                   (float) c2->skolem->statistics.pure_constants / (float) (c2->skolem->statistics.pure_vars + 1),
-                   c2->skolem->statistics.local_determinicity_checks,
-                   (float) c2->skolem->statistics.local_determinicity_checks / (float) (c2->skolem->statistics.propagations + 1),
-                   c2->skolem->statistics.local_conflict_checks,
-                   c2->skolem->statistics.global_conflict_checks,
-                   (float) c2->skolem->statistics.global_conflict_checks / (float) (c2->skolem->statistics.local_conflict_checks + 1),
-                   (float) c2->statistics.conflicts / (float) (c2->skolem->statistics.global_conflict_checks + 1),
-                   c2->skolem->statistics.explicit_propagation_conflicts,
-                   (float) c2->skolem->statistics.explicit_propagation_conflicts / (float) (c2->statistics.conflicts + 1),
-                   c2->statistics.learnt_clauses_total_length,
-                   (float) c2->statistics.learnt_clauses_total_length / (float) (c2->statistics.conflicts + 1),
-                   c2->statistics.successful_conflict_clause_minimizations,
-                   (float) c2->statistics.successful_conflict_clause_minimizations / (float) (c2->statistics.learnt_clauses_total_length + 1),
-                   c2->statistics.cases_closed,
-                   max_activity
-                   );
+        rl_state_add_int(state, c2->restart_base_decision_lvl);
+        rl_state_add_int(state, c2->skolem->decision_lvl);
+        rl_state_add_float(state, (float) int_vector_count(c2->skolem->determinization_order) / (float) (var_num + 1));
+        rl_state_add_int(state, (double) c2->restarts);
+        rl_state_add_int(state, (double) c2->restarts_since_last_major);
+        rl_state_add_int(state, conflicts_until_next_restart_int);
+        rl_state_add_float(state, max_activity);
+        return;
+    }
+    
+    // Solver state
+    rl_state_add_int(state, c2->restart_base_decision_lvl);
+    rl_state_add_int(state, c2->skolem->decision_lvl);
+    rl_state_add_int(state, int_vector_count(c2->skolem->determinization_order));
+    rl_state_add_float(state, (float) int_vector_count(c2->skolem->determinization_order) / (float) (var_num + 1));
+    rl_state_add_int(state, (double) c2->restarts);
+    rl_state_add_int(state, (double) c2->restarts_since_last_major);
+    rl_state_add_int(state, conflicts_until_next_restart_int);
+    
+    // Formula statistics
+    rl_state_add_int(state, var_num);
+    rl_state_add_int(state, vector_count(c2->qcnf->active_clauses));
+    rl_state_add_float(state, var_ratio);
+    
+    // Solver statistics
+    rl_state_add_int(state, (double) c2->statistics.decisions);
+    rl_state_add_int(state, (double) c2->statistics.conflicts);
+    rl_state_add_float(state, (float) c2->statistics.decisions / (float) (c2->statistics.conflicts + 1));
+    rl_state_add_float(state, (float) c2->statistics.decisions / (float) (c2->restarts + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.propagations);
+    rl_state_add_float(state, (float) c2->skolem->statistics.propagations / (float) (c2->statistics.decisions + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.explicit_propagations);
+    rl_state_add_float(state, (float) c2->skolem->statistics.explicit_propagations / (float) (c2->skolem->statistics.propagations + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.pure_vars);
+    rl_state_add_float(state, (float) c2->skolem->statistics.pure_vars / (float) (c2->skolem->statistics.propagations + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.pure_constants);
+    rl_state_add_float(state, (float) c2->skolem->statistics.pure_constants / (float) (c2->skolem->statistics.pure_vars + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.local_determinicity_checks);
+    rl_state_add_float(state, (float) c2->skolem->statistics.local_determinicity_checks / (float) (c2->skolem->statistics.propagations + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.local_conflict_checks);
+    rl_state_add_int(state, (double) c2->skolem->statistics.global_conflict_checks);
+    rl_state_add_float(state, (float) c2->skolem->statistics.global_conflict_checks / (float) (c2->skolem->statistics.local_conflict_checks + 1));
+    rl_state_add_float(state, (float) c2->statistics.conflicts / (float) (c2->skolem->statistics.global_conflict_checks + 1));
+    rl_state_add_int(state, (double) c2->skolem->statistics.explicit_propagation_conflicts);
+    rl_state_add_float(state, (float) c2->skolem->statistics.explicit_propagation_conflicts / (float) (c2->statistics.conflicts + 1));
+    rl_state_add_int(state, (double) c2->statistics.learnt_clauses_total_length);
+    rl_state_add_float(state, (float) c2->statistics.learnt_clauses_total_length / (float) (c2->statistics.conflicts + 1));
+    rl_state_add_int(state, (double) c2->statistics.successful_conflict_clause_minimizations);
+    rl_state_add_float(state, (float) c2->statistics.successful_conflict_clause_minimizations / (float) (c2->statistics.learnt_clauses_total_length + 1));
+    rl_state_add_int(state, (double) c2->statistics.cases_closed);
+    rl_state_add_float(state, max_activity);
+}
+
+void c2_rl_print_state(C2* c2, unsigned conflicts_until_next_restart, float max_activity) {
+    if (!rl || rl->mute) {
+        return;
+    }
+    RL_State state;
+    c2_rl_get_state(c2, conflicts_until_next_restart, max_activity, &state);
+    if (rl_socket >= 0) {
+        rl_socket_add_record(RL_RECORD_STATE, state.count);
+        for (unsigned i = 0; i < state.count; i++) {
+            rl_socket_add_float((float) state.values[i]);
+        }
+        return;
+    }
+    LOG_PRINTF("s ");
+    for (unsigned i = 0; i < state.count; i++) {
+        LOG_PRINTF(state.integral[i] ? "%.0f" : "%f", state.values[i]);
+        LOG_PRINTF(i + 1 < state.count ? "," : "\n");
     }
 }
 
 void c2_rl_print_decision(unsigned decision_var_id, int phase) {
-    LOG_PRINTF("d %u,%d\n", decision_var_id, phase);
+    if (rl_socket >= 0) {
+        rl_socket_add_record(RL_RECORD_DECISION_TAKEN, 2);
+        int_vector_add(rl_out, (int) decision_var_id);
+        int_vector_add(rl_out, phase);
+    } else {
+        LOG_PRINTF("d %u,%d\n", decision_var_id, phase);
+    }
 }
 
 
-char *buffer = NULL;
-size_t bufsize = 32;
+_Thread_local char *buffer = NULL;
+_Thread_local size_t bufsize = 32;
 
 char* c2_rl_readline() {
     fflush(stdout); // flush stdout to make sure listening processes get the full state before printing a decision
@@ -230,7 +433,17 @@ int c2_rl_get_decision(C2* solver, unsigned default_decision, float max_activity
     bool pick_by_std_heuristic = false;
     bool restart = false;
     bool ask_on_terminal_for_line = !solver->options->reinforcement_learning_mock;
-    if (ask_on_terminal_for_line) {
+    if (ask_on_terminal_for_line && rl_socket >= 0) {
+        rl_record_type type = rl_socket_read_record();
+        if (type == RL_RECORD_DEFAULT_DECISION) {
+            pick_by_std_heuristic = true;
+        } else if (type == RL_RECORD_RESTART) {
+            restart = true;
+        } else {
+            abortif(type != RL_RECORD_DECISION || int_vector_count(rl_in) != 1, "Expected a decision from the trainer; got record type %d.", type);
+            ret = int_vector_get(rl_in, 0);
+        }
+    } else if (ask_on_terminal_for_line) {
         char *s = c2_rl_readline();
         if (s != NULL && s[0] == '?') {
             pick_by_std_heuristic = true;
@@ -287,14 +500,24 @@ int c2_rl_get_decision(C2* solver, unsigned default_decision, float max_activity
 void c2_rl_print_rewards() {
     float total = 0.0f;
     unsigned positive_reward_num = 0;
-    LOG_PRINTF("rewards");
+    if (rl_socket >= 0) {
+        rl_socket_add_record(RL_RECORD_REWARDS, float_vector_count(rl->rewards));
+    } else {
+        LOG_PRINTF("rewards");
+    }
     for (unsigned i = 0; i < float_vector_count(rl->rewards); i++) {
         float r = float_vector_get(rl->rewards, i);
-        LOG_PRINTF(" %f", r);
+        if (rl_socket >= 0) {
+            rl_socket_add_float(r);
+        } else {
+            LOG_PRINTF(" %f", r);
+        }
         total += r;
         if (r > 0.0) {positive_reward_num += 1;}
     }
-    LOG_PRINTF("\n");
+    if (rl_socket < 0) {
+        LOG_PRINTF("\n");
+    }
     V1("Total reward %f over %u decisions; %u of which are positive.\n", total, float_vector_count(rl->rewards), positive_reward_num);
 }
 
@@ -327,7 +550,6 @@ int_vector* c2_rl_test_assumptions(Skolem* s, int_vector* universal_assumptions)
     }
 }
 
-char *debug_file_name;
 
 int_vector* c2_rl_necessary_learnt_clauses(C2* solver) {
     rl_mute();
@@ -501,13 +723,41 @@ void rl_advanced_action_rewards(C2* solver) {
     }
 }
 
+// Returns the next file name sent by the trainer; NULL if the session ends. The caller frees the file name.
+static char* rl_socket_read_file_name() {
+    rl_socket_add_record(RL_RECORD_FILE_REQUEST, 0);
+    rl_record_type type = rl_socket_read_record();
+    if (type == 0) {
+        return NULL;
+    }
+    abortif(type != RL_RECORD_FILE || int_vector_count(rl_in) == 0, "Expected a file name from the trainer; got record type %d.", type);
+    size_t length = (size_t) (unsigned) int_vector_get(rl_in, 0);
+    if (length == 0) {
+        return NULL;
+    }
+    abortif(length > sizeof(int) * (int_vector_count(rl_in) - 1), "File name longer than its record.");
+    char* file_name = malloc(length + 1);
+    memcpy(file_name, int_vector_get_data(rl_in) + 1, length);
+    file_name[length] = '\0';
+    return file_name;
+}
+
 cadet_res c2_rl_run_c2(Options* o) {
+    if (o->rl_socket_path && rl_socket < 0) {
+        rl_socket_connect(o->rl_socket_path);
+    }
     while (true) {
-        rl_init();
-        
         char *file_name = NULL;
+        char *received_file_name = NULL; // owned here in the binary protocol
         if (mock_file) {
             file_name = mock_file;
+        } else if (rl_socket >= 0) {
+            received_file_name = rl_socket_read_file_name();
+            if (received_file_name == NULL) {
+                rl_socket_close();
+                return CADET_RESULT_UNKNOWN;
+            }
+            file_name = received_file_name;
         } else {
             LOG_PRINTF("Enter new filename:\n");
             fflush(stdout);
@@ -524,6 +774,7 @@ cadet_res c2_rl_run_c2(Options* o) {
             i += 1;
         }
         abortif(i >= maxlen, "File name too long.");
+        rl_init();
         FILE* file = open_possibly_zipped_file(file_name);
         C2* solver = c2_from_file(file, o);
         close_possibly_zipped_file(file_name, file);
@@ -545,13 +796,24 @@ cadet_res c2_rl_run_c2(Options* o) {
         
         rl_advanced_action_rewards(solver);
         
+        if (rl_socket >= 0) {
+            rl_socket_add_record(RL_RECORD_RESULT, 1);
+            int_vector_add(rl_out, (int) res);
+        }
         c2_rl_print_rewards();
         
         fflush(stdout);
+        if (rl_socket >= 0) {
+            rl_socket_flush();
+        }
         
         rl_free();
         c2_free(solver);
-        if (mock_file) {
+        free(received_file_name);
+        if (mock_file || c2_signal_pending()) {
+            if (rl_socket >= 0) {
+                rl_socket_close();
+            }
             return res;
         }
     }
@@ -13,6 +13,32 @@
 
 #include "cadet_internal.h"
 
+// Binary protocol, selected by --rl_socket: CADET connects to a Unix domain socket and exchanges records
+// of 32-bit words in native byte order: the record type, the number of payload words, and the payload.
+// Floats are sent as their bit patterns. Records from CADET are buffered and sent together whenever CADET
+// waits for a reply, so there is one round trip per decision.
+typedef enum {
+    // CADET to trainer
+    RL_RECORD_FILE_REQUEST = 1, // no payload; answered by RL_RECORD_FILE
+    RL_RECORD_STATE = 2, // the values of the state line of the text protocol as floats; answered by a decision
+    RL_RECORD_DECISION_TAKEN = 3, // var_id, phase
+    RL_RECORD_ACTIVITY = 4, // var_id, activity (float)
+    RL_RECORD_CONFLICT = 5, // var_id
+    RL_RECORD_CONSTANT = 6, // var_id, value
+    RL_RECORD_UNIQUE_CONSEQUENCE = 7, // clause_idx, lit
+    RL_RECORD_DETERMINISTIC = 8, // var_id, 1 for adding to D, 0 for removing
+    RL_RECORD_CLAUSE = 9, // clause_idx, 1 if learnt, literals
+    RL_RECORD_DELETE_CLAUSE = 10, // clause_idx
+    RL_RECORD_RESULT = 11, // cadet_res
+    RL_RECORD_REWARDS = 12, // one float per decision
+    
+    // Trainer to CADET
+    RL_RECORD_FILE = 64, // length of the file name in bytes, then the file name padded to full words; length 0 ends the session
+    RL_RECORD_DECISION = 65, // literal to decide on; 0 aborts the run
+    RL_RECORD_DEFAULT_DECISION = 66, // no payload; take the decision of the standard heuristic
+    RL_RECORD_RESTART = 67 // no payload
+} rl_record_type;
+
 void c2_rl_print_state(C2*, unsigned conflicts_until_next_restart, float max_activity);
 void c2_rl_print_decision(unsigned decision_var_id, int phase);
 void c2_rl_update_constant_value(unsigned var_id, int val); // val indicates if the variable is assigned a constant
@@ -28,7 +54,10 @@ void rl_mute();
 void rl_unmute();
 
 int_vector* c2_rl_necessary_learnt_clauses(C2*);
+// The RL session, its connection and the mock file are thread local, not part of a C2 instance, so
+// there can be at most one session per thread, and all instances on that thread report to it.
 cadet_res c2_rl_run_c2(Options*);
 void rl_mock_file(char*);
+void rl_socket_attach(int fd); // uses a connected socket, e.g. of a socketpair, instead of --rl_socket; closed at the end of the session
 
 #endif /* c2_rl_h */
@@ -9,6 +9,11 @@
 #include "cadet_internal.h"
 #include "log.h"
 #include "mersenne_twister.h"
+#include "c2_rl.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdlib.h>
 
 void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size) {
     unsigned kept = 0;
@@ -35,6 +40,196 @@ void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size) {
     V1("  Kept %u; deleted %u clauses\n", kept, deleted);
 }
 
+// Signature over the variables of the clause; if a clause C subsumes or strengthens D, then sig(C) is contained in sig(D).
+uint64_t c2_clause_signature(Clause* c) {
+    uint64_t sig = 0;
+    for (unsigned i = 0; i < c->size; i++) {
+        sig |= ((uint64_t) 1) << (lit_to_var(c->occs[i]) % 64);
+    }
+    return sig;
+}
+
+unsigned c2_occurrence_count(QCNF* qcnf, Lit lit) {
+    return occ_vector_count(qcnf_get_occs_of_lit(qcnf, lit)) + occ_vector_count(qcnf_get_occs_of_lit(qcnf, - lit));
+}
+
+int c2_compare_clauses_by_size(const void* a, const void* b) {
+    Clause* c1 = *(Clause**) a;
+    Clause* c2 = *(Clause**) b;
+    return (int) c1->size - (int) c2->size;
+}
+
+// Clauses that the Skolem domain still relies on must not be removed.
+bool c2_clause_is_removable(C2* c2, Clause* c) {
+    if (! c->active || c->is_cube || skolem_get_unique_consequence(c2->skolem, c) != 0) {
+        return false;
+    }
+    for (unsigned i = 0; i < c->size; i++) {
+        if (skolem_get_reason_for_constant(c2->skolem, lit_to_var(c->occs[i])) == c->clause_idx) {
+            return false;
+        }
+    }
+    return ! vector_contains(c2->skolem->clauses_to_check, c);
+}
+
+void c2_remove_subsumed_clause(C2* c2, Clause* c) {
+    qcnf_unregister_clause(c2->qcnf, c);
+    // Schedule variables for pure variable checks
+    for (unsigned i = 0; i < c->size; i++) {
+        skolem_new_variable(c2->skolem, lit_to_var(c->occs[i]));
+    }
+}
+
+/* Backward subsumption and self-subsuming resolution (strengthening) over the active clauses.
+ * Clauses are processed from short to long; each clause C looks for clauses D that it subsumes
+ * in the occurrence lists of its rarest variable. As new and minimized clauses are also processed,
+ * this covers forward subsumption of these clauses as well.
+ *
+ * Strengthening resolves on existential literals only (Q-resolution) and is disabled for DQBF.
+ * Clauses with unique consequences, reasons for constants, and clauses still waiting to be
+ * checked by the Skolem domain are never removed.
+ */
+void c2_subsume_and_strengthen(C2* c2) {
+    double start_time = get_seconds();
+    unsigned subsumed = 0;
+    unsigned strengthened = 0;
+    bool strengthening_allowed = ! qcnf_is_DQBF(c2->qcnf);
+    
+    vector* candidates = vector_init();
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); Clause* c = NULL;
+    while ((c = qcnf_next_clause(&ci)) != NULL) {
+        if (! c->is_cube) {
+            vector_add(candidates, c);
+        }
+    }
+    qsort(candidates->data, vector_count(candidates), sizeof(Clause*), c2_compare_clauses_by_size);
+    
+    unsigned signature_count = vector_count(c2->qcnf->all_clauses);
+    uint64_t* signatures = malloc(sizeof(uint64_t) * (signature_count + 1));
+    for (unsigned i = 0; i < vector_count(candidates); i++) {
+        c = vector_get(candidates, i);
+        signatures[c->clause_idx] = c2_clause_signature(c);
+    }
+    
+    int_vector* marks = int_vector_init(); // indexed by var_id; the literal of the current clause, 0 otherwise
+    for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+        int_vector_add(marks, 0);
+    }
+    vector* subsumed_clauses = vector_init();
+    int_vector* pivots = int_vector_init(); // literal to remove from the respective clause in subsumed_clauses; 0 for subsumption
+    
+    for (unsigned i = 0; i < vector_count(candidates); i++) {
+        if (c2->state != C2_READY) {break;}
+        if (i % 64 == 63 && get_seconds() - start_time > c2->magic.subsumption_time_budget) {
+            V2("Subsumption ran out of time after %u of %u clauses.\n", i, vector_count(candidates));
+            break;
+        }
+        c = vector_get(candidates, i);
+        if (! c->active || c->size == 0) {
+            continue;
+        }
+        
+        Lit rarest = c->occs[0];
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit l = c->occs[j];
+            int_vector_set(marks, lit_to_var(l), l);
+            if (c2_occurrence_count(c2->qcnf, l) < c2_occurrence_count(c2->qcnf, rarest)) {
+                rarest = l;
+            }
+        }
+        uint64_t sig = signatures[c->clause_idx];
+        
+        for (int polarity = 1; polarity >= -1; polarity -= 2) {
+            occ_vector* occs = qcnf_get_occs_of_lit(c2->qcnf, polarity * rarest);
+            for (unsigned j = 0; j < occ_vector_count(occs); j++) {
+                Clause* d = occ_vector_get(occs, j);
+                if (d == c || d->size < c->size) {
+                    continue;
+                }
+                uint64_t d_sig = d->clause_idx < signature_count ? signatures[d->clause_idx] : c2_clause_signature(d);
+                if ((sig & ~ d_sig) != 0) {
+                    continue;
+                }
+                unsigned matched = 0;
+                Lit pivot = 0;
+                for (unsigned k = 0; k < d->size; k++) {
+                    Lit l = d->occs[k];
+                    int mark = int_vector_get(marks, lit_to_var(l));
+                    if (mark == l) {
+                        matched += 1;
+                    } else if (mark == - l) {
+                        if (pivot != 0) {
+                            pivot = 0;
+                            matched = 0;
+                            break;
+                        }
+                        pivot = l;
+                    }
+                }
+                if (pivot == 0 && matched == c->size) {
+                    vector_add(subsumed_clauses, d);
+                    int_vector_add(pivots, 0);
+                } else if (pivot != 0 && matched + 1 == c->size
+                           && strengthening_allowed
+                           && qcnf_is_existential(c2->qcnf, lit_to_var(pivot))) {
+                    vector_add(subsumed_clauses, d);
+                    int_vector_add(pivots, pivot);
+                }
+            }
+        }
+        for (unsigned j = 0; j < c->size; j++) {
+            int_vector_set(marks, lit_to_var(c->occs[j]), 0);
+        }
+        
+        for (unsigned j = 0; j < vector_count(subsumed_clauses); j++) {
+            Clause* d = vector_get(subsumed_clauses, j);
+            Lit pivot = int_vector_get(pivots, j);
+            if (! c->active || ! c2_clause_is_removable(c2, d)) {
+                continue;
+            }
+            if (pivot == 0) {
+                V4("Clause %u subsumes clause %u\n", c->clause_idx, d->clause_idx);
+                if (d->original) {
+                    c->original = 1; // c now stands in for an original clause
+                }
+                c2_remove_subsumed_clause(c2, d);
+                subsumed += 1;
+            } else {
+                V4("Clause %u strengthens clause %u by removing %d\n", c->clause_idx, d->clause_idx, pivot);
+                c2_remove_subsumed_clause(c2, d);
+                for (unsigned k = 0; k < d->size; k++) {
+                    if (d->occs[k] != pivot) {
+                        qcnf_add_lit(c2->qcnf, d->occs[k]);
+                    }
+                }
+                Clause* strengthened_clause = qcnf_close_clause(c2->qcnf);
+                strengthened += 1;
+                if (strengthened_clause) { // otherwise it is a duplicate
+                    strengthened_clause->original = d->original;
+                    strengthened_clause->minimized = 1;
+                    c2_rl_new_clause(strengthened_clause);
+                    c2_new_clause(c2, strengthened_clause);
+                    if (c2->state == C2_UNSAT) {
+                        break;
+                    }
+                }
+            }
+        }
+        vector_reset(subsumed_clauses);
+        int_vector_reset(pivots);
+    }
+    
+    c2->statistics.subsumed_clauses += subsumed;
+    c2->statistics.strengthened_clauses += strengthened;
+    V2("Subsumption removed %u clauses and strengthened %u clauses in %f seconds.\n", subsumed, strengthened, get_seconds() - start_time);
+    
+    free(signatures);
+    int_vector_free(marks);
+    int_vector_free(pivots);
+    vector_free(subsumed_clauses);
+    vector_free(candidates);
+}
+
 void c2_simplify(C2* c2) {
     assert(c2->restart_base_decision_lvl == c2->skolem->decision_lvl); // because conflicts we may find are treated as UNSAT
     bool simplify_originals = c2->restarts % 15 ? false : true;
@@ -58,10 +253,10 @@ void c2_simplify(C2* c2) {
         } else {
             assert(!skolem_is_conflicted(c2->skolem));
         }
-        
-        // TODO: check if minimized clause subsumes other clauses
-        //            if (removed_literals) {
-        //                subsumes something else?
-        //            }
+    }
+    
+    // Also checks whether the minimized clauses subsume other clauses
+    if (c2->options->subsumption && c2->state == C2_READY && c2->options->examples_max_num == 0) {
+        c2_subsume_and_strengthen(c2);
     }
 }
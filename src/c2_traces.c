@@ -168,16 +168,41 @@ void c2_print_statistics(C2* c2) {
     V0("  Conflicts: %zu\n", c2->statistics.conflicts);
     V0("  Added clauses: %zu\n", c2->statistics.added_clauses);
     V0("  Levels backtracked: %zu\n", c2->statistics.lvls_backtracked);
+    if (c2->options->chronological_backtracking) {
+        V0("  Chronological backtracks: %zu\n", c2->statistics.chronological_backtracks);
+    }
     V0("  Restarts:  %zu\n", c2->restarts);
     V0("  Major restarts:  %zu\n", c2->major_restarts);
     V0("  Cases explored:  %zu\n", c2->statistics.cases_closed);
+    if (c2->statistics.sat_calls > 1) {
+        V0("  Incremental solving: %zu calls, %zu domain rebuilds\n", c2->statistics.sat_calls, c2->statistics.domain_rebuilds);
+    }
+    if (c2->options->preprocess) {
+        V0("  Preprocessing: %zu reduced clauses, %zu pure literals, %zu equivalences, %zu eliminated vars, %zu resolvents (%.2fs)\n",
+           c2->statistics.preprocessing_reduced_clauses,
+           c2->statistics.preprocessing_pure_literals,
+           c2->statistics.preprocessing_equivalences,
+           c2->statistics.preprocessing_eliminated_vars,
+           c2->statistics.preprocessing_resolvents,
+           c2->statistics.preprocessing_time);
+    }
+    V0("  Subsumed clauses: %zu\n", c2->statistics.subsumed_clauses);
+    V0("  Strengthened clauses: %zu\n", c2->statistics.strengthened_clauses);
     V0("  Literals eliminated:  %zu / %zu\n", c2->statistics.successful_conflict_clause_minimizations, c2->statistics.learnt_clauses_total_length);
     V0("  Time spent minimizing: %f\n", c2->statistics.minimization_stats->accumulated_value)
     V0("  Failed Literals Conflicts:  %zu\n", c2->statistics.failed_literals_conflicts);
+    V0("  Case split probes skipped:  %zu\n", c2->statistics.case_split_probes_skipped);
+    V0("  Probe cache hits:  %zu\n", c2->statistics.probe_cache_hits);
+    if (c2->exchange) {
+        V0("  Shared clauses: %zu exported, %zu imported\n", c2->statistics.exported_clauses, c2->statistics.imported_clauses);
+    }
     statistics_print(c2->statistics.failed_literals_stats);
+    if (c2->profiler) {
+        profiler_print(c2->profiler);
+    }
 }
 
-bool c2_printed_color_legend = false;
+_Thread_local bool c2_printed_color_legend = false; // once per thread, like the log settings
 
 void c2_print_learnt_clause_color_legend() {
     if (log_colors && !c2_printed_color_legend) {
@@ -213,22 +238,19 @@ void c2_trace_for_profiling_initialize(Options* o, SATSolver* s) {
     satsolver_measure_all_calls(s);
 }
 
-double last_time_stamp = 0.0;
-double last_satsolver_seconds = 0.0;
-
 void c2_trace_for_profiling(C2* c2) {
     if (!c2->options->trace_for_profiling) {
         return;
     }
     double total_time_passed = get_seconds() - c2->statistics.start_time;
     V0("Timestamp: %f\n", total_time_passed);
-    double time_passed_since_last = total_time_passed - last_time_stamp;
+    double time_passed_since_last = total_time_passed - c2->statistics.trace_last_time_stamp;
     
     double satsolver = satsolver_seconds(c2->skolem->skolem);
-    double satsolver_took_since_last = satsolver - last_satsolver_seconds;
+    double satsolver_took_since_last = satsolver - c2->statistics.trace_last_satsolver_seconds;
     
     V0("SATSolver current portion: %f\n", satsolver_took_since_last / time_passed_since_last);
     
-    last_time_stamp = total_time_passed;
-    last_satsolver_seconds = satsolver;
+    c2->statistics.trace_last_time_stamp = total_time_passed;
+    c2->statistics.trace_last_satsolver_seconds = satsolver;
 }
@@ -21,24 +21,22 @@
 #include "satsolver.h"
 #include "c2_traces.h"
 #include "c2_rl.h"
+#include "c2_policy.h"
 #include "mersenne_twister.h"
 
 #include <math.h>
+#include <signal.h>
 #include <stdint.h>
 #include <sys/time.h>
 
 
 C2* c2_init(Options* options) {
     if (!options) {options = default_options();}
-    if (options->fresh_random_seed) {
-        init_genrand((unsigned long)time(NULL));
-    } else {
-        init_genrand((unsigned long)options->seed);
-    }
     
     C2* c2 = malloc(sizeof(C2));
     c2->qcnf = qcnf_init();
     c2->options = options;
+    c2->rng = mersenne_twister_init(options->fresh_random_seed ? (unsigned long) time(NULL) : options->seed);
     
     c2->state = C2_READY;
     c2->restarts = 0;
@@ -48,7 +46,11 @@ C2* c2_init(Options* options) {
     c2->restart_base_decision_lvl = 0;
     c2->activity_factor = 1.0f;
     c2->activity_factor_inverse = 1.0f / c2->activity_factor;
+    c2->policy = options->decision_policy_file_name ? policy_load(options->decision_policy_file_name) : NULL;
     c2->variable_activities = float_vector_init();
+    c2->saved_phases = int_vector_init();
+    c2->out_of_order_clauses = int_vector_init();
+    c2->reconstruction_stack = int_vector_init();
     
     // DOMAINS
     c2->cs = casesplits_init(c2->qcnf);
@@ -56,7 +58,7 @@ C2* c2_init(Options* options) {
     if (skolem_is_conflicted(c2->skolem)) {
         c2->state = C2_UNSAT;
     }
-    c2->examples = examples_init(c2->qcnf, c2->options->examples_max_num);
+    c2->examples = examples_init(c2->qcnf, c2->options->examples_max_num, c2->rng);
     assert(!examples_is_conflicted(c2->examples));
     
     // Conflict analysis
@@ -73,11 +75,28 @@ C2* c2_init(Options* options) {
     c2->statistics.learnt_clauses_total_length = 0;
     c2->statistics.cases_closed = 0;
     c2->statistics.lvls_backtracked = 0;
+    c2->statistics.chronological_backtracks = 0;
+    c2->statistics.subsumed_clauses = 0;
+    c2->statistics.strengthened_clauses = 0;
+    c2->statistics.preprocessing_reduced_clauses = 0;
+    c2->statistics.preprocessing_pure_literals = 0;
+    c2->statistics.preprocessing_equivalences = 0;
+    c2->statistics.preprocessing_eliminated_vars = 0;
+    c2->statistics.preprocessing_resolvents = 0;
+    c2->statistics.preprocessing_time = 0.0;
     c2->statistics.start_time = get_seconds();
+    c2->statistics.trace_last_time_stamp = 0.0;
+    c2->statistics.trace_last_satsolver_seconds = 0.0;
     c2->statistics.minimization_stats = statistics_init(10000);
 
     c2->statistics.failed_literals_stats = statistics_init(10000);
     c2->statistics.failed_literals_conflicts = 0;
+    c2->statistics.case_split_probes_skipped = 0;
+    c2->statistics.probe_cache_hits = 0;
+    c2->statistics.exported_clauses = 0;
+    c2->statistics.imported_clauses = 0;
+    c2->statistics.sat_calls = 0;
+    c2->statistics.domain_rebuilds = 0;
 
     // Magic constants
     c2->magic.initial_restart = 6; // [1..100] // depends also on restart factor
@@ -92,6 +111,11 @@ C2* c2_init(Options* options) {
     c2->magic.num_restarts_before_Jeroslow_Wang = options->easy_debugging ? 1000 : 3;
     c2->magic.num_restarts_before_case_splits = options->easy_debugging ? 0 : 3;
     c2->magic.keeping_clauses_threshold = 3;
+    c2->magic.chronological_backtracking_min_jump = options->easy_debugging ? 1 : 10;
+    c2->magic.subsumption_time_budget = 0.05;
+    c2->magic.preprocessing_rounds = 3;
+    c2->magic.bve_max_occurrences = 16;
+    c2->magic.bve_max_resolvent_size = 20;
 
     // Magic constants for case splits
     c2->magic.skolem_success_horizon = (float) 0.9; // >0.0 && <1.0
@@ -100,21 +124,62 @@ C2* c2_init(Options* options) {
     c2->skolem_success_recent_average = c2->magic.skolem_success_recent_average_initialization;
     c2->case_split_depth_penalty = C2_CASE_SPLIT_DEPTH_PENALTY_LINEAR; // C2_CASE_SPLIT_DEPTH_PENALTY_QUADRATIC
     c2->conflicts_between_case_splits_countdown = 1;
+    c2->probe_caches = vector_init();
     c2->magic.case_split_linear_depth_penalty_factor = options->easy_debugging ? 1 : 5;
+    c2->magic.case_split_probe_budget = options->easy_debugging ? 3 : 64;
+    
+    // Magic constants for the portfolio
+    c2->magic.exchange_max_clause_size = 8;
+    
+    c2->terminate = NULL;
+    c2->exchange = NULL;
+    c2->exchange_id = 0;
+    c2->exchange_position = 0;
+    c2->partitions = NULL;
+    
+    c2->assumptions = int_vector_init();
+    c2->failed_assumptions = int_vector_init();
+    c2->refutation_under_assumptions = int_vector_init();
+    c2->result_is_conditional = false;
+    c2->refuted = false;
+    c2->assumes_existentials = false;
+    c2->solving = false;
+    c2->terminate_callback = NULL;
+    c2->terminate_state = NULL;
+    c2->terminated = false;
+    c2->solve_start_time = 0.0;
+    c2->solve_start_conflicts = 0;
+    c2->profiler = options->profile_file_name ? profiler_init(options->profile_file_name) : NULL;
+    c2->skolem->profiler = c2->profiler;
     
     return c2;
 }
 
 void c2_free(C2* c2) {
+    c2_miniscoping_free(c2);
     statistics_free(c2->statistics.failed_literals_stats);
+    if (c2->profiler) {
+        profiler_export(c2->profiler);
+        profiler_free(c2->profiler);
+    }
     skolem_free(c2->skolem);
     if (c2->cs) {casesplits_free(c2->cs); c2->cs = NULL;}
     examples_free(c2->examples);
     conflict_analysis_free(c2->ca);
     qcnf_free(c2->qcnf);
+    if (c2->policy) {policy_free(c2->policy);}
     partial_assignment_free(c2->minimization_pa);
     statistics_free(c2->statistics.minimization_stats);
     float_vector_free(c2->variable_activities);
+    int_vector_free(c2->saved_phases);
+    int_vector_free(c2->out_of_order_clauses);
+    int_vector_free(c2->reconstruction_stack);
+    c2_probe_caches_invalidate(c2);
+    vector_free(c2->probe_caches);
+    mersenne_twister_free(c2->rng);
+    int_vector_free(c2->assumptions);
+    int_vector_free(c2->failed_assumptions);
+    int_vector_free(c2->refutation_under_assumptions);
     free(c2);
 }
 
@@ -163,20 +228,20 @@ void c2_rescale_activity_values(C2* c2) {
 Var* c2_pick_max_activity_variable(C2* c2) {
     Var* var = NULL;
     float decision_var_activity = -1.0;
-    for (unsigned i = 1; i < var_vector_count(c2->qcnf->vars); i++) {
-        if (!skolem_is_deterministic(c2->skolem, i)) {
-            Var* v = var_vector_get(c2->qcnf->vars, i);
-            assert(!v->is_universal);
-            if (v->var_id != 0) {
-                assert(v->var_id == i);
-                float v_activity = c2_get_activity(c2, v->var_id);
-                c2_rl_print_activity(v->var_id, v_activity);
-                assert(v_activity > -0.001);
-                if (decision_var_activity < v_activity) {
-                    decision_var_activity = v_activity;
-                    var = v;
-                }
-            }
+    unsigned count = skolem_nondeterministic_vars_count(c2->skolem);
+    for (unsigned i = 0; i < count; i++) {
+        unsigned var_id = skolem_nondeterministic_vars_get(c2->skolem, i);
+        Var* v = var_vector_get(c2->qcnf->vars, var_id);
+        assert(!v->is_universal);
+        assert(v->var_id == var_id);
+        float v_activity = c2_get_activity(c2, var_id);
+        c2_rl_print_activity(var_id, v_activity);
+        assert(v_activity > -0.001);
+        // ties are broken towards the smaller var_id, as the set is unordered
+        if (decision_var_activity < v_activity
+            || (decision_var_activity == v_activity && var_id < var->var_id)) {
+            decision_var_activity = v_activity;
+            var = v;
         }
     }
     V3("Maximal activity is %f for var %u\n", decision_var_activity, var==NULL ? 0 : var->var_id);
@@ -185,41 +250,56 @@ Var* c2_pick_max_activity_variable(C2* c2) {
 
 // Returns NULL, if all variables are decided
 Var* c2_pick_nondeterministic_variable(C2* c2) {
-    if (!c2->options->random_decisions) {  // Pick variable with highest activity
+    if (!c2->options->random_decisions && c2->policy) {  // Pick variable with highest score of the learned policy
+        return c2_pick_policy_variable(c2);
+    } else if (!c2->options->random_decisions) {  // Pick variable with highest activity
         return c2_pick_max_activity_variable(c2);
     } else {  // Pick a random nondeterministic variable
-        Var* decision_var = NULL;
-        long candidate_quality = LONG_MIN;
-        for (unsigned i = 1; i < var_vector_count(c2->qcnf->vars); i++) {
-            if (!skolem_is_deterministic(c2->skolem, i)) {
-                Var* v = var_vector_get(c2->qcnf->vars, i);
-                assert(!v->is_universal);
-                if (v->var_id != 0) {
-                    assert(v->var_id == i);
-                    long random_quality = genrand_int31();
-                    if (!decision_var || random_quality > candidate_quality) {
-                        candidate_quality = random_quality;
-                        decision_var = v;
-                    }
-                }
-            }
+        unsigned count = skolem_nondeterministic_vars_count(c2->skolem);
+        if (count == 0) {
+            return NULL;
         }
+        unsigned idx = (unsigned) genrand_int31(c2->rng) % count;
+        Var* decision_var = var_vector_get(c2->qcnf->vars, skolem_nondeterministic_vars_get(c2->skolem, idx));
+        assert(!decision_var->is_universal);
         V3("Randomly picked var %u\n", decision_var->var_id);
         return decision_var;
     }
 }
 
 
-void c2_backtrack_to_decision_lvl(C2 *c2, unsigned backtracking_lvl) {
+// Remembers the values of the variables that are about to lose their value by backtracking.
+void c2_save_phases(C2* c2, unsigned backtracking_lvl) {
+    int_vector* determinization_order = c2->skolem->determinization_order;
+    for (unsigned i = int_vector_count(determinization_order); i > 0; i--) {
+        unsigned var_id = (unsigned) int_vector_get(determinization_order, i - 1);
+        if (skolem_get_decision_lvl(c2->skolem, var_id) <= backtracking_lvl) {
+            break;
+        }
+        int val = skolem_get_constant_value(c2->skolem, (Lit) var_id);
+        if (val == 0) {
+            val = skolem_get_decision_val(c2->skolem, var_id);
+        }
+        if (val != 0 && var_id < int_vector_count(c2->saved_phases)) {
+            int_vector_set(c2->saved_phases, var_id, val);
+        }
+    }
+}
+
+// Returns false if re-adding out-of-order clauses brought the domain into conflict.
+bool c2_backtrack_to_decision_lvl(C2 *c2, unsigned backtracking_lvl) {
     assert(backtracking_lvl <= c2->skolem->decision_lvl);
     if (backtracking_lvl == c2->skolem->decision_lvl) {
         V4("No backtracking happening.\n");
-        return;
+        return true;
     }
     if (c2->state == C2_UNSAT) {
         LOG_WARNING("Backtracking from permanent conflict state. Potential inefficiency or usage mistake.\n");
     }
     V2("Backtracking to level %u\n", backtracking_lvl);
+    if (c2->options->polarity == POLARITY_PHASE_SAVING) {
+        c2_save_phases(c2, backtracking_lvl);
+    }
     c2->state = C2_READY;
     while (c2->skolem->decision_lvl > backtracking_lvl) {
         assert(c2->skolem->stack->push_count == c2->examples->stack->push_count);
@@ -227,6 +307,60 @@ void c2_backtrack_to_decision_lvl(C2 *c2, unsigned backtracking_lvl) {
         skolem_pop(c2->skolem);
         examples_pop(c2->examples);
     }
+    if (int_vector_count(c2->out_of_order_clauses) > 0) {
+        return c2_readd_out_of_order_clauses(c2);
+    }
+    return true;
+}
+
+// Learnt clauses that were added above their backjumping lvl lose their consequences when their lvl
+// is popped, even if we stay above the backjumping lvl. Adding them again restores these consequences.
+// Once we are at or below the backjumping lvl, the clause is in order and we can forget about it.
+// Adding a clause again can bring the domain into conflict. Above its backjumping lvl, the conflict is
+// due to the decisions in between, so we backtrack to the backjumping lvl, where the clause is in order.
+// On the backjumping lvl, the conflict stays. Above the restart base lvl it is an ordinary conflict that
+// needs to be analyzed; on the restart base lvl it is permanent and c2_new_clause has set the state.
+// Returns false if the domain is in conflict.
+bool c2_readd_out_of_order_clauses(C2* c2) {
+    unsigned dlvl = c2->skolem->decision_lvl;
+    unsigned j = 0;
+    unsigned conflict_backjumping_lvl = dlvl;
+    for (unsigned i = 0; i + 2 < int_vector_count(c2->out_of_order_clauses); i += 3) {
+        unsigned clause_idx = (unsigned) int_vector_get(c2->out_of_order_clauses, i);
+        unsigned backjumping_lvl = (unsigned) int_vector_get(c2->out_of_order_clauses, i + 1);
+        unsigned insertion_lvl = (unsigned) int_vector_get(c2->out_of_order_clauses, i + 2);
+        Clause* c = vector_get(c2->qcnf->all_clauses, clause_idx);
+        if (c == NULL || ! c->active || dlvl < backjumping_lvl) {
+            continue; // drop
+        }
+        if (c2->state == C2_READY && dlvl < insertion_lvl) {
+            V3("Re-adding out-of-order clause %u on lvl %u\n", clause_idx, dlvl);
+            c2_new_clause(c2, c);
+            insertion_lvl = dlvl;
+            if (c2->state != C2_READY) {
+                V2("Out-of-order clause %u is in conflict on lvl %u\n", clause_idx, dlvl);
+                conflict_backjumping_lvl = backjumping_lvl > c2->restart_base_decision_lvl ? backjumping_lvl : c2->restart_base_decision_lvl;
+            }
+        }
+        if (insertion_lvl > backjumping_lvl) { // keep
+            int_vector_set(c2->out_of_order_clauses, j, (int) clause_idx);
+            int_vector_set(c2->out_of_order_clauses, j + 1, (int) backjumping_lvl);
+            int_vector_set(c2->out_of_order_clauses, j + 2, (int) insertion_lvl);
+            j += 3;
+        }
+    }
+    while (int_vector_count(c2->out_of_order_clauses) > j) {
+        int_vector_pop(c2->out_of_order_clauses);
+    }
+    if (conflict_backjumping_lvl < dlvl) {
+        c2->state = C2_READY; // the conflict is not permanent; backtracking undoes it and re-adds the clauses
+        return c2_backtrack_to_decision_lvl(c2, conflict_backjumping_lvl);
+    }
+    if (c2->state != C2_READY && dlvl > c2->restart_base_decision_lvl) {
+        assert(skolem_is_conflicted(c2->skolem));
+        c2->state = C2_SKOLEM_CONFLICT;
+    }
+    return c2->state == C2_READY;
 }
 
 unsigned c2_are_decisions_involved(C2* c2, Clause* conflict) {
@@ -265,25 +399,29 @@ unsigned c2_are_decisions_involved(C2* c2, Clause* conflict) {
     return res;
 }
 
+// Decision level of the variable in the conflicted domain
+unsigned c2_get_conflict_dlvl(C2* c2, unsigned var_id) {
+    unsigned dlvl;
+    if (c2->state == C2_SKOLEM_CONFLICT) {
+        dlvl = skolem_get_decision_lvl(c2->skolem, var_id);
+        unsigned constant_dlvl = skolem_get_dlvl_for_constant(c2->skolem, var_id);
+        if (constant_dlvl < dlvl) {
+            dlvl = constant_dlvl;
+        }
+    } else {
+        assert(c2->state == C2_EXAMPLES_CONFLICT);
+        PartialAssignment* pa = examples_get_conflicted_assignment(c2->examples);
+        dlvl = partial_assignment_get_decision_lvl(pa, var_id);
+    }
+    return dlvl;
+}
+
 // Returns the second largest decision level -1 that occurs in the conflict. If no second largest decision level exists, returns 0.
 unsigned c2_determine_backtracking_lvl(C2* c2, Clause* conflict) {
     int_vector* dlvls = int_vector_init();
     V2("Decision lvls in conflicted domain:");
     for (unsigned i = 0; i < conflict->size; i++) {
-        Lit lit = conflict->occs[i];
-        unsigned var_id = lit_to_var(lit);
-        unsigned dlvl;
-        if (c2->state == C2_SKOLEM_CONFLICT) {
-            dlvl = skolem_get_decision_lvl(c2->skolem, var_id);
-            unsigned constant_dlvl = skolem_get_dlvl_for_constant(c2->skolem, var_id);
-            if (constant_dlvl < dlvl) {
-                dlvl = constant_dlvl;
-            }
-        } else {
-            assert(c2->state == C2_EXAMPLES_CONFLICT);
-            PartialAssignment* pa = examples_get_conflicted_assignment(c2->examples);
-            dlvl = partial_assignment_get_decision_lvl(pa, var_id);
-        }
+        unsigned dlvl = c2_get_conflict_dlvl(c2, lit_to_var(conflict->occs[i]));
         V2(" %u", dlvl);
         int_vector_add(dlvls, (int) dlvl);
     }
@@ -300,9 +438,41 @@ unsigned c2_determine_backtracking_lvl(C2* c2, Clause* conflict) {
         second_largest = (unsigned) int_vector_get(dlvls, int_vector_count(dlvls) - 2);
     }
     second_largest = second_largest < c2->restart_base_decision_lvl ? c2->restart_base_decision_lvl : second_largest;
+    int_vector_free(dlvls);
     return second_largest;
 }
 
+// Chronological backtracking: When the backjump would throw away many levels, we only undo the levels
+// down to the highest level in the learnt clause. The consequences of the learnt clause are then
+// attributed to a higher decision level than necessary. The clause is remembered as out of order, so
+// its consequences can be restored when that level is popped (see c2_readd_out_of_order_clauses).
+// Examples are not supported, as adding the clause above its backjumping lvl could conflict with them.
+unsigned c2_chronological_backtracking_lvl(C2* c2, Clause* learnt_clause, unsigned backjumping_lvl) {
+    assert(backjumping_lvl <= c2->skolem->decision_lvl);
+    if (c2->options->functional_synthesis
+        || c2->options->examples_max_num > 0
+        || c2->skolem->decision_lvl - backjumping_lvl < c2->magic.chronological_backtracking_min_jump) {
+        return backjumping_lvl;
+    }
+    unsigned conflict_lvl = 0;
+    for (unsigned i = 0; i < learnt_clause->size; i++) {
+        unsigned dlvl = c2_get_conflict_dlvl(c2, lit_to_var(learnt_clause->occs[i]));
+        if (dlvl > conflict_lvl) {
+            conflict_lvl = dlvl;
+        }
+    }
+    if (conflict_lvl <= backjumping_lvl + 1) {
+        return backjumping_lvl;
+    }
+    assert(conflict_lvl <= c2->skolem->decision_lvl);
+    c2->statistics.chronological_backtracks += 1;
+    V3("Chronological backtracking to lvl %u instead of %u\n", conflict_lvl - 1, backjumping_lvl);
+    int_vector_add(c2->out_of_order_clauses, (int) learnt_clause->clause_idx);
+    int_vector_add(c2->out_of_order_clauses, (int) backjumping_lvl);
+    int_vector_add(c2->out_of_order_clauses, (int) conflict_lvl - 1);
+    return conflict_lvl - 1;
+}
+
 void c2_decay_activity(C2* c2) {
     assert(c2->activity_factor > 0);
     assert(isfinite(c2->activity_factor));
@@ -314,18 +484,30 @@ void c2_decay_activity(C2* c2) {
     c2->activity_factor_inverse = 1.0f / c2->activity_factor;
 }
 
-float c2_Jeroslow_Wang_log_weight(vector* clauses) {
-    float weight = 0;
-    for (unsigned i = 1; i < vector_count(clauses); i++) {
-        Clause* c = vector_get(clauses, i);
-        if (c->size <= 10) {
-            float power = (float) pow(2,(double) c->size);
-            weight += 1.0f / power;
+int c2_pick_Jeroslow_Wang_phase(C2* c2, Var* decision_var) {
+    if (c2->restarts < c2->magic.num_restarts_before_Jeroslow_Wang) {
+        return 1;
+    }
+    double pos_JW_weight = qcnf_get_Jeroslow_Wang_weight(c2->qcnf,   (Lit) decision_var->var_id);
+    double neg_JW_weight = qcnf_get_Jeroslow_Wang_weight(c2->qcnf, - (Lit) decision_var->var_id);
+    return pos_JW_weight > neg_JW_weight ? 1 : -1;
+}
+
+int c2_pick_phase(C2* c2, Var* decision_var) {
+    switch (c2->options->polarity) {
+        case POLARITY_POSITIVE:
+            return 1;
+        case POLARITY_NEGATIVE:
+            return -1;
+        case POLARITY_PHASE_SAVING: {
+            int saved_phase = int_vector_get(c2->saved_phases, decision_var->var_id);
+            return saved_phase != 0 ? saved_phase : c2_pick_Jeroslow_Wang_phase(c2, decision_var);
         }
+        case POLARITY_JEROSLOW_WANG:
+            return c2_pick_Jeroslow_Wang_phase(c2, decision_var);
+        default:
+            abort();
     }
-    assert(weight >= 0);
-    weight += ((float)vector_count(clauses)) * 0.05f;
-    return weight;
 }
 
 bool c2_is_in_conflcit(C2* c2) {
@@ -335,7 +517,9 @@ bool c2_is_in_conflcit(C2* c2) {
 }
 
 void c2_propagate(C2* c2) {
+    profiler_begin(c2->profiler, PROFILER_EXAMPLES_PROPAGATION);
     examples_propagate(c2->examples);
+    profiler_end(c2->profiler, PROFILER_EXAMPLES_PROPAGATION);
     if (examples_is_conflicted(c2->examples)) {
         assert(c2->state == C2_READY); // may fail?
         c2->state = C2_EXAMPLES_CONFLICT;
@@ -362,7 +546,13 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
         c2_propagate(c2);
         
         if (c2_is_in_conflcit(c2)) {
+            if (int_vector_count(c2->assumptions) > 0 && c2->skolem->decision_lvl == c2->restart_base_decision_lvl) {
+                // No decisions involved; the assumptions are refuted. Conflict analysis could only restate existing clauses.
+                c2->state = C2_UNSAT;
+                return;
+            }
             Clause* learnt_clause = NULL;
+            profiler_begin(c2->profiler, PROFILER_CONFLICT_ANALYSIS);
             if (examples_is_conflicted(c2->examples)) {
                 PartialAssignment* pa = examples_get_conflicted_assignment(c2->examples);
                 c2_rl_conflict(pa->conflicted_var);
@@ -386,6 +576,7 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                                                  skolem_is_legal_dependence_for_conflict_analysis,
                                                  skolem_get_decision_lvl_for_conflict_analysis);
             }
+            profiler_end(c2->profiler, PROFILER_CONFLICT_ANALYSIS);
             
             if (learnt_clause == NULL) {
                 abortif(satsolver_sat(c2->skolem->skolem) == SATSOLVER_SAT, "Conflict clause could not be created. Conflict counter: %zu", c2->statistics.conflicts);
@@ -425,10 +616,13 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                 }
 
                 // Do CEGAR iteration(s)
-                if (c2->options->cegar && c2->skolem->state == SKOLEM_STATE_SKOLEM_CONFLICT) {
+                // The existential solver of CEGAR does not know the existential assumptions
+                if (c2->options->cegar && ! c2->assumes_existentials && c2->skolem->state == SKOLEM_STATE_SKOLEM_CONFLICT) {
                     
                     for (unsigned i = 0; i < c2->cs->cegar_magic.max_cegar_iterations_per_learnt_clause; i++) {
+                        profiler_begin(c2->profiler, PROFILER_CEGAR_ROUND);
                         cegar_one_round_for_conflicting_assignment(c2);
+                        profiler_end(c2->profiler, PROFILER_CEGAR_ROUND);
                         if (c2->state == C2_UNSAT) {
                             return;
                         }
@@ -448,20 +642,32 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
             }
             
             unsigned backtracking_lvl = c2_determine_backtracking_lvl(c2, learnt_clause);
+            if (c2->options->chronological_backtracking) {
+                backtracking_lvl = c2_chronological_backtracking_lvl(c2, learnt_clause, backtracking_lvl);
+            }
             V2("Learnt clause has length %u. Backtracking %u lvls to lvl %u\n",
                learnt_clause->size,
                c2->skolem->decision_lvl - backtracking_lvl,
                backtracking_lvl);
             unsigned old_dlvl = c2->skolem->decision_lvl;
-            c2_backtrack_to_decision_lvl(c2, backtracking_lvl);
+            bool readd_conflict = ! c2_backtrack_to_decision_lvl(c2, backtracking_lvl);
             c2->statistics.lvls_backtracked += old_dlvl - c2->skolem->decision_lvl;
             
             c2_new_clause(c2, learnt_clause); // can bring c2->state in c2_unsat
             c2->statistics.added_clauses += 1;
+            if (c2->exchange) {c2_export_clause(c2, learnt_clause);}
             
             c2_decay_activity(c2);
             c2_log_clause(c2, learnt_clause);
             c2_trace_for_profiling(c2);
+            
+            if (readd_conflict && c2->skolem->decision_lvl > c2->restart_base_decision_lvl) {
+                // A re-added out-of-order clause is in conflict; the learnt clause joins the conflicted domain
+                // and the conflict is analyzed in the next iteration.
+                V2("Analyzing the conflict of a re-added out-of-order clause on lvl %u\n", c2->skolem->decision_lvl);
+                c2->state = C2_SKOLEM_CONFLICT;
+                continue;
+            }
 #ifdef DEBUG
             c2_validate_unique_consequences(c2);
 #endif
@@ -487,6 +693,9 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
             assert(c2->state == C2_READY);
             assert(c2->skolem->state == SKOLEM_STATE_READY);
             
+            if (c2_termination_requested(c2)) {
+                return;
+            }
             if (skolem_can_propagate(c2->skolem)) {
                 continue; // can happen when a potentially conflicted variable is not actually conflicted
             }
@@ -503,6 +712,9 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                 assert(c2->conflicts_between_case_splits_countdown > 0);
                 continue;
             } // Else continue picking a decision variable. Avoids runnint into a loop where case distinction is tried but nothing happens.
+            if (c2_termination_requested(c2)) {
+                return; // an interrupted probe may have left work in the propagation queues
+            }
 
             assert(!skolem_can_propagate(c2->skolem));
             
@@ -515,7 +727,7 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
             
             if (decision_var != NULL && c2->options->reinforcement_learning) {
                 Var* max_activity_var = decision_var;
-                if (c2->options->random_decisions) {
+                if (c2->options->random_decisions || c2->policy) {
                     max_activity_var = c2_pick_max_activity_variable(c2);
                 }
                 float max_activity = max_activity_var ? c2_get_activity(c2, max_activity_var->var_id) : 0.0f;
@@ -542,10 +754,8 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                 return;
             } else { // take a decision
                 assert(!skolem_is_conflicted(c2->skolem));
-                if (c2->restarts >= c2->magic.num_restarts_before_Jeroslow_Wang && !c2->options->reinforcement_learning) {
-                    float pos_JW_weight = c2_Jeroslow_Wang_log_weight(&decision_var->pos_occs);
-                    float neg_JW_weight = c2_Jeroslow_Wang_log_weight(&decision_var->neg_occs);
-                    phase = pos_JW_weight > neg_JW_weight ? 1 : -1;
+                if (!c2->options->reinforcement_learning) {
+                    phase = c2_pick_phase(c2, decision_var);
                 }
                 c2_scale_activity(c2, decision_var->var_id, c2->magic.decision_var_activity_modifier);
 
@@ -577,14 +787,64 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
     return; // results in a restart
 }
 
+static atomic_bool c2_signal_received = false; // shared by all solvers of the process; sticky until c2_handle_signals
+
+static void c2_signal_handler(int sig) {
+    atomic_store(&c2_signal_received, true);
+    signal(sig, SIG_DFL);
+}
+
+void c2_handle_signals() {
+    atomic_store(&c2_signal_received, false);
+    signal(SIGINT, c2_signal_handler);
+    signal(SIGTERM, c2_signal_handler);
+}
+
+bool c2_signal_pending() {
+    return atomic_load(&c2_signal_received);
+}
+
+// Cheap enough to be called in inner loops; the clock is only read if there is a time limit.
+bool c2_termination_requested(C2* c2) {
+    if (c2->terminated) {
+        return true;
+    }
+    if (atomic_load(&c2_signal_received)) {
+        V1("Terminating on signal.\n");
+        c2->terminated = true;
+    } else if ((c2->terminate != NULL && atomic_load(c2->terminate))
+               || (c2->terminate_callback != NULL && c2->terminate_callback(c2->terminate_state))
+               || c2->skolem->interrupted) {
+        V1("Terminating on request.\n");
+        c2->terminated = true;
+    } else if (c2->options->conflict_limit != 0
+               && c2->statistics.conflicts - c2->solve_start_conflicts >= c2->options->conflict_limit) {
+        V1("Conflict limit reached.\n");
+        c2->terminated = true;
+    } else if (c2->options->time_limit > 0 && get_seconds() - c2->solve_start_time >= c2->options->time_limit) {
+        V1("Time limit reached.\n");
+        c2->terminated = true;
+    }
+    return c2->terminated;
+}
+
+static int c2_termination_requested_generic(void* c2) {
+    return c2_termination_requested((C2*) c2);
+}
+
+void c2_set_terminate(C2* c2, void* state, int (*terminate)(void* state)) {
+    c2->terminate_callback = terminate;
+    c2->terminate_state = state;
+}
+
 cadet_res c2_result(C2* c2) {
     switch (c2->state) {
         case C2_SAT:
-            assert(c2->options->functional_synthesis || skolem_has_empty_domain(c2->skolem));
+            assert(c2->options->functional_synthesis || c2->result_is_conditional || c2->partitions || skolem_has_empty_domain(c2->skolem));
             return CADET_RESULT_SAT;
         case C2_UNSAT:
-            assert(satsolver_state(c2->skolem->skolem) == SATSOLVER_SAT || c2->skolem->state == SKOLEM_STATE_CONSTANTS_CONLICT);
-            assert(! skolem_has_empty_domain(c2->skolem));
+            assert(c2->result_is_conditional || c2->partitions || satsolver_state(c2->skolem->skolem) == SATSOLVER_SAT || c2->skolem->state == SKOLEM_STATE_CONSTANTS_CONLICT);
+            assert(c2->result_is_conditional || ! skolem_has_empty_domain(c2->skolem));
             return CADET_RESULT_UNSAT;
         case C2_READY:
         case C2_ABORT_RL:
@@ -632,9 +892,12 @@ void c2_replenish_skolem_satsolver(C2* c2) {
     
     Skolem* old_skolem = c2->skolem;
     c2->skolem = skolem_init(c2->qcnf, c2->options);
+    skolem_set_terminate(c2->skolem, c2, c2_termination_requested_generic);
+    c2->skolem->profiler = c2->profiler;
     
     Casesplits* old_cs = c2->cs;
     c2->cs = casesplits_init(c2->qcnf);
+    c2_probe_caches_invalidate(c2);
     
     c2_propagate(c2);
     abortif(c2->state != C2_READY, "Conflicted after replenishing.");
@@ -687,7 +950,8 @@ void c2_restart_heuristics(C2* c2) {
         c2->next_major_restart = (size_t) (c2->next_major_restart * c2->magic.restart_factor);
     }
     
-    if (c2->restarts % c2->magic.replenish_frequency == c2->magic.replenish_frequency - 1) {
+    if (c2->restarts % c2->magic.replenish_frequency == c2->magic.replenish_frequency - 1
+        && int_vector_count(c2->assumptions) == 0) { // the assumptions are the base of the case split
         V1("Stepping out of case split.\n"); // Needed to simplify replenishing
         c2_backtrack_casesplit(c2);
 //#if (USE_SOLVER == SOLVER_PICOSAT_ASSUMPTIONS)
@@ -705,6 +969,23 @@ cadet_res c2_sat(C2* c2) {
     }
     //////
     
+    abortif(c2->solving, "Recursive call of c2_sat.");
+    abortif(c2->statistics.sat_calls > 0 && c2->options->functional_synthesis, "Functional synthesis does not support incremental solving.");
+    int_vector_reset(c2->failed_assumptions);
+    int_vector_reset(c2->refutation_under_assumptions);
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        c2->assumes_existentials = c2->assumes_existentials
+                                || ! qcnf_is_universal(c2->qcnf, lit_to_var(int_vector_get(c2->assumptions, i)));
+    }
+    c2_reopen(c2, false);
+    c2->statistics.sat_calls += 1;
+    c2->solving = true;
+    c2->terminated = false;
+    c2->solve_start_time = get_seconds();
+    c2->solve_start_conflicts = c2->statistics.conflicts;
+    skolem_set_terminate(c2->skolem, c2, c2_termination_requested_generic);
+    c2->skolem->profiler = c2->profiler;
+    
     assert(c2->state == C2_UNSAT || c2->state == C2_SAT || c2->state == C2_READY);
     if (c2->state == C2_UNSAT || c2->state == C2_SAT) {
         goto return_result;
@@ -713,6 +994,7 @@ cadet_res c2_sat(C2* c2) {
     assert(c2->options->functional_synthesis || int_vector_count(c2->qcnf->universal_clauses) == 0); // they must have been detected through c2_new_clause
     
     if (c2->options->functional_synthesis) {
+        abortif(int_vector_count(c2->assumptions) != 0, "Functional synthesis does not support assumptions.");
         int_vector* tmp_vars = int_vector_init();
         for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
             int_vector_add(tmp_vars, 0);
@@ -756,12 +1038,26 @@ cadet_res c2_sat(C2* c2) {
         goto return_result;
     }
     
+    if (c2_termination_requested(c2)) {
+        goto return_result; // propagation may be incomplete
+    }
+    
     if (debug_verbosity >= VERBOSITY_HIGH) {skolem_print_deterministic_vars(c2->skolem);}
-    if (c2->options->miniscoping) {c2_analysis_determine_number_of_partitions(c2);}
-    casesplits_update_interface(c2->cs, c2->skolem);
+    if (c2->options->miniscoping && c2->statistics.sat_calls == 1) {
+        c2_miniscoping(c2);
+        if (c2->partitions) {
+            goto return_result;
+        }
+    }
+    if (! casesplits_is_initialized(c2->cs)) {
+        casesplits_update_interface(c2->cs, c2->skolem);
+    }
+    if (int_vector_count(c2->assumptions) > 0) {
+        c2_apply_assumptions(c2);
+    }
     if (c2->options->cegar_only) {
         cegar_solve_2QBF_by_cegar(c2, -1);
-        assert(c2->state == C2_SAT || c2_is_in_conflcit(c2));
+        assert(c2->state == C2_SAT || c2_is_in_conflcit(c2) || c2_termination_requested(c2));
         goto return_result;
     }
 
@@ -773,6 +1069,9 @@ cadet_res c2_sat(C2* c2) {
         }
         c2_run(c2, next_restart);
         assert(!c2_is_in_conflcit(c2) || c2->state == C2_UNSAT);
+        if (c2->state == C2_CLOSE_CASE && int_vector_count(c2->assumptions) > 0) {
+            c2_close_case_under_assumptions(c2);
+        }
         if (c2->state == C2_CLOSE_CASE) { //} skolem_is_complete(c2->skolem) && (c2->options->casesplits || c2->options->certify_SAT)) {
             bool must_be_SAT = int_vector_count(c2->skolem->universals_assumptions) == 0; // just for safety
             c2_close_case(c2);
@@ -781,16 +1080,22 @@ cadet_res c2_sat(C2* c2) {
         if (c2->options->hard_decision_limit != 0 && c2->statistics.decisions >= c2->options->hard_decision_limit) {
             goto return_result;
         }
+        if (c2->state == C2_READY && c2_termination_requested(c2)) {
+            goto return_result;
+        }
         if (c2->state == C2_READY) {
             c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
             V1("Restart %zu\n", c2->restarts);
             c2->restarts += 1;
             c2_restart_heuristics(c2);
-            if (c2->options->minimize_learnt_clauses) {c2_simplify(c2);}
+            if (c2->options->minimize_learnt_clauses || c2->options->subsumption) {c2_simplify(c2);}
+            if (c2->exchange) {c2_import_clauses(c2);}
+            if (c2->profiler) {profiler_export_periodically(c2->profiler);}
         }
     }
 return_result:
-    assert(true);
+    c2_conclude_assumptions(c2);
+    c2->solving = false;
     cadet_res result = c2_result(c2);
     assert(! c2->options->functional_synthesis || result != CADET_RESULT_UNSAT);
     return result;
@@ -798,6 +1103,9 @@ return_result:
 
 int_vector* c2_refuting_assignment(C2* c2) {
     abortif(c2->state != C2_UNSAT, "Must be in UNSAT state.");
+    if (c2_miniscoping_refuted_partition(c2)) {
+        return c2_refuting_assignment(c2_miniscoping_refuted_partition(c2));
+    }
     int_vector* a = int_vector_init();
     
     if (satsolver_state(c2->cs->exists_solver) == SATSOLVER_UNSAT) {
@@ -818,48 +1126,22 @@ int_vector* c2_refuting_assignment(C2* c2) {
     return a;
 }
 
-/**
- * c2_solve_qdimacs is the traditional entry point to C2. It reads the qdimacs, then solves, then prints and checks the result after calling c2_sat.
- */
-cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
-    if (!options) {options = default_options();}
-    FILE* file = NULL;
-    if (file_name == NULL) {
-        V0("Reading from stdin\n");
-        file = stdin;
-    } else {
-        V0("Processing file \"%s\".\n", file_name);
-        file = open_possibly_zipped_file(file_name);
-    }
-    C2* c2 = c2_from_file(file, options);
-    close_possibly_zipped_file(file_name, file);
-    
-    V1("Maximal variable index: %u\n", var_vector_count(c2->qcnf->vars));
-    V1("Number of clauses: %u\n", vector_count(c2->qcnf->all_clauses));
-    V1("Number of scopes: %u\n", vector_count(c2->qcnf->scopes));
-
-    if (qcnf_is_propositional(c2->qcnf) && ! options->use_qbf_engine_also_for_propositional_problems) {
-        LOG_WARNING("Propositional problem; using SAT solver.\n");
-        cadet_res res = c2_check_propositional(c2->qcnf, options);
-        if (! options->functional_synthesis || res == CADET_RESULT_SAT) {
-            return res;
-        } else {
-            assert(res == CADET_RESULT_UNSAT);
-            c2_add_lit(c2, 0);
-        }
-    }
-    
-    if (options->plaisted_greenbaum_completion) {
+// Completion and preprocessing as requested by the options; to be called after reading the formula.
+void c2_apply_formula_transformations(C2* c2) {
+    if (c2->options->plaisted_greenbaum_completion) {
         qcnf_plaisted_greenbaum_completion(c2->qcnf);
     }
-    if (options->qbce) {
-        qcnf_blocked_clause_detection(c2->qcnf);
+    if (c2->options->preprocess) {
+        c2_preprocess(c2);
+    } else if (c2->options->qbce) {
+        qcnf_blocked_clause_detection(c2->qcnf, c2->reconstruction_stack);
     }
+}
 
-    cadet_res res = c2_sat(c2);
-    if (debug_verbosity >= VERBOSITY_LOW) {
-        c2_print_statistics(c2);
-    }
+/**
+ * c2_print_result prints the result of c2_sat, writes the certificate if requested, and checks UNSAT results.
+ */
+void c2_print_result(C2* c2, cadet_res res) {
     switch (res) {
         case CADET_RESULT_UNKNOWN:
             V0("UNKNOWN\n");
@@ -870,7 +1152,9 @@ cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
                 printf("s cnf 1\n");
             }
             if (c2->options->certify_SAT) {
+                profiler_begin(c2->profiler, PROFILER_CERTIFICATE);
                 c2_write_AIG_certificate(c2);
+                profiler_end(c2->profiler, PROFILER_CERTIFICATE);
             }
             break;
         case CADET_RESULT_UNSAT:
@@ -904,6 +1188,52 @@ cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
 //                    "Check failed! UNSAT result could not be certified.");
             break;
     }
+}
+
+/**
+ * c2_solve_qdimacs is the traditional entry point to C2. It reads the qdimacs, then solves, then prints and checks the result after calling c2_sat.
+ */
+cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
+    if (!options) {options = default_options();}
+    FILE* file = NULL;
+    if (file_name == NULL) {
+        V0("Reading from stdin\n");
+        file = stdin;
+    } else {
+        V0("Processing file \"%s\".\n", file_name);
+        file = open_possibly_zipped_file(file_name);
+    }
+    C2* c2 = c2_from_file(file, options);
+    close_possibly_zipped_file(file_name, file);
+    
+    V1("Maximal variable index: %u\n", var_vector_count(c2->qcnf->vars));
+    V1("Number of clauses: %u\n", vector_count(c2->qcnf->all_clauses));
+    V1("Number of scopes: %u\n", vector_count(c2->qcnf->scopes));
+
+    if (qcnf_is_propositional(c2->qcnf) && ! options->use_qbf_engine_also_for_propositional_problems) {
+        LOG_WARNING("Propositional problem; using SAT solver.\n");
+        cadet_res res = c2_check_propositional(c2->qcnf, options);
+        if (! options->functional_synthesis || res == CADET_RESULT_SAT) {
+            return res;
+        } else {
+            assert(res == CADET_RESULT_UNSAT);
+            c2_add_lit(c2, 0);
+        }
+    }
+    
+    if (options->portfolio_workers > 1 && ! options->functional_synthesis) {
+        cadet_res res = c2_solve_portfolio(c2);
+        c2_free(c2);
+        return res;
+    }
+    
+    c2_apply_formula_transformations(c2);
+
+    cadet_res res = c2_sat(c2);
+    if (debug_verbosity >= VERBOSITY_LOW || c2->terminated) { // interrupted runs keep their statistics
+        c2_print_statistics(c2);
+    }
+    c2_print_result(c2, res);
     c2_free(c2);
     return res;
 }
@@ -914,6 +1244,9 @@ void c2_add_lit(C2* c2, Lit lit) {
         qcnf_add_lit(c2->qcnf, lit);
         return;
     } else {
+        if (c2->statistics.sat_calls > 0 && ! c2->solving) {
+            c2_reopen(c2, true);
+        }
         Clause* c = qcnf_close_clause(c2->qcnf);
         if (c) {
             c2_new_clause(c2, c);
@@ -927,12 +1260,18 @@ void c2_new_variable(C2* c2, bool is_universal, unsigned scope_id, unsigned var_
     while (var_id >= float_vector_count(c2->variable_activities)) {
         float_vector_add(c2->variable_activities, 0.0);
     }
+    while (var_id >= int_vector_count(c2->saved_phases)) {
+        int_vector_add(c2->saved_phases, 0);
+    }
     qcnf_new_var(c2->qcnf, is_universal, scope_id, var_id);
     skolem_new_variable(c2->skolem, var_id);
 }
 
 void c2_new_2QBF_variable(C2* c2, bool is_universal, unsigned var_id) {
     abortif(qcnf_var_exists(c2->qcnf, var_id), "Variable %u exists already.", var_id);
+    if (c2->statistics.sat_calls > 0 && ! c2->solving) {
+        c2_reopen(c2, false);
+    }
     c2_new_variable(c2, is_universal, 1, var_id);
 }
 
@@ -956,6 +1295,15 @@ void c2_new_clause(C2* c2, Clause* c) {
 
 int c2_val (C2* c2, int lit) {
     assert(c2->state == C2_UNSAT);
+    if (c2->result_is_conditional) {
+        for (unsigned i = 0; i < int_vector_count(c2->refutation_under_assumptions); i++) {
+            Lit assigned = int_vector_get(c2->refutation_under_assumptions, i);
+            if (lit_to_var(assigned) == lit_to_var(lit)) {
+                return assigned == lit ? lit : - lit;
+            }
+        }
+        return 0;
+    }
     assert(skolem_is_conflicted(c2->skolem));
     assert(qcnf_is_universal(c2->qcnf, lit_to_var(lit)));
     return skolem_get_constant_value(c2->skolem, lit) * lit;
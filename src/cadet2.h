@@ -23,11 +23,17 @@ typedef enum {
     CADET_RESULT_UNKNOWN  = 30
 } cadet_res;
 
+// Solver instances on different threads are independent, but the log settings (see log.h) and the
+// reinforcement learning session (see c2_rl.h) are per thread, not per instance: all instances on a
+// thread share them. Threads that solve on behalf of another copy its log settings explicitly.
 
 C2* c2_init(Options* options);
 void c2_free(C2*);
 
 C2* c2_from_file(FILE*, Options*);
+// Like c2_from_file, but returns NULL and sets a static error message if the file is malformed
+// (details are logged at verbosity 1). Leaves the options untouched; is_aiger reports the format.
+C2* c2_parse_file(FILE*, Options*, bool* is_aiger, const char** error);
 C2* c2_from_qaiger(aiger*, Options*);
 
 // Introduces a new variable with identifier var_id.
@@ -40,13 +46,22 @@ unsigned c2_fresh_variable(C2*, bool is_universal);
 // Variables used here must be introduced through c2_new_2QBF_variable first.
 void c2_add_lit(C2*, int literal);
 
-// Assume the value of a variable.
+// Assume the value of a variable for the next call of c2_sat; assumptions are cleared after each call.
 //  - assuming universals makes formulas easier to solve; after SAT results use c2_is_core to check if necessary
 //  - assuming existentials makes formulas harder to solve; after UNSAT results use c2_is_core to check if necessary
-// c2_is_core only works when clause minimization is switched off.
+// Clauses, variables, and assumptions can be added after each call. Learnt clauses and activities are kept;
+// closed cases are kept until clauses are added.
 void c2_assume(C2*, int literal);
 bool c2_is_core(C2*, int assumed_literal);
 
+// The solver calls terminate(state) regularly and returns CADET_RESULT_UNKNOWN once it returns non-zero.
+void c2_set_terminate(C2*, void* state, int (*terminate)(void* state));
+
+// Makes SIGINT and SIGTERM stop all solvers of the process with CADET_RESULT_UNKNOWN; a second signal kills the process.
+// A received signal stays in effect for all later calls of c2_sat until c2_handle_signals is called again.
+void c2_handle_signals(void);
+bool c2_signal_pending(void);
+
 // Solves the formula encoded in the solver and returns the result.
 cadet_res c2_sat(C2*);
 
@@ -66,6 +81,13 @@ void c2_print_statistics(C2*);
 // Then solves the problem and prints output. 
 cadet_res c2_solve_qdimacs(const char* filename, Options*);
 
-aiger* c2_qaiger_quantifier_elimination(aiger*, char* filename, Options*); // not yet implemented
+// Reads file names from the manifest (stdin if NULL), one per line, and solves them on a pool of
+// threads. Prints one JSON line per file. Returns the exit code of the process.
+int c2_batch(const char* manifest, Options*);
+
+// Eliminates the controllable inputs of the QAIGER circuit. Returns a circuit over the uncontrollable inputs
+// that is true iff the controllable inputs can be chosen to make the output true; NULL if the solver was
+// interrupted. Writes the circuit also to the file if filename is not NULL. Changes the options.
+aiger* c2_qaiger_quantifier_elimination(aiger*, char* filename, Options*);
 
 #endif /* cadet2_h */
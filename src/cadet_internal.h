@@ -15,6 +15,9 @@
 #include "casesplits.h"
 #include "conflict_analysis.h"
 #include "int_vector.h"
+#include "mersenne_twister.h"
+
+#include <stdatomic.h>
 
 typedef enum {
     C2_READY,
@@ -41,11 +44,28 @@ struct C2_Statistics {
     Stats* minimization_stats;
     size_t cases_closed;
     size_t lvls_backtracked;
+    size_t chronological_backtracks;
+    size_t subsumed_clauses;
+    size_t strengthened_clauses;
+    size_t preprocessing_reduced_clauses;
+    size_t preprocessing_pure_literals;
+    size_t preprocessing_equivalences;
+    size_t preprocessing_eliminated_vars;
+    size_t preprocessing_resolvents;
+    double preprocessing_time;
     
     double start_time;
+    double trace_last_time_stamp; // see c2_trace_for_profiling
+    double trace_last_satsolver_seconds;
     
     Stats* failed_literals_stats;
     size_t failed_literals_conflicts;
+    size_t case_split_probes_skipped;
+    size_t probe_cache_hits;
+    size_t exported_clauses;
+    size_t imported_clauses;
+    size_t sat_calls;
+    size_t domain_rebuilds; // Skolem domain rebuilt because clauses were added after closing cases
 };
 
 struct C2_Magic_Values {
@@ -58,6 +78,11 @@ struct C2_Magic_Values {
     size_t replenish_frequency;
     unsigned num_restarts_before_Jeroslow_Wang;
     unsigned keeping_clauses_threshold;
+    unsigned chronological_backtracking_min_jump; // backjumps over at least this many levels are replaced by chronological backtracking
+    double subsumption_time_budget; // seconds per restart
+    unsigned preprocessing_rounds;
+    unsigned bve_max_occurrences; // variables with more occurrences are not eliminated
+    unsigned bve_max_resolvent_size;
     
     // Magic constants for case splits
     unsigned num_restarts_before_case_splits;
@@ -65,14 +90,39 @@ struct C2_Magic_Values {
     float notoriousity_threshold_factor; // for case splits
     float skolem_success_recent_average_initialization;
     unsigned case_split_linear_depth_penalty_factor;
+    unsigned case_split_probe_budget; // number of interface variables probed per case split
+    
+    // Magic constants for the portfolio
+    unsigned exchange_max_clause_size; // longer learnt clauses are not shared with other workers
+};
+
+// Results of case split probes for one base decision level. Results stay valid while the level's
+// facts do not change; new deterministic variables invalidate the probes that determinized them.
+// New clauses and constants on level 0 invalidate the whole cache.
+struct C2_Probe_Cache {
+    int_vector* assumptions; // universal assumptions under which the probes were made
+    int_vector* results; // indexed by 2 * var_id, +1 for negative literals; -1 if not probed
+    vector* dependents; // indexed by var_id; int_vector of result indices whose probe determinized the variable
+    unsigned determinized; // length of the determinization order at the last update
+    size_t level0_epoch; // of the Skolem domain when the cache was created
 };
+typedef struct C2_Probe_Cache C2_Probe_Cache;
 
 struct conflict_analysis;
 typedef struct conflict_analysis conflict_analysis;
 
+// Lock-free exchange of learnt clauses between portfolio workers; see c2_portfolio.c
+struct C2_Clause_Exchange;
+typedef struct C2_Clause_Exchange C2_Clause_Exchange;
+
+// Learned decision policy; see c2_policy.c
+struct Policy;
+typedef struct Policy Policy;
+
 struct C2 {
     QCNF* qcnf;
     Options* options;
+    MersenneTwister* rng;
     
     // Essential C2 data structures
     c2_state state;
@@ -83,6 +133,9 @@ struct C2 {
     size_t next_major_restart;
     unsigned restart_base_decision_lvl; // decision_lvl used for restarts
     float_vector* variable_activities; // indexed by var_id
+    int_vector* saved_phases; // indexed by var_id; last value of the variable before backtracking, 0 if unknown
+    int_vector* out_of_order_clauses; // triples of clause_idx, backjumping lvl, and the higher lvl the learnt clause was added on; see chronological backtracking
+    int_vector* reconstruction_stack; // pairs of clause_idx and witness literal of clauses removed by preprocessing, in the order of removal
     
     // Reasoning domains
     Skolem* skolem;
@@ -95,6 +148,7 @@ struct C2 {
     // Data structures for heuristics
     float activity_factor;
     float activity_factor_inverse;
+    Policy* policy; // replaces the activity heuristic for decisions; NULL if unused
     
     // Case splits
     Casesplits* cs;
@@ -103,22 +157,70 @@ struct C2 {
     float skolem_success_recent_average;
     C2_CSDP case_split_depth_penalty;
     size_t conflicts_between_case_splits_countdown;
+    vector* probe_caches; // C2_Probe_Cache* for each restart base decision level; NULL if none
     
     struct C2_Statistics statistics;
     
     struct C2_Magic_Values magic;
+    
+    // Cooperative cancellation; set by other threads, e.g. the portfolio. NULL if unused.
+    atomic_bool* terminate;
+    
+    // Clause sharing between portfolio workers. NULL if unused.
+    C2_Clause_Exchange* exchange;
+    unsigned exchange_id; // id of this worker in the exchange
+    size_t exchange_position; // position in the exchange up to which clauses were imported
+    
+    // Miniscoping; see c2_miniscoping.c
+    vector* partitions; // C2* for each independent partition the formula was solved in; NULL if not split
+    
+    // Incremental solving; see c2_incremental.c
+    int_vector* assumptions; // literals assumed for the next (or running) call of c2_sat
+    int_vector* failed_assumptions; // assumptions that the result of the last call depends on
+    int_vector* refutation_under_assumptions; // universal assignment refuting the formula under the last assumptions
+    bool result_is_conditional; // the result in state only holds under the assumptions of the last call
+    bool refuted; // false regardless of assumptions and of the last result
+    bool assumes_existentials; // existential assumptions are applied; disables CEGAR and keeping cases
+    bool solving; // inside c2_sat
+    int (*terminate_callback)(void* state); // NULL if unused
+    void* terminate_state;
+    
+    Profiler* profiler; // NULL if not profiling
+    
+    // Budgets and termination of the current call of c2_sat
+    bool terminated; // stays true until the next call once a termination was requested or a budget was exhausted
+    double solve_start_time;
+    size_t solve_start_conflicts;
 };
 
 void c2_new_variable(C2*, bool is_universal, unsigned scope_id, unsigned var_id);
 void c2_new_clause(C2*, Clause* c);
 bool c2_is_in_conflcit(C2*);
+bool c2_termination_requested(C2*);
+void c2_print_result(C2*, cadet_res);
 void c2_simplify(C2*);
+void c2_subsume_and_strengthen(C2*);
+void c2_preprocess(C2*);
+void c2_apply_formula_transformations(C2*);
+cadet_res c2_check_propositional(QCNF*, Options*);
+cadet_res c2_solve_portfolio(C2* parsed);
+C2* c2_portfolio_copy_formula(C2* parsed, Options*);
+void c2_export_clause(C2*, Clause*);
+void c2_import_clauses(C2*);
 int_vector* c2_refuting_assignment(C2*);
 
+// Incremental solving
+void c2_reopen(C2*, bool adds_clauses);
+void c2_apply_assumptions(C2*);
+void c2_close_case_under_assumptions(C2*);
+void c2_conclude_assumptions(C2*);
+void c2_rebuild_domains(C2*);
+
 // Case splits
 void c2_backtrack_casesplit(C2*);
 bool c2_casesplits_assume_single_lit(C2*); // returns if any kind of progress happened
 void c2_close_case(C2*);
+void c2_probe_caches_invalidate(C2*);
 
 // CEGAR
 /*
@@ -142,12 +244,22 @@ void c2_scale_activity(C2* c2, unsigned var_id, float factor);
 unsigned c2_get_decision_lvl(C2* c2, unsigned var_id);
 Var* c2_pick_max_activity_variable(C2* c2);
 Var* c2_pick_nondeterministic_variable(C2* c2);
-void c2_backtrack_to_decision_lvl(C2 *c2, unsigned backtracking_lvl);
+bool c2_backtrack_to_decision_lvl(C2 *c2, unsigned backtracking_lvl);
+unsigned c2_get_conflict_dlvl(C2* c2, unsigned var_id);
+bool c2_readd_out_of_order_clauses(C2* c2);
+unsigned c2_chronological_backtracking_lvl(C2* c2, Clause* learnt_clause, unsigned backjumping_lvl);
+int c2_pick_Jeroslow_Wang_phase(C2* c2, Var* decision_var);
+int c2_pick_phase(C2* c2, Var* decision_var);
 
 Clause* c2_minimize_clause(C2*,Clause*);
 
 // figuring out properties of instances:
-void c2_analysis_determine_number_of_partitions(C2* c2);
+int_vector* c2_analysis_determine_partitions(C2* c2, unsigned* number_of_partitions);
+
+// Miniscoping; see c2_miniscoping.c
+void c2_miniscoping(C2*);
+C2* c2_miniscoping_refuted_partition(C2*);
+void c2_miniscoping_free(C2*);
 
 void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size);
 
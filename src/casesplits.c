@@ -30,10 +30,13 @@ Casesplits* casesplits_init(QCNF* qcnf) {
     cs->cegar_stats.successful_minimizations = 0;
     cs->cegar_stats.additional_assignments_num = 0;
     cs->cegar_stats.successful_minimizations_by_additional_assignments = 0;
+    cs->cegar_stats.core_generalizations = 0;
+    cs->cegar_stats.core_minimizations = 0;
     cs->cegar_stats.recent_average_cube_size = 0;
     cs->cegar_magic.max_cegar_iterations_per_learnt_clause = 50;
     cs->cegar_magic.cegar_effectiveness_threshold = 17;
     cs->cegar_magic.universal_activity_decay = (float) 0.95;
+    cs->cegar_magic.core_minimization_budget = 20;
     
     // Case statistics
     cs->case_generalizations = 0;
@@ -97,7 +100,7 @@ void casesplits_update_interface(Casesplits* cs, Skolem* skolem) {
     // set up satsolver for existentials
     for (unsigned i = 0; i < vector_count(cs->skolem->qcnf->all_clauses); i++) {
         Clause* c = vector_get(cs->skolem->qcnf->all_clauses, i);
-        if (! c->original) {
+        if (! c->original || ! c->active) { // inactive clauses may have been eliminated by preprocessing
             continue;
         }
         Lit uc = skolem_get_unique_consequence(cs->skolem, c);
@@ -116,7 +119,7 @@ void casesplits_update_interface(Casesplits* cs, Skolem* skolem) {
     cs->interface_vars = int_vector_init();
     for (unsigned i = 0; i < vector_count(cs->skolem->qcnf->all_clauses); i++) {
         Clause* c = vector_get(cs->skolem->qcnf->all_clauses, i);
-        if (! c->original || c->blocked) {
+        if (! c->original || ! c->active) {
             continue;
         }
         Lit uc = skolem_get_unique_consequence(cs->skolem, c);
@@ -176,6 +179,7 @@ void casesplits_free(Casesplits* d) {
         case_free((Case*) vector_get(d->closed_cases, i));
     }
     vector_free(d->closed_cases);
+    free(d);
 }
 
 
@@ -233,7 +237,11 @@ void skolem_print_assignment(Skolem* s) {
 }
 
 void casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence) {
+    assert(!s->interrupted);
     s->record_conflicts = true;
+    // The replay encodes a closed case and must not be interrupted, as interrupted propagations leave work in the queues.
+    int (*terminate)(void*) = s->terminate;
+    s->terminate = NULL;
     skolem_propagate(s); // initial propagation
     for (unsigned i = 0; i < int_vector_count(decision_sequence); i++) {
         Lit decision_lit = int_vector_get(decision_sequence, i);
@@ -247,6 +255,7 @@ void casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence) {
     }
     V2("max satlit %d\n", satsolver_get_max_var(s->skolem));
     s->record_conflicts = false;
+    s->terminate = terminate;
 }
 
 int_vector* casesplits_test_assumptions(Casesplits* cs, int_vector* universal_assumptions) {
@@ -499,5 +508,7 @@ void casesplits_print_statistics(Casesplits* cs) {
         V0("  Successful minimizations: %u\n", cs->cegar_stats.successful_minimizations);
         V0("  Additional assignments: %u\n", cs->cegar_stats.additional_assignments_num);
         V0("  Additional assignments helped: %u\n", cs->cegar_stats.successful_minimizations_by_additional_assignments);
+        V0("  Core generalizations: %u\n", cs->cegar_stats.core_generalizations);
+        V0("  Core minimizations: %u\n", cs->cegar_stats.core_minimizations);
     }
 }
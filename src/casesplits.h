@@ -22,12 +22,15 @@ struct Cegar_Magic_Values {
     unsigned max_cegar_iterations_per_learnt_clause;
     unsigned cegar_effectiveness_threshold;
     float universal_activity_decay;
+    unsigned core_minimization_budget; // SAT calls per cube
 };
 
 struct Cegar_Statistics {
     unsigned successful_minimizations;
     unsigned additional_assignments_num;
     unsigned successful_minimizations_by_additional_assignments;
+    unsigned core_generalizations;
+    unsigned core_minimizations;
     float recent_average_cube_size;
 };
 
@@ -84,6 +87,7 @@ int_vector* casesplits_test_assumptions(Casesplits* cs, int_vector* universal_as
 
 // Interface
 void casesplits_update_interface(Casesplits*,Skolem*);
+void cegar_remember_original_satlit(Casesplits*, unsigned var_id); // on decision level 0
 float casesplits_get_interface_activity(Casesplits*, unsigned var_id);
 void casesplits_add_interface_activity(Casesplits*, unsigned var_id, float value);
 void casesplits_decay_interface_activity(Casesplits*, unsigned var_id);
@@ -18,10 +18,10 @@ bool cegar_var_needs_to_be_set(Casesplits* cs, unsigned var_id) {
     abortif(satval == 0, "CEGAR lemma variable not set in SAT solver");
     
     Var* v = var_vector_get(cs->skolem->qcnf->vars, var_id);
-    vector* occs = satval > 0 ? &v->pos_occs : &v->neg_occs;
+    occ_vector* occs = satval > 0 ? &v->pos_occs : &v->neg_occs;
     int_vector* additional_assignments_var = int_vector_init();
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         if (! c->original || c->blocked) {
             continue;
         }
@@ -66,6 +66,104 @@ bool cegar_var_needs_to_be_set(Casesplits* cs, unsigned var_id) {
     return false;
 }
 
+// Core-based cube generalization. Every clause that is not satisfied by the non-interface part of
+// the model of the exists_solver must be satisfied by the cube. We build a small SAT solver with one
+// selector per such clause, whose selector implies that the clause's interface literals are false.
+// Under the interface assignment no selector can be true, and the failed assumptions form the cube.
+// Returns NULL if some clause is not satisfied by the interface assignment at all.
+int_vector* cegar_core_generalization(C2* c2) {
+    Casesplits* cs = c2->cs;
+    int_vector* interface_lits = int_vector_init(); // indexed by var_id; 0 for non-interface variables
+    for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+        int_vector_add(interface_lits, 0);
+    }
+    for (unsigned i = 0; i < int_vector_count(cs->interface_vars); i++) {
+        unsigned var_id = (unsigned) int_vector_get(cs->interface_vars, i);
+        int_vector_set(interface_lits, var_id, satsolver_deref(cs->exists_solver, (Lit) var_id) * (Lit) var_id);
+    }
+    
+    SATSolver* dual = satsolver_init();
+    satsolver_set_max_var(dual, (int) var_vector_count(c2->qcnf->vars));
+    int_vector* selectors = int_vector_init();
+    bool covered = true;
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); Clause* c = NULL;
+    while (covered && (c = qcnf_next_clause(&ci)) != NULL) {
+        if (! c->original || c->blocked) {
+            continue;
+        }
+        bool satisfied = false;
+        unsigned interface_satisfied = 0;
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit l = c->occs[j];
+            int interface_lit = int_vector_get(interface_lits, lit_to_var(l));
+            if (interface_lit != 0) {
+                interface_satisfied += interface_lit == l ? 1 : 0;
+            } else if (satsolver_deref(cs->exists_solver, l) == 1) {
+                satisfied = true;
+                break;
+            }
+        }
+        if (satisfied) {
+            continue;
+        }
+        if (interface_satisfied == 0) {
+            covered = false;
+            break;
+        }
+        int selector = satsolver_inc_max_var(dual);
+        int_vector_add(selectors, selector);
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit l = c->occs[j];
+            if (int_vector_get(interface_lits, lit_to_var(l)) == l) {
+                satsolver_add(dual, - selector);
+                satsolver_add(dual, - l);
+                satsolver_clause_finished(dual);
+            }
+        }
+    }
+    
+    int_vector* cube = NULL;
+    if (covered) {
+        cube = int_vector_init();
+        if (int_vector_count(selectors) > 0) {
+            for (unsigned i = 0; i < int_vector_count(selectors); i++) {
+                satsolver_add(dual, int_vector_get(selectors, i));
+            }
+            satsolver_clause_finished(dual);
+            
+            for (unsigned i = 0; i < int_vector_count(cs->interface_vars); i++) {
+                unsigned var_id = (unsigned) int_vector_get(cs->interface_vars, i);
+                satsolver_assume(dual, int_vector_get(interface_lits, var_id));
+            }
+            abortif(satsolver_sat(dual) != SATSOLVER_UNSAT, "Interface assignment does not cover the clauses.");
+            satsolver_failed_assumptions(dual, cube);
+            
+            // Iterative core minimization: try to drop each literal of the core, within a budget of SAT calls.
+            unsigned budget = cs->cegar_magic.core_minimization_budget;
+            for (unsigned i = 0; i < int_vector_count(cube) && budget > 0; budget--) {
+                for (unsigned j = 0; j < int_vector_count(cube); j++) {
+                    if (j != i) {
+                        satsolver_assume(dual, int_vector_get(cube, j));
+                    }
+                }
+                if (satsolver_sat(dual) == SATSOLVER_UNSAT) {
+                    int_vector_reset(cube);
+                    satsolver_failed_assumptions(dual, cube);
+                    cs->cegar_stats.core_minimizations += 1;
+                } else {
+                    i++;
+                }
+            }
+        }
+        int_vector_sort(cube, qcnf_compare_literal_pointers_by_var_id);
+    }
+    
+    int_vector_free(selectors);
+    int_vector_free(interface_lits);
+    satsolver_free(dual);
+    return cube;
+}
+
 void cegar_one_round_for_conflicting_assignment(C2* c2) {
     assert(casesplits_is_initialized(c2->cs));
     assert(c2->state == C2_SKOLEM_CONFLICT);
@@ -95,15 +193,30 @@ void cegar_one_round_for_conflicting_assignment(C2* c2) {
     if (satsolver_sat(cs->exists_solver) == SATSOLVER_SAT) {
         int_vector_reset(cs->additional_assignment);
         
-        int_vector* cube = int_vector_init();
-        for (unsigned i = 0 ; i < int_vector_count(cs->interface_vars); i++) {
-            unsigned var_id = (unsigned) int_vector_get(cs->interface_vars, i);
-            if (cegar_var_needs_to_be_set(cs, var_id)) {
-                int val = satsolver_deref(cs->exists_solver, (Lit) var_id);
-                Lit lit = val * (Lit) var_id;
-                int_vector_add(cube, lit);
-            } else {
-                int_vector_set(cs->is_used_in_lemma, var_id, 0);
+        int_vector* cube = NULL;
+        if (c2->options->cegar_core_generalization) {
+            cube = cegar_core_generalization(c2);
+        }
+        if (cube) {
+            cs->cegar_stats.core_generalizations += 1;
+            for (unsigned i = 0 ; i < int_vector_count(cs->interface_vars); i++) {
+                unsigned var_id = (unsigned) int_vector_get(cs->interface_vars, i);
+                Lit lit = satsolver_deref(cs->exists_solver, (Lit) var_id) * (Lit) var_id;
+                if (! int_vector_contains(cube, lit)) { // the cube is sorted by var_id, not by literal
+                    int_vector_set(cs->is_used_in_lemma, var_id, 0);
+                }
+            }
+        } else {
+            cube = int_vector_init();
+            for (unsigned i = 0 ; i < int_vector_count(cs->interface_vars); i++) {
+                unsigned var_id = (unsigned) int_vector_get(cs->interface_vars, i);
+                if (cegar_var_needs_to_be_set(cs, var_id)) {
+                    int val = satsolver_deref(cs->exists_solver, (Lit) var_id);
+                    Lit lit = val * (Lit) var_id;
+                    int_vector_add(cube, lit);
+                } else {
+                    int_vector_set(cs->is_used_in_lemma, var_id, 0);
+                }
             }
         }
         
@@ -163,9 +276,11 @@ void cegar_solve_2QBF_by_cegar(C2* c2, int rounds_num) {
     assert(casesplits_is_initialized(c2->cs));
     
     // solver loop
-    while (c2->state == C2_READY && rounds_num--) {
+    while (c2->state == C2_READY && rounds_num-- && ! c2_termination_requested(c2)) {
         if (!skolem_check_if_domain_is_empty(c2->skolem)) {
+            profiler_begin(c2->profiler, PROFILER_CEGAR_ROUND);
             cegar_one_round_for_conflicting_assignment(c2);
+            profiler_end(c2->profiler, PROFILER_CEGAR_ROUND);
         } else {
             c2->state = C2_SAT;
             break; // skolem is in 'complete' state
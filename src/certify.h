@@ -12,6 +12,7 @@
 #include "qcnf.h"
 #include "options.h"
 #include "aiger.h"
+#include "aiger_utils.h"
 #include "cadet_internal.h"
 
 #include <stdio.h>
@@ -22,10 +23,11 @@ bool cert_check_UNSAT(C2*);
 void c2_print_qdimacs_output(int_vector* refuting_assignment);
 void cert_propositional_AIG_certificate_SAT(QCNF* qcnf, Options* o, void* domain, int (*get_value)(void* domain, Lit lit));
 
-bool cert_validate_skolem_function(aiger* a, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors);
-bool cert_validate_functional_synthesis(aiger* a, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors);
-bool cert_validate_quantifier_elimination(aiger* a, QCNF* qcnf, int_vector* aigerlits, unsigned projection_lit);
+bool cert_validate_skolem_function(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors, Options* o);
+bool cert_validate_functional_synthesis(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors, Options* o);
+bool cert_validate_quantifier_elimination(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, unsigned projection_lit);
 
 unsigned mapped_lit2aigerlit(int_vector* aigerlits, Lit lit);
+void cert_reconstruct_eliminated_variables(AigerBuilder* b, int_vector* aigerlits, QCNF* qcnf, int_vector* reconstruction_stack);
 
 #endif /* certificates_h */
@@ -20,6 +20,7 @@
 #define AIGERLIT_UNDEFINED INT_MAX
 #define QUANTIFIER_ELIMINATION_OUTPUT_STRING "There is an assignment to the existentials"
 
+// Binary mode unless the file name ends in .aag
 void cert_write_aiger(aiger* a, Options* o) {
     const char* filename = o->certificate_file_name;
     
@@ -28,7 +29,7 @@ void cert_write_aiger(aiger* a, Options* o) {
     
     int write_success = 0;
     if (!filename || strcmp(filename, "stdout") == 0) {
-        write_success = aiger_write_to_file(a, aiger_ascii_mode, stdout);
+        write_success = aiger_write_to_file(a, aiger_binary_mode, stdout);
     } else {
         write_success = aiger_open_and_write_to_file(a, filename);
         
@@ -37,6 +38,23 @@ void cert_write_aiger(aiger* a, Options* o) {
     V1("Wrote AIG certificate with %u gates to %s\n", a->num_ands, filename);
 }
 
+// Binary mode unless the file name ends in .aag
+static void cert_write_AIG_builder(AigerBuilder* b, Options* o) {
+    const char* filename = o->certificate_file_name;
+    bool to_stdout = !filename || strcmp(filename, "stdout") == 0;
+    bool binary = to_stdout || strcmp(get_filename_ext(filename), "aag") != 0;
+    FILE* file = to_stdout ? stdout : fopen(filename, "w");
+    abortif(!file, "Could not open file for aiger certificate (file name '%s').", filename);
+    bool write_success = aigeru_write(b, file, binary);
+    if (to_stdout) {
+        write_success = fflush(file) == 0 && write_success;
+    } else {
+        write_success = fclose(file) == 0 && write_success;
+    }
+    abortif(!write_success, "Could not write to file for aiger certificate (file name '%s').", filename);
+    V1("Wrote AIG certificate with %u gates to %s\n", aigeru_gates_num(b), filename);
+}
+
 aiger* cert_setup_AIG(QCNF* qcnf) {
     aiger* a = aiger_init();
     
@@ -104,15 +122,15 @@ Lit cert_get_unique_consequence(int_vector* ucs, Clause* c) {
 }
 
 
-void cert_encode_unique_antecedents(QCNF* qcnf, aiger* a, int_vector* aigerlits, int_vector* unique_consequences, unsigned *max_sym, Lit lit) {
+void cert_encode_unique_antecedents(QCNF* qcnf, AigerBuilder* b, int_vector* aigerlits, int_vector* unique_consequences, Lit lit) {
     assert(lit);
     unsigned var_id = lit_to_var(lit);
     
     // encode all the antecedents
     int_vector* antecedent_aigerlits = int_vector_init();
-    vector* occs = qcnf_get_occs_of_lit(qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         if (c->is_cube) {
             continue;
         }
@@ -123,14 +141,14 @@ void cert_encode_unique_antecedents(QCNF* qcnf, aiger* a, int_vector* aigerlits,
                 Lit clause_lit = c->occs[j];
                 if (clause_lit != lit) { // != unique_consequence
                     unsigned clause_aigerlit = mapped_lit2aigerlit(aigerlits, clause_lit);
-                    antecedent = aigeru_AND(a, max_sym, antecedent, negate(clause_aigerlit));
+                    antecedent = aigeru_AND(b, antecedent, negate(clause_aigerlit));
                 }
             }
             int_vector_add(antecedent_aigerlits, (int) antecedent);
         }
     }
     assert(int_vector_get(aigerlits, var_id) == AIGERLIT_UNDEFINED);  // variable should not be defined twice; using 0 as the default
-    unsigned aigerlit_for_lit = aigeru_multiOR(a, max_sym, antecedent_aigerlits);
+    unsigned aigerlit_for_lit = aigeru_multiOR(b, antecedent_aigerlits);
     V3("Lit %d assigned aigerlit %u\n", lit, aigerlit_for_lit);
     if (lit < 0) {
         aigerlit_for_lit = negate(aigerlit_for_lit);
@@ -146,21 +164,20 @@ bool cert_is_dlvl_zero_var(Skolem* skolem, unsigned var_id) {
 
 
 // Returns an aiger lit that is true iff the cube is satisfied.
-unsigned cert_encode_c2_cube(C2* c2, aiger* a, unsigned *max_sym, int_vector* aigerlits, int_vector* cube) {
+unsigned cert_encode_c2_cube(C2* c2, AigerBuilder* b, int_vector* aigerlits, int_vector* cube) {
     int_vector* cube_aigerlits = int_vector_init();
     for (unsigned i = 0; i < int_vector_count(cube); i++) {
         Lit l = int_vector_get(cube, i);
         assert(skolem_get_decision_lvl(c2->skolem, lit_to_var(l)) == 0); // Currently restricted to dlvl0 cubes
         int_vector_add(cube_aigerlits, (int) mapped_lit2aigerlit(aigerlits, l));
     }
-    unsigned outputlit = inc(max_sym);
-    aigeru_add_multiAND(a, max_sym, outputlit, cube_aigerlits);
+    unsigned outputlit = aigeru_multiAND(b, cube_aigerlits);
     int_vector_free(cube_aigerlits);
     return outputlit;
 }
 
 
-unsigned cert_encode_CEGAR(Skolem* skolem, aiger* a, unsigned *max_sym, int_vector* aigerlits, Case* c) {
+unsigned cert_encode_CEGAR(Skolem* skolem, AigerBuilder* b, int_vector* aigerlits, Case* c) {
     assert(c->type == 0);  // encodes a function
     assert(c->universal_assumptions != NULL);
     
@@ -183,12 +200,12 @@ unsigned cert_encode_CEGAR(Skolem* skolem, aiger* a, unsigned *max_sym, int_vect
     for (unsigned i = 0; i < int_vector_count(c->universal_assumptions); i++) {
         Lit assumption = int_vector_get(c->universal_assumptions, i);
         unsigned assumption_aigerlit = mapped_lit2aigerlit(aigerlits, assumption);
-        case_is_valid = aigeru_AND(a, max_sym, case_is_valid, assumption_aigerlit);
+        case_is_valid = aigeru_AND(b, case_is_valid, assumption_aigerlit);
     }
     return case_is_valid;
 }
 
-unsigned cert_encode_conflicts(Skolem* skolem, aiger* a, unsigned *max_sym, int_vector* aigerlits,
+unsigned cert_encode_conflicts(Skolem* skolem, AigerBuilder* b, int_vector* aigerlits,
                                int_vector* decisions,
                                int_vector* potentially_conflicted_variables,
                                int_vector* unique_consequences) {
@@ -211,14 +228,14 @@ unsigned cert_encode_conflicts(Skolem* skolem, aiger* a, unsigned *max_sym, int_
             int_vector_set(aigerlits, var_id, AIGERLIT_UNDEFINED);
             
             // encode other side
-            cert_encode_unique_antecedents(skolem->qcnf, a, aigerlits, unique_consequences, max_sym, polarity * (Lit) var_id);
+            cert_encode_unique_antecedents(skolem->qcnf, b, aigerlits, unique_consequences, polarity * (Lit) var_id);
             
             // encode conflict
             unsigned anti_aigerlit = (unsigned) int_vector_get(aigerlits, var_id);
-            unsigned conflict_aigerlit = aigeru_AND(a, max_sym,
+            unsigned conflict_aigerlit = aigeru_AND(b,
                                                     polarity > 0 ? negate(aigerlit) : aigerlit,
                                                     polarity > 0 ? anti_aigerlit : negate(anti_aigerlit));
-            conflict = aigeru_OR(a, max_sym, conflict, conflict_aigerlit);
+            conflict = aigeru_OR(b, conflict, conflict_aigerlit);
             
             // reset the aigerlit to original value
             int_vector_set(aigerlits, var_id, (int) aigerlit);
@@ -228,7 +245,7 @@ unsigned cert_encode_conflicts(Skolem* skolem, aiger* a, unsigned *max_sym, int_
 }
 
 // Certify all vars with dlvl>0 by writing out the unique consequences in the correct order
-void cert_encode_function_for_case(Skolem* skolem, aiger* a, unsigned *max_sym,
+void cert_encode_function_for_case(Skolem* skolem, AigerBuilder* b,
                                    int_vector* aigerlits,
                                    int_vector* decisions,
                                    int_vector* unique_consequences) {
@@ -242,19 +259,19 @@ void cert_encode_function_for_case(Skolem* skolem, aiger* a, unsigned *max_sym,
         }
         if (int_vector_get(aigerlits, var_id) == AIGERLIT_UNDEFINED) {
             assert(!qcnf_is_universal(skolem->qcnf, var_id));
-            cert_encode_unique_antecedents(skolem->qcnf, a, aigerlits, unique_consequences, max_sym, - decision_lit);
+            cert_encode_unique_antecedents(skolem->qcnf, b, aigerlits, unique_consequences, - decision_lit);
         }
     }
 }
 
 
-unsigned cert_dlvl0_definitions(aiger* a, int_vector* aigerlits, Skolem* skolem, unsigned* max_sym) {
+unsigned cert_dlvl0_definitions(AigerBuilder* b, int_vector* aigerlits, Skolem* skolem) {
     int_vector* decision_sequence = case_splits_determinization_order_with_polarities(skolem);
-    cert_encode_function_for_case(skolem, a, max_sym, aigerlits, decision_sequence,
+    cert_encode_function_for_case(skolem, b, aigerlits, decision_sequence,
                                   skolem->unique_consequence);
     
     if (skolem->options->quantifier_elimination) {
-        unsigned res = cert_encode_conflicts(skolem, a, max_sym, aigerlits, decision_sequence,
+        unsigned res = cert_encode_conflicts(skolem, b, aigerlits, decision_sequence,
                                              skolem->potentially_conflicted_variables,
                                              skolem->unique_consequence);
         int_vector_free(decision_sequence);
@@ -265,66 +282,66 @@ unsigned cert_dlvl0_definitions(aiger* a, int_vector* aigerlits, Skolem* skolem,
 }
 
 
-static void cert_define_aiger_outputs(Skolem* skolem, aiger* a, int_vector* aigerlits) {
-    for (unsigned i = 0; i < var_vector_count(skolem->qcnf->vars); i++) {
-        if (qcnf_var_exists(skolem->qcnf, i)
-            && qcnf_is_original(skolem->qcnf, i)
-            && qcnf_is_existential(skolem->qcnf, i)) {
+static void cert_define_aiger_outputs(QCNF* qcnf, Options* o, AigerBuilder* b, int_vector* aigerlits) {
+    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+        if (qcnf_var_exists(qcnf, i)
+            && qcnf_is_original(qcnf, i)
+            && qcnf_is_existential(qcnf, i)) {
             
             char* output_name = NULL;
             unsigned name_size = 2; // for \0, one reserve
-            if (skolem->options->certificate_type == QAIGER) {
-                char* var_name = qcnf_get_variable_name(skolem->qcnf, i);
+            if (o->certificate_type == QAIGER) {
+                char* var_name = qcnf_get_variable_name(qcnf, i);
                 if (var_name) {
                     name_size += strlen(var_name);
                     output_name = malloc(sizeof(char) * (size_t) name_size);
                     sprintf(output_name, "%s", var_name);
                     unsigned al = (unsigned) int_vector_get(aigerlits, i);
-                    aiger_add_output(a, al, output_name);
+                    aigeru_add_output(b, al, output_name);
                     free(output_name);
                 }
             } else {
-                name_size += discrete_logarithm(var_vector_count(skolem->qcnf->vars));
+                name_size += discrete_logarithm(var_vector_count(qcnf->vars));
                 output_name = malloc(sizeof(char) * (size_t) name_size);
                 sprintf(output_name, "%u", i);
                 unsigned al = (unsigned) int_vector_get(aigerlits, i);
-                aiger_add_output(a, al, output_name);
+                aigeru_add_output(b, al, output_name);
                 free(output_name);
             }
         }
     }
     
     // From the CAQECERT readme: "There is one additional output which must be the last output and it indicates whether the certificate is a Skolem or Herbrand certificate (value 1 and 0, respectively)."
-    if (skolem->options->certificate_type == CAQECERT) {
-        aiger_add_output(a, 1, "result");
+    if (o->certificate_type == CAQECERT) {
+        aigeru_add_output(b, aiger_true, "result");
     }
 }
 
 
-static void cert_define_aiger_inputs(aiger *a, int_vector *aigerlits, Skolem* skolem) {
-    for (unsigned i = 0; i < var_vector_count(skolem->qcnf->vars); i++) {
-        if (qcnf_var_exists(skolem->qcnf, i)
-            && qcnf_is_original(skolem->qcnf, i)
-            && qcnf_is_universal(skolem->qcnf, i)) {
+static void cert_define_aiger_inputs(QCNF* qcnf, Options* o, AigerBuilder* b, int_vector *aigerlits) {
+    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+        if (qcnf_var_exists(qcnf, i)
+            && qcnf_is_original(qcnf, i)
+            && qcnf_is_universal(qcnf, i)) {
             
             unsigned al = var2aigerlit(i);
             int_vector_set(aigerlits, i, (int) al);
             char* input_name = NULL;
             unsigned name_size = 2; // for \0, one reserve
-            if (skolem->options->certificate_type == QAIGER) {
-                char* var_name = qcnf_get_variable_name(skolem->qcnf, i);
+            if (o->certificate_type == QAIGER) {
+                char* var_name = qcnf_get_variable_name(qcnf, i);
                 if (var_name) {
                     name_size += strlen(var_name);
                     input_name = malloc(sizeof(char) * (size_t) name_size);
                     sprintf(input_name, "%s", var_name);
-                    aiger_add_input(a, al, input_name);
+                    aigeru_add_input(b, al, input_name);
                     free(input_name);
                 }
             } else {
-                name_size += discrete_logarithm(var_vector_count(skolem->qcnf->vars));
+                name_size += discrete_logarithm(var_vector_count(qcnf->vars));
                 input_name = malloc(sizeof(char) * (size_t) name_size);
                 sprintf(input_name, "%u", i);
-                aiger_add_input(a, al, input_name);
+                aigeru_add_input(b, al, input_name);
                 free(input_name);
             }
         }
@@ -332,53 +349,28 @@ static void cert_define_aiger_inputs(aiger *a, int_vector *aigerlits, Skolem* sk
 }
 
 
-// Assumes c2 to be in SAT state and that dlvl 0 is fully propagated; and that dlvl is not propagated depending on restrictions to universals (i.e. after completed case_splits)
-void c2_write_AIG_certificate(C2* c2) {
-    abortif(c2->state != C2_SAT, "Can only generate certificate in SAT state.");
-    abortif(int_vector_count(c2->skolem->universals_assumptions) > 0, "Current state of C2 must not depend on universal assumptions");
-    
-    Skolem* skolem_dlvl0 = skolem_init(c2->qcnf, c2->options);
-    skolem_dlvl0->record_conflicts = true;
-    skolem_propagate(skolem_dlvl0);
-    
-    aiger* a = aiger_init();
-    
-    // map from var_id to the current aiger_lit representing it
-    int_vector* aigerlits = int_vector_init();
-    for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {int_vector_add(aigerlits, AIGERLIT_UNDEFINED);}
-    
-    cert_define_aiger_inputs(a, aigerlits, skolem_dlvl0);
-    
-    if (skolem_is_conflicted(skolem_dlvl0)) { // constants conflicts on dlvl0 in functional synthesis mode ...
-        assert(c2->options->functional_synthesis);
-        assert(skolem_dlvl0->state == SKOLEM_STATE_CONSTANTS_CONLICT);
-        if (c2->options->quantifier_elimination) {
-            aiger_add_output(a, aiger_false, QUANTIFIER_ELIMINATION_OUTPUT_STRING);
-        } else {
-            for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {
-                if (qcnf_var_exists(c2->qcnf, i)
-                    && qcnf_is_original(c2->qcnf, i)
-                    && qcnf_is_existential(c2->qcnf, i)) {
-                    
-                    int_vector_set(aigerlits, i, aiger_false);
-                }
+// Extends the functions to the variables eliminated by preprocessing. Processes the removed clauses
+// in reverse order and flips the witness literal whenever the clause would be falsified otherwise.
+void cert_reconstruct_eliminated_variables(AigerBuilder* b, int_vector* aigerlits, QCNF* qcnf, int_vector* reconstruction_stack) {
+    assert(int_vector_count(reconstruction_stack) % 2 == 0);
+    for (unsigned i = int_vector_count(reconstruction_stack); i > 0; i -= 2) {
+        Clause* c = vector_get(qcnf->all_clauses, (unsigned) int_vector_get(reconstruction_stack, i - 2));
+        Lit witness = int_vector_get(reconstruction_stack, i - 1);
+        assert(qcnf_contains_literal(c, witness));
+        unsigned falsified = aiger_true;
+        for (unsigned j = 0; j < c->size; j++) {
+            if (c->occs[j] != witness) {
+                falsified = aigeru_AND(b, falsified, negate(mapped_lit2aigerlit(aigerlits, c->occs[j])));
             }
-            cert_define_aiger_outputs(skolem_dlvl0, a, aigerlits);
         }
-        cert_write_aiger(a, c2->options);
-        
-        int_vector_free(aigerlits);
-        skolem_free(skolem_dlvl0);
-        aiger_reset(a);
-        return;
+        unsigned witness_aigerlit = aigeru_OR(b, mapped_lit2aigerlit(aigerlits, witness), falsified);
+        int_vector_set(aigerlits, lit_to_var(witness), (int) (witness > 0 ? witness_aigerlit : negate(witness_aigerlit)));
     }
-    
-    unsigned max_sym = var2aigerlit(a->maxvar);
-    assert(c2->options->certificate_type != QBFCERT || max_sym == var2aigerlit(a->maxvar + 1));
-    
-    // Certificate for the dlvl0 variables
-    unsigned dlvl0_conflict_aigerlit = cert_dlvl0_definitions(a, aigerlits, skolem_dlvl0, &max_sym);
-    
+}
+
+// Encodes the function of every closed case on top of the dlvl0 definitions in aigerlits and adds the literals
+// indicating which case applies to case_selectors. Returns for every variable the aigerlits of the cases.
+static vector* cert_encode_cases(C2* c2, Skolem* skolem_dlvl0, AigerBuilder* b, int_vector* aigerlits, int_vector* case_selectors) {
     // The following data structures remember all the aigerlits for all cases; dlvl0 vars are only remembered once
     vector* case_aigerlits = vector_init(); // stores for every variable an int_vector of aigerlits for the different cases
     for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {
@@ -390,7 +382,6 @@ void c2_write_AIG_certificate(C2* c2) {
             int_vector_add(var_aigerlits, (int) curlit);
         }
     }
-    int_vector* case_selectors = int_vector_init(); // aiger literals that indicate which cases apply
     
     // For every case, encode the function in a new set of symbols and connnect to the existing symbols with a MUX
     assert(vector_count(c2->cs->closed_cases) > 0);
@@ -398,11 +389,11 @@ void c2_write_AIG_certificate(C2* c2) {
         unsigned case_applies = AIGERLIT_UNDEFINED;
         Case* c = vector_get(c2->cs->closed_cases, case_idx);
         if (c->type == 0) {  // CEGAR assignment
-            case_applies = cert_encode_CEGAR(skolem_dlvl0, a, &max_sym, aigerlits, c);
+            case_applies = cert_encode_CEGAR(skolem_dlvl0, b, aigerlits, c);
         } else {  // certificate is an actual function, closed case split
-            cert_encode_function_for_case(skolem_dlvl0, a, &max_sym, aigerlits,
+            cert_encode_function_for_case(skolem_dlvl0, b, aigerlits,
                                           c->determinization_order, c->unique_consequences);
-            case_applies = negate(cert_encode_conflicts(skolem_dlvl0, a, &max_sym, aigerlits,
+            case_applies = negate(cert_encode_conflicts(skolem_dlvl0, b, aigerlits,
                                                         c->determinization_order,
                                                         c->potentially_conflicted_variables,
                                                         c->unique_consequences));
@@ -435,86 +426,252 @@ void c2_write_AIG_certificate(C2* c2) {
             }
         }
     }
+    return case_aigerlits;
+}
+
+// Combines the functions of the cases with multiplexers over the case selectors. Returns the aigerlits of the Skolem functions.
+static int_vector* cert_combine_cases(C2* c2, Skolem* skolem_dlvl0, AigerBuilder* b, int_vector* aigerlits, vector* case_aigerlits, int_vector* case_selectors) {
+    int_vector* out_aigerlits = int_vector_copy(aigerlits);
+    for (unsigned var_id = 0; var_id < vector_count(case_aigerlits); var_id++) {
+        if (! qcnf_var_exists(c2->qcnf, var_id) || cert_is_dlvl_zero_var(skolem_dlvl0, var_id)) {
+            continue;
+        }
+        int_vector* aigerlits_for_var = vector_get(case_aigerlits, var_id);
+        unsigned num = int_vector_count(aigerlits_for_var);
+        assert(num == 1 || num == int_vector_count(case_selectors));
+        unsigned outlit_for_var = AIGERLIT_UNDEFINED;
+        if (num == 1) {
+            outlit_for_var = (unsigned) int_vector_get(aigerlits_for_var, 0);
+        } else {
+            outlit_for_var = aigeru_multiMUX(b, case_selectors, aigerlits_for_var);
+        }
+        int_vector_set(out_aigerlits, var_id, (int) outlit_for_var);
+        int_vector_free(aigerlits_for_var);
+        vector_set(case_aigerlits, var_id, NULL);
+    }
+    return out_aigerlits;
+}
+
+// Certificate for a formula that miniscoping split into partitions. The functions of all partitions are encoded on
+// the same inputs; the partitions agree on the shared variables, so these are taken from the first partition.
+static void c2_write_miniscoped_AIG_certificate(C2* c2) {
+    AigerBuilder* b = aigeru_builder_init(var2aigerlit(var_vector_count(c2->qcnf->vars) - 1));
+    int_vector* aigerlits = int_vector_init();
+    for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {int_vector_add(aigerlits, AIGERLIT_UNDEFINED);}
+    cert_define_aiger_inputs(c2->qcnf, c2->options, b, aigerlits);
+    int_vector* out_aigerlits = int_vector_copy(aigerlits);
+    int_vector* partition_selectors = int_vector_init(); // for each partition, whether some of its cases applies
     
-    bool valid = false;
-    if (c2->options->quantifier_elimination) {
-        // This is the quantifier elimination certificate.
-        // There are three ways the resulting formula can evaluate to false:
+    for (unsigned p = 0; p < vector_count(c2->partitions); p++) {
+        C2* partition = vector_get(c2->partitions, p);
+        abortif(partition->state != C2_SAT, "Can only generate certificate if all partitions are SAT.");
+        Skolem* skolem_dlvl0 = skolem_init(partition->qcnf, partition->options);
+        skolem_dlvl0->record_conflicts = true;
+        skolem_propagate(skolem_dlvl0);
+        abortif(skolem_is_conflicted(skolem_dlvl0), "Partition %u is conflicted on dlvl0.", p);
         
-        // (1) Conflict in dlvl0 variables
-        // -- nothing to be done
-        
-        // (2) None of the cases applies
-        unsigned some_case_applies = aiger_false;
-        for (unsigned i = 0; i < int_vector_count(case_selectors); i++) {
-            unsigned sel = (unsigned) int_vector_get(case_selectors, i);
-            some_case_applies = aigeru_OR(a, &max_sym, some_case_applies, sel);
+        int_vector* partition_aigerlits = int_vector_init();
+        for (unsigned i = 0 ; i < var_vector_count(partition->qcnf->vars); i++) {
+            bool is_input = qcnf_var_exists(partition->qcnf, i) && qcnf_is_universal(partition->qcnf, i);
+            int_vector_add(partition_aigerlits, is_input ? int_vector_get(aigerlits, i) : AIGERLIT_UNDEFINED);
         }
+        cert_dlvl0_definitions(b, partition_aigerlits, skolem_dlvl0);
+        int_vector* case_selectors = int_vector_init();
+        vector* case_aigerlits = cert_encode_cases(partition, skolem_dlvl0, b, partition_aigerlits, case_selectors);
+        int_vector* partition_out_aigerlits = cert_combine_cases(partition, skolem_dlvl0, b, partition_aigerlits, case_aigerlits, case_selectors);
         
-        // (3) One of the clauses with only universal variables applies
-        unsigned some_universal_violated = aiger_false;
-        for (unsigned i = 0; i < int_vector_count(c2->qcnf->universal_clauses); i++) {
-            unsigned universal_clause_idx = (unsigned) int_vector_get(c2->qcnf->universal_clauses, i);
-            Clause* c = vector_get(c2->qcnf->all_clauses, universal_clause_idx);
-            assert(c->universal_clause);
-            unsigned clause_satisfied = aiger_false;
-            for (unsigned j = 0; j < c->size; j++) {
-                Lit l = c->occs[j];
-                assert(qcnf_is_universal(c2->qcnf, lit_to_var(l)));
-                unsigned al = mapped_lit2aigerlit(aigerlits, l); // universals have unique aigerlits throughout all cases
-                clause_satisfied = aigeru_OR(a, &max_sym, clause_satisfied, al);
+        for (unsigned var_id = 0; var_id < int_vector_count(partition_out_aigerlits); var_id++) {
+            if (qcnf_var_exists(partition->qcnf, var_id)
+                && qcnf_is_existential(partition->qcnf, var_id)
+                && int_vector_get(out_aigerlits, var_id) == AIGERLIT_UNDEFINED) {
+                int_vector_set(out_aigerlits, var_id, int_vector_get(partition_out_aigerlits, var_id));
             }
-            some_universal_violated = aigeru_OR(a, &max_sym, some_universal_violated, negate(clause_satisfied));
         }
+        int_vector_add(partition_selectors, (int) aigeru_multiOR(b, case_selectors));
         
-        unsigned projection = aigeru_AND(a, &max_sym, some_case_applies, negate(some_universal_violated));
-        projection = aigeru_AND(a, &max_sym, projection, negate(dlvl0_conflict_aigerlit));
-        aiger_add_output(a, projection, QUANTIFIER_ELIMINATION_OUTPUT_STRING);
-        
-        if (c2->options->verify) {
-            valid = cert_validate_quantifier_elimination(a, c2->qcnf, aigerlits, projection);
-        } else {
-            valid = true;
+        int_vector_free(partition_out_aigerlits);
+        vector_free(case_aigerlits);
+        int_vector_free(case_selectors);
+        int_vector_free(partition_aigerlits);
+        skolem_free(skolem_dlvl0);
+    }
+    int_vector* case_selectors = int_vector_init();
+    int_vector_add(case_selectors, (int) aigeru_multiAND(b, partition_selectors));
+    
+    cert_reconstruct_eliminated_variables(b, out_aigerlits, c2->qcnf, c2->reconstruction_stack);
+    cert_define_aiger_outputs(c2->qcnf, c2->options, b, out_aigerlits);
+    
+    bool valid = ! c2->options->verify || cert_validate_skolem_function(b, c2->qcnf, out_aigerlits, case_selectors, c2->options);
+    aigeru_builder_print_statistics(b);
+    cert_write_AIG_builder(b, c2->options);
+    
+    abortif(!valid, "Validation of certificate invalid!");
+    
+    int_vector_free(case_selectors);
+    int_vector_free(partition_selectors);
+    int_vector_free(out_aigerlits);
+    int_vector_free(aigerlits);
+    aigeru_builder_free(b);
+}
+
+// Encodes the projection of the formula to the universals, i.e. whether there is an assignment to the existentials,
+// from the closed cases of quantifier elimination mode. aigerlits must hold the definitions of the dlvl0 variables.
+static unsigned cert_encode_projection(C2* c2, AigerBuilder* b, int_vector* aigerlits, int_vector* case_selectors, unsigned dlvl0_conflict_aigerlit) {
+    // There are three ways the resulting formula can evaluate to false:
+    
+    // (1) Conflict in dlvl0 variables
+    // -- nothing to be done
+    
+    // (2) None of the cases applies
+    unsigned some_case_applies = aiger_false;
+    for (unsigned i = 0; i < int_vector_count(case_selectors); i++) {
+        unsigned sel = (unsigned) int_vector_get(case_selectors, i);
+        some_case_applies = aigeru_OR(b, some_case_applies, sel);
+    }
+    
+    // (3) One of the clauses with only universal variables applies
+    unsigned some_universal_violated = aiger_false;
+    for (unsigned i = 0; i < int_vector_count(c2->qcnf->universal_clauses); i++) {
+        unsigned universal_clause_idx = (unsigned) int_vector_get(c2->qcnf->universal_clauses, i);
+        Clause* c = vector_get(c2->qcnf->all_clauses, universal_clause_idx);
+        assert(c->universal_clause);
+        unsigned clause_satisfied = aiger_false;
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit l = c->occs[j];
+            assert(qcnf_is_universal(c2->qcnf, lit_to_var(l)));
+            unsigned al = mapped_lit2aigerlit(aigerlits, l); // universals have unique aigerlits throughout all cases
+            clause_satisfied = aigeru_OR(b, clause_satisfied, al);
         }
-    } else { // Create function
-        int_vector* out_aigerlits = int_vector_copy(aigerlits);
-        for (unsigned var_id = 0; var_id < vector_count(case_aigerlits); var_id++) {
-            if (! qcnf_var_exists(c2->qcnf, var_id) || cert_is_dlvl_zero_var(skolem_dlvl0, var_id)) {
-                continue;
-            }
-            int_vector* aigerlits_for_var = vector_get(case_aigerlits, var_id);
-            unsigned num = int_vector_count(aigerlits_for_var);
-            assert(num == 1 || num == int_vector_count(case_selectors));
-            unsigned outlit_for_var = AIGERLIT_UNDEFINED;
-            if (num == 1) {
-                outlit_for_var = (unsigned) int_vector_get(aigerlits_for_var, 0);
-            } else {
-                outlit_for_var = aigeru_multiMUX(a, &max_sym, case_selectors, aigerlits_for_var);
+        some_universal_violated = aigeru_OR(b, some_universal_violated, negate(clause_satisfied));
+    }
+    
+    unsigned projection = aigeru_AND(b, some_case_applies, negate(some_universal_violated));
+    return aigeru_AND(b, projection, negate(dlvl0_conflict_aigerlit));
+}
+
+// Builds the certificate (Skolem functions, or the projection in quantifier elimination mode) and validates it if
+// requested. Assumes c2 to be in SAT state and that dlvl 0 is fully propagated; and that dlvl is not propagated
+// depending on restrictions to universals (i.e. after completed case_splits)
+static AigerBuilder* cert_build_AIG_certificate(C2* c2, bool* valid) {
+    Skolem* skolem_dlvl0 = skolem_init(c2->qcnf, c2->options);
+    skolem_dlvl0->record_conflicts = true;
+    skolem_propagate(skolem_dlvl0);
+    
+    // Variables of the formula keep their numbers; gates are numbered after them
+    AigerBuilder* b = aigeru_builder_init(var2aigerlit(var_vector_count(c2->qcnf->vars) - 1));
+    
+    // map from var_id to the current aiger_lit representing it
+    int_vector* aigerlits = int_vector_init();
+    for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {int_vector_add(aigerlits, AIGERLIT_UNDEFINED);}
+    
+    cert_define_aiger_inputs(c2->qcnf, c2->options, b, aigerlits);
+    
+    if (skolem_is_conflicted(skolem_dlvl0)) { // constants conflicts on dlvl0 in functional synthesis mode ...
+        assert(c2->options->functional_synthesis);
+        assert(skolem_dlvl0->state == SKOLEM_STATE_CONSTANTS_CONLICT);
+        if (c2->options->quantifier_elimination) {
+            aigeru_add_output(b, aiger_false, QUANTIFIER_ELIMINATION_OUTPUT_STRING);
+        } else {
+            for (unsigned i = 0 ; i < var_vector_count(c2->qcnf->vars); i++) {
+                if (qcnf_var_exists(c2->qcnf, i)
+                    && qcnf_is_original(c2->qcnf, i)
+                    && qcnf_is_existential(c2->qcnf, i)) {
+                    
+                    int_vector_set(aigerlits, i, aiger_false);
+                }
             }
-            int_vector_set(out_aigerlits, var_id, (int) outlit_for_var);
-            int_vector_free(aigerlits_for_var);
-            vector_set(case_aigerlits, var_id, NULL);
+            cert_define_aiger_outputs(c2->qcnf, c2->options, b, aigerlits);
         }
-        
-        cert_define_aiger_outputs(skolem_dlvl0, a, out_aigerlits);
+        *valid = true;
+        int_vector_free(aigerlits);
+        skolem_free(skolem_dlvl0);
+        return b;
+    }
+    
+    // Certificate for the dlvl0 variables
+    unsigned dlvl0_conflict_aigerlit = cert_dlvl0_definitions(b, aigerlits, skolem_dlvl0);
+    
+    int_vector* case_selectors = int_vector_init(); // aiger literals that indicate which cases apply
+    vector* case_aigerlits = cert_encode_cases(c2, skolem_dlvl0, b, aigerlits, case_selectors);
+    
+    if (c2->options->quantifier_elimination) {
+        unsigned projection = cert_encode_projection(c2, b, aigerlits, case_selectors, dlvl0_conflict_aigerlit);
+        aigeru_add_output(b, projection, QUANTIFIER_ELIMINATION_OUTPUT_STRING);
+        *valid = ! c2->options->verify || cert_validate_quantifier_elimination(b, c2->qcnf, aigerlits, projection);
+    } else { // Create function
+        int_vector* out_aigerlits = cert_combine_cases(c2, skolem_dlvl0, b, aigerlits, case_aigerlits, case_selectors);
+        cert_reconstruct_eliminated_variables(b, out_aigerlits, c2->qcnf, c2->reconstruction_stack);
+        cert_define_aiger_outputs(c2->qcnf, c2->options, b, out_aigerlits);
         
         if (!c2->options->verify) {
-            valid = true;
+            *valid = true;
         } else if (!c2->options->functional_synthesis) {
-            valid = cert_validate_skolem_function(a, c2->qcnf, out_aigerlits, case_selectors);
+            *valid = cert_validate_skolem_function(b, c2->qcnf, out_aigerlits, case_selectors, c2->options);
         } else {
-            valid = cert_validate_functional_synthesis(a, c2->qcnf, out_aigerlits, case_selectors);
+            *valid = cert_validate_functional_synthesis(b, c2->qcnf, out_aigerlits, case_selectors, c2->options);
         }
         
         int_vector_free(out_aigerlits);
     }
-    cert_write_aiger(a, c2->options);
-    
-    abortif(!valid, "Validation of certificate invalid!");
     
     int_vector_free(aigerlits);
     vector_free(case_aigerlits);
     int_vector_free(case_selectors);
     skolem_free(skolem_dlvl0);
-    aiger_reset(a);
+    return b;
+}
+
+void c2_write_AIG_certificate(C2* c2) {
+    abortif(c2->state != C2_SAT, "Can only generate certificate in SAT state.");
+    abortif(int_vector_count(c2->skolem->universals_assumptions) > 0, "Current state of C2 must not depend on universal assumptions");
+    if (c2->partitions) {
+        c2_write_miniscoped_AIG_certificate(c2);
+        return;
+    }
+    
+    bool valid = false;
+    AigerBuilder* b = cert_build_AIG_certificate(c2, &valid);
+    aigeru_builder_print_statistics(b);
+    cert_write_AIG_builder(b, c2->options);
+    
+    abortif(!valid, "Validation of certificate invalid!");
+    
+    aigeru_builder_free(b);
+}
+
+// Quantifier elimination for QAIGER: the circuit computes the projection of the formula to the uncontrollable
+// inputs. The closed cases and CEGAR cubes of a single run in functional synthesis mode cover all assignments
+// to the uncontrollable inputs; the projection is the disjunction of those cases in which the formula holds.
+aiger* c2_qaiger_quantifier_elimination(aiger* aig, char* filename, Options* o) {
+    bool owns_options = o == NULL;
+    if (owns_options) {o = default_options();}
+    o->quantifier_elimination = true;
+    o->functional_synthesis = true;
+    o->certify_SAT = true;
+    o->certificate_type = QAIGER;
+    o->certificate_file_name = filename;
+    
+    C2* c2 = c2_from_qaiger(aig, o);
+    c2_apply_formula_transformations(c2);
+    cadet_res res = c2_sat(c2);
+    if (res == CADET_RESULT_UNKNOWN) {
+        c2_free(c2);
+        if (owns_options) {options_free(o);}
+        return NULL;
+    }
+    abortif(res != CADET_RESULT_SAT, "Should not reach UNSAT result in functional synthesis mode.");
+    
+    bool valid = false;
+    AigerBuilder* b = cert_build_AIG_certificate(c2, &valid);
+    abortif(!valid, "Validation of quantifier elimination invalid!");
+    aigeru_builder_print_statistics(b);
+    if (filename) {
+        cert_write_AIG_builder(b, o);
+    }
+    aiger* projection = aigeru_builder_to_aiger(b);
+    
+    aigeru_builder_free(b);
+    c2_free(c2);
+    if (owns_options) {options_free(o);}
+    return projection;
 }
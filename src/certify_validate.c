@@ -5,161 +5,105 @@
 //  Created by Markus Rabe on 07.04.18.
 //  Copyright © 2018 UC Berkeley. All rights reserved.
 //
+//  Validation of certificates in debug builds. Skolem functions are first
+//  simulated on random assignments to the universals, 64 per machine word,
+//  which finds most counterexamples without a SAT solver. The SAT checks are
+//  split into queries over groups of clauses that run in parallel threads;
+//  each query encodes the certificate into a SAT solver of its own.
+//
 
 #include "certify.h"
 #include "aiger.h"
 #include "aiger_utils.h"
 #include "log.h"
 #include "satsolver.h"
+#include "mersenne_twister.h"
 #include "util.h"
 
-void cert_validate_print_assignment(aiger* a, QCNF* qcnf, SATSolver* checker, int_vector* aigerlits, Lit truelit) {
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CERT_VALIDATE_SIMULATION_ROUNDS 32 // 64 random assignments per round
+
+typedef struct {
+    AigerBuilder* b;
+    QCNF* qcnf;
+    int_vector* aigerlits;
+    int_vector* case_selectors; // check that some case applies; NULL if not
+    int_vector* clauses; // check that none of these clauses is violated; NULL if not
+    bool encode_formula; // restrict to universals for which the formula has a solution
+    unsigned projection_lit; // check that the projection is true; AIGERLIT_NONE if not
+    Log_Settings log_settings; // log settings are thread local
+    sat_res result;
+    int_vector* counterexample; // assignment to the universals if the result is SAT
+    pthread_t thread;
+} Validation_Query;
+
+#define AIGERLIT_NONE UINT32_MAX
+
+static void cert_validate_print_assignment(int_vector* counterexample) {
     V0("Violating assignment to universals:");
-    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
-        if (qcnf_var_exists(qcnf, i) && qcnf_is_universal(qcnf, i)) {
-            unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
-            int val = satsolver_deref(checker, aiger_lit2lit(al, truelit));
-            V0(" %d", val * (int) i);
-        }
+    for (unsigned i = 0; i < int_vector_count(counterexample); i++) {
+        V0(" %d", int_vector_get(counterexample, i));
     }
     V0("\n");
-    
-//    V0("Violating assignment to existentials:");
-//    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
-//        if (qcnf_var_exists(qcnf, i) && qcnf_is_existential(qcnf, i)) {
-//            unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
-//            int val = satsolver_deref(checker, aiger_lit2lit(al, truelit));
-//            V0(" %d", val * (int) i);
-//        }
-//    }
-//    V0("\n");
 }
 
-void cert_validate_encode_aiger(aiger* a, SATSolver* checker, int truelit) {
-    for (unsigned i = 0; i < a->num_ands; i++) {
-        aiger_and and = a->ands[i];
-        
-        satsolver_add(checker,   aiger_lit2lit(and.rhs0, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.lhs, truelit));
+void cert_validate_encode_aiger(AigerBuilder* b, SATSolver* checker, int truelit) {
+    for (unsigned i = 0; i < aigeru_gates_num(b); i++) {
+        unsigned lhs, rhs0, rhs1;
+        aigeru_get_gate(b, i, &lhs, &rhs0, &rhs1);
+
+        satsolver_add(checker,   aiger_lit2lit(rhs0, truelit));
+        satsolver_add(checker, - aiger_lit2lit(lhs, truelit));
         satsolver_clause_finished(checker);
-        
-        satsolver_add(checker,   aiger_lit2lit(and.rhs1, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.lhs, truelit));
+
+        satsolver_add(checker,   aiger_lit2lit(rhs1, truelit));
+        satsolver_add(checker, - aiger_lit2lit(lhs, truelit));
         satsolver_clause_finished(checker);
-        
-        satsolver_add(checker, - aiger_lit2lit(and.rhs0, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.rhs1, truelit));
-        satsolver_add(checker,   aiger_lit2lit(and.lhs, truelit));
+
+        satsolver_add(checker, - aiger_lit2lit(rhs0, truelit));
+        satsolver_add(checker, - aiger_lit2lit(rhs1, truelit));
+        satsolver_add(checker,   aiger_lit2lit(lhs, truelit));
         satsolver_clause_finished(checker);
     }
     assert(satsolver_sat(checker) == SATSOLVER_SAT);
 }
 
 
-Lit cert_validate_encode_violation_of_some_clause(aiger* a, QCNF* qcnf, int_vector* aigerlits, SATSolver* checker, int truelit) {
+Lit cert_validate_encode_violation_of_some_clause(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* clauses, SATSolver* checker, int truelit) {
     // Encode big disjunction over the violation of the clauses
     Lit some_clause_violated = - truelit;
-    for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
-        Clause* c = vector_get(qcnf->all_clauses, i);
-        if (qcnf_is_original_clause(qcnf, c->clause_idx)) {
-            Lit this_clause_violated = satsolver_inc_max_var(checker);
-            for (unsigned j = 0; j < c->size; j++) {
-                Lit lit = c->occs[j];
-                unsigned var_id = lit_to_var(lit);
-                unsigned al = mapped_lit2aigerlit(aigerlits, - lit);
-                assert(! qcnf_is_universal(qcnf, var_id) || aiger_is_input(a, aiger_strip(al)));
-                satsolver_add(checker, aiger_lit2lit(al, truelit));
-                satsolver_add(checker, - this_clause_violated);
-                satsolver_clause_finished(checker);
-            }
-            
-            Lit next_some_clause_violated = satsolver_inc_max_var(checker);
-            satsolver_add(checker, some_clause_violated);
-            satsolver_add(checker, this_clause_violated);
-            satsolver_add(checker, - next_some_clause_violated);
+    for (unsigned i = 0; i < int_vector_count(clauses); i++) {
+        Clause* c = vector_get(qcnf->all_clauses, (unsigned) int_vector_get(clauses, i));
+        Lit this_clause_violated = satsolver_inc_max_var(checker);
+        for (unsigned j = 0; j < c->size; j++) {
+            Lit lit = c->occs[j];
+            unsigned var_id = lit_to_var(lit);
+            unsigned al = mapped_lit2aigerlit(aigerlits, - lit);
+            assert(! qcnf_is_universal(qcnf, var_id) || aigeru_is_input(b, al));
+            satsolver_add(checker, aiger_lit2lit(al, truelit));
+            satsolver_add(checker, - this_clause_violated);
             satsolver_clause_finished(checker);
-            
-            some_clause_violated = next_some_clause_violated;
         }
-    }
-    assert(satsolver_sat(checker) == SATSOLVER_SAT);
-    return some_clause_violated;
-}
-
 
-bool cert_validate_skolem_function(aiger* a, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors) {
-#ifndef DEBUG
-    return true;
-#endif
-    V1("Validating Skolem function with %u gates.\n", a->num_ands);
-    Stats* timer = statistics_init(1000);  // 1 ms resolution
-    statistics_start_timer(timer);
-    bool ret = true;
-    
-    SATSolver* checker = satsolver_init();
-    satsolver_set_max_var(checker, (int) a->maxvar);
-    
-    int truelit = satsolver_inc_max_var(checker);
-    satsolver_add(checker, truelit);
-    satsolver_clause_finished(checker);
-    
-    cert_validate_encode_aiger(a, checker, truelit);
-    
-    satsolver_push(checker);
-    for (unsigned i = 0; i < int_vector_count(case_selectors); i++) {
-        unsigned sel = (unsigned) int_vector_get(case_selectors, i);
-        satsolver_add(checker, - aiger_lit2lit(sel, truelit));
+        Lit next_some_clause_violated = satsolver_inc_max_var(checker);
+        satsolver_add(checker, some_clause_violated);
+        satsolver_add(checker, this_clause_violated);
+        satsolver_add(checker, - next_some_clause_violated);
         satsolver_clause_finished(checker);
+
+        some_clause_violated = next_some_clause_violated;
     }
-    if (satsolver_sat(checker) == SATSOLVER_SAT) {
-        LOG_ERROR("Case distinction in the certificate is incomplete.");
-        cert_validate_print_assignment(a, qcnf, checker, aigerlits, truelit);
-        ret = false;
+    if (int_vector_count(clauses) > 0) { // otherwise there is no satisfying assignment to check
+        assert(satsolver_sat(checker) == SATSOLVER_SAT);
     }
-    satsolver_pop(checker);
-    V1("Case distinction in certificate is complete.\n");
-    
-    // Encode big disjunction over the violation of the clauses
-    Lit some_clause_violated = cert_validate_encode_violation_of_some_clause(a, qcnf, aigerlits, checker, truelit);
-    
-    satsolver_add(checker, some_clause_violated);
-    satsolver_clause_finished(checker);
-    
-    sat_res res = satsolver_sat(checker);
-    statistics_stop_and_record_timer(timer);
-    V1("Validation took %f s\n", timer->accumulated_value);
-    if (res != SATSOLVER_UNSAT) {
-        LOG_ERROR("Validation failed!");
-        cert_validate_print_assignment(a, qcnf, checker, aigerlits, truelit);
-    }
-    statistics_free(timer);
-    satsolver_free(checker);
-    ret = ret && (res == SATSOLVER_UNSAT);
-    return ret;
+    return some_clause_violated;
 }
 
-
-// Check one side of the correcntess of the function
-// If there is a satisfying assignment, then the function should produce a satisfying assignment, too.
-bool cert_validate_functional_synthesis(aiger* a, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors) {
-#ifndef DEBUG
-    return true;
-#endif
-    V1("Validating functional synthesis certificate with %u gates.\n", a->num_ands);
-    Stats* timer = statistics_init(1000);  // 1 ms resolution
-    statistics_start_timer(timer);
-    
-    SATSolver* checker = satsolver_init();
-    satsolver_set_max_var(checker, (int) a->maxvar);
-    
-    int truelit = satsolver_inc_max_var(checker);
-    satsolver_add(checker, truelit);
-    satsolver_clause_finished(checker);
-    
-    cert_validate_encode_aiger(a, checker, truelit);
-    
-    Lit some_clause_violated = cert_validate_encode_violation_of_some_clause(a, qcnf, aigerlits, checker, truelit);
-    
+// Encodes a copy of the original formula whose universals are equal to the inputs of the certificate
+static void cert_validate_encode_formula(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, SATSolver* checker, int truelit) {
     int_vector* qcnfvar2satlit = int_vector_init();
     for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
         int satlit = satsolver_inc_max_var(checker);
@@ -169,13 +113,13 @@ bool cert_validate_functional_synthesis(aiger* a, QCNF* qcnf, int_vector* aigerl
     for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
         if (qcnf_var_exists(qcnf, i) && qcnf_is_universal(qcnf, i)) {
             unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
-            assert(aiger_is_input(a, al));
-                   
+            assert(aigeru_is_input(b, al));
+
             satsolver_add(checker,   int_vector_get(qcnfvar2satlit, i));
             satsolver_add(checker, - aiger_lit2lit(al, truelit));
-            
+
             satsolver_clause_finished(checker);
-            
+
             satsolver_add(checker, - int_vector_get(qcnfvar2satlit, i));
             satsolver_add(checker,   aiger_lit2lit(al, truelit));
             satsolver_clause_finished(checker);
@@ -196,94 +140,257 @@ bool cert_validate_functional_synthesis(aiger* a, QCNF* qcnf, int_vector* aigerl
         }
     }
     //    assert(satsolver_sat(checker) == SATSOLVER_SAT); // not the case for empty clause!
-    
-    satsolver_add(checker, some_clause_violated); // is violated even though there must be an assignment to the existentials
-    satsolver_clause_finished(checker);
-    
-    sat_res res = satsolver_sat(checker);
-    statistics_stop_and_record_timer(timer);
-    V1("Validation took %f s\n", timer->accumulated_value);
-    if (res != SATSOLVER_UNSAT) {
-        LOG_ERROR("Validation failed!");
-        cert_validate_print_assignment(a, qcnf, checker, aigerlits, truelit);
-    }
-    
     int_vector_free(qcnfvar2satlit);
-    statistics_free(timer);
-    satsolver_free(checker);
-    return res == SATSOLVER_UNSAT;
 }
 
-// Check one side of the correcntess of the projection:
-// If the projection is 'false', then there should not be a satisfying assignment.
-bool cert_validate_quantifier_elimination(aiger* a, QCNF* qcnf, int_vector* aigerlits, unsigned projection_lit) {
-#ifndef DEBUG
-    return true;
-#endif
-    V1("Validating quantifier elimination with %u gates.\n", a->num_ands);
-    Stats* timer = statistics_init(1000);  // 1 ms resolution
-    statistics_start_timer(timer);
-    
+static void* cert_validate_run_query(void* arg) {
+    Validation_Query* q = (Validation_Query*) arg;
+    log_set_settings(q->log_settings);
+
     SATSolver* checker = satsolver_init();
-    satsolver_set_max_var(checker, (int) a->maxvar);
-    
+    satsolver_set_max_var(checker, (int) aiger_lit2var(q->b->max_sym));
+
     int truelit = satsolver_inc_max_var(checker);
     satsolver_add(checker, truelit);
     satsolver_clause_finished(checker);
-    
-    cert_validate_encode_aiger(a, checker, truelit);
-    
-    int_vector* qcnfvar2satlit = int_vector_init();
-    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
-        int satlit = satsolver_inc_max_var(checker);
-        int_vector_add(qcnfvar2satlit, satlit);
-    }
-    // encode that universal variables of the aiger encoding and the qcnf encoding are equal
-    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
-        if (qcnf_var_exists(qcnf, i) && qcnf_is_universal(qcnf, i)) {
-            unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
-            assert(aiger_is_input(a, al));
-            
-            satsolver_add(checker,   int_vector_get(qcnfvar2satlit, i));
-            satsolver_add(checker, - aiger_lit2lit(al, truelit));
-            
-            satsolver_clause_finished(checker);
-            
-            satsolver_add(checker, - int_vector_get(qcnfvar2satlit, i));
-            satsolver_add(checker,   aiger_lit2lit(al, truelit));
+
+    cert_validate_encode_aiger(q->b, checker, truelit);
+
+    if (q->case_selectors) {
+        for (unsigned i = 0; i < int_vector_count(q->case_selectors); i++) {
+            unsigned sel = (unsigned) int_vector_get(q->case_selectors, i);
+            satsolver_add(checker, - aiger_lit2lit(sel, truelit));
             satsolver_clause_finished(checker);
         }
     }
-    // encode the qcnf in the satlits in qcnfvar2satlit
+    if (q->clauses) {
+        Lit some_clause_violated = cert_validate_encode_violation_of_some_clause(q->b, q->qcnf, q->aigerlits, q->clauses, checker, truelit);
+        satsolver_add(checker, some_clause_violated);
+        satsolver_clause_finished(checker);
+    }
+    if (q->encode_formula) { // then a violation counts only if the existentials could have been chosen correctly
+        cert_validate_encode_formula(q->b, q->qcnf, q->aigerlits, checker, truelit);
+    }
+    if (q->projection_lit != AIGERLIT_NONE) {
+        satsolver_add(checker, - aiger_lit2lit(q->projection_lit, truelit));
+        satsolver_clause_finished(checker);
+    }
+
+    q->result = satsolver_sat(checker);
+    if (q->result == SATSOLVER_SAT) {
+        for (unsigned i = 0; i < var_vector_count(q->qcnf->vars); i++) {
+            if (qcnf_var_exists(q->qcnf, i) && qcnf_is_universal(q->qcnf, i)) {
+                unsigned al = mapped_lit2aigerlit(q->aigerlits, (Lit) i);
+                int val = satsolver_deref(checker, aiger_lit2lit(al, truelit));
+                int_vector_add(q->counterexample, val * (int) i);
+            }
+        }
+    }
+    satsolver_free(checker);
+    return NULL;
+}
+
+static Validation_Query* cert_validate_new_query(vector* queries, AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits) {
+    Validation_Query* q = malloc(sizeof(Validation_Query));
+    q->b = b;
+    q->qcnf = qcnf;
+    q->aigerlits = aigerlits;
+    q->case_selectors = NULL;
+    q->clauses = NULL;
+    q->encode_formula = false;
+    q->projection_lit = AIGERLIT_NONE;
+    q->log_settings = log_get_settings();
+    q->result = SATSOLVER_UNKNOWN;
+    q->counterexample = int_vector_init();
+    vector_add(queries, q);
+    return q;
+}
+
+// Distributes the original clauses round robin over at most groups_max queries
+static void cert_validate_add_clause_group_queries(vector* queries, AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits,
+                                                   unsigned groups_max, bool encode_formula) {
+    vector* groups = vector_init();
+    unsigned clauses_num = 0;
     for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
         Clause* c = vector_get(qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && qcnf_is_original_clause(qcnf, c->clause_idx)) {
+            if (vector_count(groups) < groups_max) {
+                Validation_Query* q = cert_validate_new_query(queries, b, qcnf, aigerlits);
+                q->clauses = int_vector_init();
+                q->encode_formula = encode_formula;
+                vector_add(groups, q);
+            }
+            Validation_Query* q = vector_get(groups, clauses_num++ % vector_count(groups));
+            int_vector_add(q->clauses, (int) c->clause_idx);
+        }
+    }
+    vector_free(groups);
+}
+
+// Runs the queries in parallel threads; the certificate is valid if all queries are UNSAT
+static bool cert_validate_run_queries(vector* queries) {
+    if (vector_count(queries) == 1) {
+        cert_validate_run_query(vector_get(queries, 0));
+    } else {
+        for (unsigned i = 0; i < vector_count(queries); i++) {
+            Validation_Query* q = vector_get(queries, i);
+            int err = pthread_create(&q->thread, NULL, cert_validate_run_query, q);
+            abortif(err != 0, "Could not create thread for validation query %u.", i);
+        }
+        for (unsigned i = 0; i < vector_count(queries); i++) {
+            Validation_Query* q = vector_get(queries, i);
+            pthread_join(q->thread, NULL);
+        }
+    }
+    bool valid = true;
+    for (unsigned i = 0; i < vector_count(queries); i++) {
+        Validation_Query* q = vector_get(queries, i);
+        if (valid && q->result != SATSOLVER_UNSAT) {
+            if (q->case_selectors) {
+                LOG_ERROR("Case distinction in the certificate is incomplete.");
+            } else {
+                LOG_ERROR("Validation failed!");
+            }
+            cert_validate_print_assignment(q->counterexample);
+            valid = false;
+        }
+        if (q->clauses) {int_vector_free(q->clauses);}
+        int_vector_free(q->counterexample);
+        free(q);
+    }
+    vector_free(queries);
+    return valid;
+}
+
+static uint64_t cert_validate_simulated_value(uint64_t* values, unsigned lit) {
+    uint64_t v = values[aiger_lit2var(lit)];
+    return aiger_sign(lit) ? ~v : v;
+}
+
+// Returns false if one of the random assignments to the universals falsifies the certificate
+static bool cert_validate_simulate_skolem_function(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors) {
+    uint64_t* values = calloc(aiger_lit2var(b->max_sym) + 1, sizeof(uint64_t));
+    MersenneTwister* mt = mersenne_twister_init(1);
+    int_vector* counterexample = int_vector_init();
+    bool valid = true;
+    for (unsigned round = 0; round < CERT_VALIDATE_SIMULATION_ROUNDS && valid; round++) {
+        for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+            if (qcnf_var_exists(qcnf, i) && qcnf_is_universal(qcnf, i)) {
+                unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
+                values[aiger_lit2var(al)] = (uint64_t) genrand_int32(mt) << 32 | (uint64_t) genrand_int32(mt);
+            }
+        }
+        for (unsigned i = 0; i < aigeru_gates_num(b); i++) {
+            unsigned lhs, rhs0, rhs1;
+            aigeru_get_gate(b, i, &lhs, &rhs0, &rhs1);
+            values[aiger_lit2var(lhs)] = cert_validate_simulated_value(values, rhs0) & cert_validate_simulated_value(values, rhs1);
+        }
+
+        uint64_t some_case_applies = 0;
+        for (unsigned i = 0; i < int_vector_count(case_selectors); i++) {
+            some_case_applies |= cert_validate_simulated_value(values, (unsigned) int_vector_get(case_selectors, i));
+        }
+        uint64_t failing = ~some_case_applies;
+        if (failing) {
+            LOG_ERROR("Case distinction in the certificate is incomplete.");
+        }
+        for (unsigned i = 0; i < vector_count(qcnf->all_clauses) && !failing; i++) {
+            Clause* c = vector_get(qcnf->all_clauses, i);
+            if (c == NULL || !qcnf_is_original_clause(qcnf, c->clause_idx)) {
+                continue;
+            }
+            uint64_t violated = ~ (uint64_t) 0;
             for (unsigned j = 0; j < c->size; j++) {
-                Lit l = c->occs[j];
-                unsigned var_id = lit_to_var(l);
-                int polarity = l > 0 ? 1 : -1;
-                int satlit = int_vector_get(qcnfvar2satlit, var_id);
-                satsolver_add(checker, satlit * polarity);
+                violated &= ~ cert_validate_simulated_value(values, mapped_lit2aigerlit(aigerlits, c->occs[j]));
+            }
+            if (violated) {
+                LOG_ERROR("Validation failed!");
+                failing = violated;
             }
-            satsolver_clause_finished(checker);
+        }
+        if (failing) {
+            unsigned bit = 0;
+            while (! (failing >> bit & 1)) {bit++;}
+            for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+                if (qcnf_var_exists(qcnf, i) && qcnf_is_universal(qcnf, i)) {
+                    unsigned al = mapped_lit2aigerlit(aigerlits, (Lit) i);
+                    int_vector_add(counterexample, (values[aiger_lit2var(al)] >> bit & 1) ? (int) i : - (int) i);
+                }
+            }
+            cert_validate_print_assignment(counterexample);
+            valid = false;
         }
     }
-    //    assert(satsolver_sat(checker) == SATSOLVER_SAT); // not the case for empty clause!
-    
-    int projection_satlit = aiger_lit2lit(projection_lit, truelit);
-    satsolver_add(checker, - projection_satlit); // is violated even though there must be an assignment to the existentials
-    satsolver_clause_finished(checker);
-    
-    sat_res res = satsolver_sat(checker);
+    int_vector_free(counterexample);
+    mersenne_twister_free(mt);
+    free(values);
+    return valid;
+}
+
+
+bool cert_validate_skolem_function(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors, Options* o) {
+#ifndef DEBUG
+    return true;
+#endif
+    V1("Validating Skolem function with %u gates.\n", aigeru_gates_num(b));
+    Stats* timer = statistics_init(1000);  // 1 ms resolution
+    statistics_start_timer(timer);
+
+    bool ret = cert_validate_simulate_skolem_function(b, qcnf, aigerlits, case_selectors);
+    if (ret) {
+        V1("Simulation found no counterexample to the certificate.\n");
+        vector* queries = vector_init();
+        Validation_Query* cases = cert_validate_new_query(queries, b, qcnf, aigerlits);
+        cases->case_selectors = case_selectors;
+        cert_validate_add_clause_group_queries(queries, b, qcnf, aigerlits, o->validation_threads, false);
+        ret = cert_validate_run_queries(queries);
+    }
+
     statistics_stop_and_record_timer(timer);
     V1("Validation took %f s\n", timer->accumulated_value);
-    if (res != SATSOLVER_UNSAT) {
-        LOG_ERROR("Validation failed!");
-        cert_validate_print_assignment(a, qcnf, checker, aigerlits, truelit);
-    }
-    
-    int_vector_free(qcnfvar2satlit);
     statistics_free(timer);
-    satsolver_free(checker);
-    return res == SATSOLVER_UNSAT;
+    return ret;
+}
+
+
+// Check one side of the correcntess of the function
+// If there is a satisfying assignment, then the function should produce a satisfying assignment, too.
+bool cert_validate_functional_synthesis(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, int_vector* case_selectors, Options* o) {
+#ifndef DEBUG
+    return true;
+#endif
+    V1("Validating functional synthesis certificate with %u gates.\n", aigeru_gates_num(b));
+    Stats* timer = statistics_init(1000);  // 1 ms resolution
+    statistics_start_timer(timer);
+
+    vector* queries = vector_init();
+    cert_validate_add_clause_group_queries(queries, b, qcnf, aigerlits, o->validation_threads, true);
+    bool ret = vector_count(queries) == 0 || cert_validate_run_queries(queries);
+
+    statistics_stop_and_record_timer(timer);
+    V1("Validation took %f s\n", timer->accumulated_value);
+    statistics_free(timer);
+    return ret;
+}
+
+// Check one side of the correcntess of the projection:
+// If the projection is 'false', then there should not be a satisfying assignment.
+bool cert_validate_quantifier_elimination(AigerBuilder* b, QCNF* qcnf, int_vector* aigerlits, unsigned projection_lit) {
+#ifndef DEBUG
+    return true;
+#endif
+    V1("Validating quantifier elimination with %u gates.\n", aigeru_gates_num(b));
+    Stats* timer = statistics_init(1000);  // 1 ms resolution
+    statistics_start_timer(timer);
+
+    vector* queries = vector_init();
+    Validation_Query* q = cert_validate_new_query(queries, b, qcnf, aigerlits);
+    q->encode_formula = true;
+    q->projection_lit = projection_lit;
+    bool ret = cert_validate_run_queries(queries);
+
+    statistics_stop_and_record_timer(timer);
+    V1("Validation took %f s\n", timer->accumulated_value);
+    statistics_free(timer);
+    return ret;
 }
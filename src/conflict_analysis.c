@@ -155,13 +155,13 @@ unsigned determine_cost(conflict_analysis* ca, Clause* c) {
 Clause* conflict_analysis_find_reason_for_value(conflict_analysis* ca, Lit lit, bool* depends_on_illegals) {
     assert(lit != 0);
     Var* v = var_vector_get(ca->c2->qcnf->vars, lit_to_var(lit));
-    vector* occs = lit > 0 ? &v->pos_occs : &v->neg_occs;
+    occ_vector* occs = lit > 0 ? &v->pos_occs : &v->neg_occs;
     
     Clause* candidate = NULL;
     unsigned candidate_cost = UINT_MAX;
     bool depends_on_illegals_candidate = false;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         
         // it is questionable whether this optimization actually helps as it requires us to keep another data structure in cache
         if (!ca->domain_is_relevant_clause(ca->domain, c, lit)) {
@@ -213,10 +213,10 @@ void conflict_analysis_follow_implication_graph(conflict_analysis* ca) {
                 abortif(ca->c2->state == C2_SKOLEM_CONFLICT
                         && ! skolem_is_decision_var(ca->c2->skolem, var_id)
                         && ! int_vector_contains(ca->c2->skolem->universals_assumptions, lit)
+                        && ! int_vector_contains(ca->c2->assumptions, lit)
                         && ! qcnf_is_universal(ca->c2->qcnf, var_id),
                         "No reason for lit %d found in conflict analysis.\n", lit);
-                int_vector_add(ca->conflicting_assignment, lit);
-                // TODO: this is where assumptions for incremental solving would come in
+                int_vector_add(ca->conflicting_assignment, lit); // assumptions of incremental solving end up here
             }
         }
     }
@@ -16,10 +16,11 @@ typedef enum {
     EXAMPLES_OP_DECISION
 } EXAMPLES_OP;
 
-Examples* examples_init(QCNF* qcnf, unsigned examples_max_num) {
+Examples* examples_init(QCNF* qcnf, unsigned examples_max_num, MersenneTwister* rng) {
     Examples* e = malloc(sizeof(Examples));
     e->qcnf = qcnf;
     e->example_max_num = examples_max_num;
+    e->rng = rng;
     e->ex = vector_init();
     e->conflicted_pa = NULL;
     e->state = EXAMPLES_STATE_READY;
@@ -73,9 +74,9 @@ bool examples_is_decision_consistent_with_skolem_pa(Examples* e, Skolem* s, Lit
         // OK, the decision var has to have the opposite value. Is that justified only based on the clauses with unique consequence?
         
         // Is any of the antecedents of the opposite lit satisfied? I.e. is this decision doomed to produce a conflict?
-        vector* opposite_occs = qcnf_get_occs_of_lit(e->qcnf, - decision_lit);
-        for (unsigned i = 0; i < vector_count(opposite_occs); i++) {
-            Clause* c = vector_get(opposite_occs, i);
+        occ_vector* opposite_occs = qcnf_get_occs_of_lit(e->qcnf, - decision_lit);
+        for (unsigned i = 0; i < occ_vector_count(opposite_occs); i++) {
+            Clause* c = occ_vector_get(opposite_occs, i);
             if (skolem_get_unique_consequence(s, c) == - decision_lit && partial_assignment_is_antecedent_satisfied(pa, c, - decision_lit)) {
                 return true;
             }
@@ -201,7 +202,7 @@ PartialAssignment* examples_add_assignment_from_skolem(Examples* e, Skolem* s) {
                 if (qcnf_var_exists(e->qcnf, i) && qcnf_is_universal(e->qcnf, i)) {
                     int val = skolem_get_value_for_conflict_analysis(s, (Lit) i);
                     if (val == 0) {
-                        val = (genrand_int31() % 2) * 2 - 1;
+                        val = (genrand_int31(e->rng) % 2) * 2 - 1;
                     }
                     assert(val == -1 || val == 1);
                     partial_assignment_assign_value(pa, val * (Lit) i);
@@ -238,7 +239,7 @@ PartialAssignment* examples_add_random_assignment(Examples* e) {
         if (! partial_assignment_is_conflicted(pa)) {
             for (unsigned i = 1; i < var_vector_count(e->qcnf->vars); i++) {
                 if (qcnf_var_exists(e->qcnf, i) && qcnf_is_universal(e->qcnf, i)) {
-                    int val = (genrand_int31() % 2) * 2 - 1;
+                    int val = (genrand_int31(e->rng) % 2) * 2 - 1;
                     assert(val == -1 || val == 1);
                     partial_assignment_assign_value(pa, val * (Lit) i);
                 }
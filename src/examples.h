@@ -13,6 +13,7 @@
 #include "skolem.h"
 #include "statistics.h"
 #include "undo_stack.h"
+#include "mersenne_twister.h"
 
 struct Examples;
 typedef struct Examples Examples;
@@ -26,6 +27,7 @@ typedef enum {
 struct Examples {
     QCNF* qcnf;
     unsigned example_max_num;
+    MersenneTwister* rng; // not owned
 //    float_vector* activity; // tracks the recent success/usefulness of each example
     vector* ex; // vector of partial_assignment domains
     PartialAssignment* conflicted_pa;
@@ -39,7 +41,7 @@ struct Examples {
     Stats* create_skolem;
 };
 
-Examples* examples_init(QCNF*, unsigned examples_max_num);
+Examples* examples_init(QCNF*, unsigned examples_max_num, MersenneTwister*);
 void examples_free(Examples*);
 void examples_print_statistics(Examples*);
 
@@ -108,9 +108,10 @@ int cmp (const void * a, const void * b) {
 
 void heap_test() {
     heap* h = heap_init(cmp);
+    MersenneTwister* rng = mersenne_twister_init(0);
     
     for (unsigned i = 0; i < 10; i++) {
-        int elem = genrand_int31() % 42 - 21;
+        int elem = genrand_int31(rng) % 42 - 21;
         V2("%d ", elem);
         heap_push(h, (void*) (long) elem);
     }
@@ -122,6 +123,7 @@ void heap_test() {
     }
     V2("\n");
     vector_print(h->vector);
+    mersenne_twister_free(rng);
 }
 
 
@@ -9,6 +9,8 @@
 #ifndef int_vector_h
 #define int_vector_h
 
+#include "mersenne_twister.h"
+
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -44,5 +46,5 @@ int_vector* int_vector_copy(int_vector*);
 bool int_vector_includes_sorted(int_vector*,int_vector*); // compare by subset relation
 void int_vector_add_all_sorted(int_vector* add_to, int_vector* to_add); // Adds the elements of the second to the first, sorts in the end
 void int_vector_add_all(int_vector* add_to, int_vector* to_add); // Adds the elements of the second to the first
-void int_vector_shuffle(int_vector*);
+void int_vector_shuffle(int_vector*, MersenneTwister*);
 #endif /* int_vector_h */
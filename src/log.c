@@ -8,7 +8,23 @@
 
 #include "log.h"
 
-int debug_verbosity = VERBOSITY_NONE;
-bool log_qdimacs_compliant = false;
-bool log_colors = true;
-bool log_silent = false;
+_Thread_local int debug_verbosity = VERBOSITY_NONE;
+_Thread_local bool log_qdimacs_compliant = false;
+_Thread_local bool log_colors = true;
+_Thread_local bool log_silent = false;
+
+Log_Settings log_get_settings() {
+    Log_Settings s;
+    s.verbosity = debug_verbosity;
+    s.qdimacs_compliant = log_qdimacs_compliant;
+    s.colors = log_colors;
+    s.silent = log_silent;
+    return s;
+}
+
+void log_set_settings(Log_Settings s) {
+    debug_verbosity = s.verbosity;
+    log_qdimacs_compliant = s.qdimacs_compliant;
+    log_colors = s.colors;
+    log_silent = s.silent;
+}
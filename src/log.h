@@ -36,10 +36,28 @@
 #define KORANGE  "\x1B[38;5;202m"
 #define KORANGE_BOLD  "\x1B[01;38;5;202m"
 
-extern int debug_verbosity;
-extern bool log_qdimacs_compliant;
-extern bool log_colors;
-extern bool log_silent;
+// The log settings are thread local: the verbosity is temporarily lowered during case split
+// probes, and solver instances on different threads may log differently. Threads that solve on
+// behalf of another thread copy its settings with log_get_settings and log_set_settings.
+#ifdef __cplusplus
+#define LOG_THREAD_LOCAL thread_local
+#else
+#define LOG_THREAD_LOCAL _Thread_local
+#endif
+extern LOG_THREAD_LOCAL int debug_verbosity;
+extern LOG_THREAD_LOCAL bool log_qdimacs_compliant;
+extern LOG_THREAD_LOCAL bool log_colors;
+extern LOG_THREAD_LOCAL bool log_silent;
+
+typedef struct {
+    int verbosity;
+    bool qdimacs_compliant;
+    bool colors;
+    bool silent;
+} Log_Settings;
+
+Log_Settings log_get_settings(void);
+void log_set_settings(Log_Settings);
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
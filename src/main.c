@@ -8,6 +8,7 @@
 #include "c2_rl.h"
 #include "mersenne_twister.h"
 #include "tests.h"
+#include "benchmarks.h"
 
 #include <stdio.h>
 #include <stdbool.h>
@@ -144,10 +145,53 @@ int main(int argc, const char* argv[]) {
                         options->fresh_random_seed = true;
                     } else if (strcmp(argv[i], "--random_decisions") == 0) {
                         options->random_decisions = true;
+                    } else if (strcmp(argv[i], "--polarity") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing string for argument --polarity\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        if (strcmp(argv[i+1], "jw") == 0) {
+                            options->polarity = POLARITY_JEROSLOW_WANG;
+                        } else if (strcmp(argv[i+1], "phase") == 0) {
+                            options->polarity = POLARITY_PHASE_SAVING;
+                        } else if (strcmp(argv[i+1], "pos") == 0) {
+                            options->polarity = POLARITY_POSITIVE;
+                        } else if (strcmp(argv[i+1], "neg") == 0) {
+                            options->polarity = POLARITY_NEGATIVE;
+                        } else {
+                            LOG_ERROR("Unknown polarity '%s'; must be one of jw, phase, pos, neg.\n", argv[i+1]);
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        i++;
+                    } else if (strcmp(argv[i], "--decision_policy") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing file name for argument --decision_policy\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->decision_policy_file_name = argv[i+1];
+                        i++;
                     } else if (strcmp(argv[i], "--minimize") == 0) {
                         options->minimize_learnt_clauses = ! options->minimize_learnt_clauses;
+                    } else if (strcmp(argv[i], "--chrono") == 0) {
+                        options->chronological_backtracking = ! options->chronological_backtracking;
+                    } else if (strcmp(argv[i], "--subsumption") == 0) {
+                        options->subsumption = ! options->subsumption;
+                    } else if (strcmp(argv[i], "--preprocess") == 0) {
+                        options->preprocess = ! options->preprocess;
                     } else if (strcmp(argv[i], "--miniscoping") == 0) {
                         options->miniscoping = ! options->miniscoping;
+                    } else if (strcmp(argv[i], "--miniscoping_threads") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of miniscoping threads\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->miniscoping_threads = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->miniscoping_threads == 0 || options->miniscoping_threads > 256, "Number of miniscoping threads must be between 1 and 256. Argument was: %s", argv[i+1]);
+                        i++;
                     } else if (strcmp(argv[i], "--miniscoping_info") == 0) {
                         options->print_detailed_miniscoping_stats = ! options->print_detailed_miniscoping_stats;
                     } else if (strcmp(argv[i], "--trace_learnt_clauses") == 0) {
@@ -159,6 +203,16 @@ int main(int argc, const char* argv[]) {
                     } else if (strcmp(argv[i], "--rl") == 0) {
                         options->reinforcement_learning = true;
                         log_colors = false;
+                    } else if (strcmp(argv[i], "--rl_socket") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing path of socket for reinforcement learning\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->reinforcement_learning = true;
+                        options->rl_socket_path = argv[i+1];
+                        log_colors = false;
+                        i++;
                     } else if (strcmp(argv[i], "--rl_advanced_rewards") == 0) {
                         options->rl_advanced_rewards = ! options->rl_advanced_rewards;
                     } else if (strcmp(argv[i], "--rl_vsids_rewards") == 0) {
@@ -221,15 +275,91 @@ int main(int argc, const char* argv[]) {
                         i++;
                     } else if (strcmp(argv[i], "--trace_for_profiling") == 0) {
                         options->trace_for_profiling = true;
+                    } else if (strcmp(argv[i], "--profile") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing file name for profile\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->profile_file_name = argv[i+1];
+                        i++;
                     } else if (strcmp(argv[i], "--print_variable_names") == 0) {
                         options->print_variable_names = true;
                     } else if (strcmp(argv[i], "--selftest") == 0) {
                         test_all();
                         exit(0);
+                    } else if (strcmp(argv[i], "--microbenchmarks") == 0) {
+                        benchmark_all();
+                        exit(0);
                     } else if (strcmp(argv[i], "--cegar") == 0) {
                         options->cegar = ! options->cegar;
                     } else if (strcmp(argv[i], "--cegar_only") == 0) {
                         options->cegar_only = ! options->cegar_only;
+                    } else if (strcmp(argv[i], "--portfolio") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of portfolio workers\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->portfolio_workers = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->portfolio_workers > 64, "At most 64 portfolio workers supported. Argument was: %s", argv[i+1]);
+                        i++;
+                    } else if (strcmp(argv[i], "--portfolio_sharing") == 0) {
+                        options->portfolio_clause_sharing = ! options->portfolio_clause_sharing;
+                    } else if (strcmp(argv[i], "--batch") == 0) {
+                        options->batch = true;
+                    } else if (strcmp(argv[i], "--batch_workers") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of batch workers\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->batch_workers = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->batch_workers == 0 || options->batch_workers > 256, "Number of batch workers must be between 1 and 256. Argument was: %s", argv[i+1]);
+                        i++;
+                    } else if (strcmp(argv[i], "--validation_threads") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of validation threads\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->validation_threads = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->validation_threads == 0 || options->validation_threads > 256, "Number of validation threads must be between 1 and 256. Argument was: %s", argv[i+1]);
+                        i++;
+                    } else if (strcmp(argv[i], "--time_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing time limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->time_limit = strtod(argv[i+1], NULL);
+                        i++;
+                    } else if (strcmp(argv[i], "--conflict_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing conflict limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->conflict_limit = (unsigned) strtol(argv[i+1], NULL, 0);
+                        i++;
+                    } else if (strcmp(argv[i], "--job_time_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing time limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->job_time_limit = strtod(argv[i+1], NULL);
+                        i++;
+                    } else if (strcmp(argv[i], "--batch_memory_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing memory limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->batch_memory_limit = (unsigned) strtol(argv[i+1], NULL, 0);
+                        i++;
+                    } else if (strcmp(argv[i], "--cegar_cores") == 0) {
+                        options->cegar_core_generalization = ! options->cegar_core_generalization;
                     } else if (strcmp(argv[i], "--sat_by_qbf") == 0) {
                         options->use_qbf_engine_also_for_propositional_problems = ! options->use_qbf_engine_also_for_propositional_problems;
                     } else if (strcmp(argv[i], "--pg") == 0) {
@@ -268,6 +398,18 @@ int main(int argc, const char* argv[]) {
         LOG_WARNING("Verbosity is medium or higher and comment prefix is set. May result in cluttered log.");
     }
     
+    c2_handle_signals();
+    
+    if (options->profile_file_name && (options->batch || options->portfolio_workers > 1)) {
+        LOG_WARNING("Profiling is only supported for sequential solving; switching it off.");
+        options->profile_file_name = NULL;
+    }
+    
+    if (options->batch) {
+        log_silent = true; // stdout is reserved for the JSON lines
+        return c2_batch(file_name, options);
+    }
+    
     V0("CADET %s\n", VERSION);
     
     options_print(options);
@@ -4,13 +4,23 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include <assert.h>
 
 
-#define INITIAL_MAP_SIZE 10
+#define INITIAL_MAP_SIZE 16
 
-int map_hash_function(int key, size_t size) {
-    return hash32shiftmult(key) % (int) size;
+static size_t map_home_slot(map* container, int key) {
+    return (size_t) (unsigned) hash32shiftmult(key) & (container->size - 1);
+}
+
+static size_t map_round_size(size_t size) {
+    size_t s = INITIAL_MAP_SIZE;
+    while (s < size) {
+        s *= 2;
+    }
+    return s;
 }
 
 map* map_init() {
@@ -19,122 +29,133 @@ map* map_init() {
 
 map* map_init_size(size_t size) {
     map* container = malloc(sizeof(map));
-    container->data = calloc(sizeof(map_entry*), size);
+    container->size = map_round_size(size);
+    container->data = malloc(sizeof(map_entry) * container->size);
+    container->dist = calloc(sizeof(unsigned char), container->size);
     container->count = 0;
-    container->size = size;
     return container;
 }
 
-map_entry* map_get_entry(map* container, int key) {
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* entry = container->data[hash];
-    while (entry != NULL && entry->key != key) {
-        entry = entry->next;
+// Returns the slot of the key, or container->size if the key is not in the map
+static size_t map_find(map* container, int key) {
+    size_t mask = container->size - 1;
+    size_t pos = map_home_slot(container, key);
+    for (unsigned d = 1; container->dist[pos] >= d; d++) {
+        if (container->data[pos].key == key) {
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return container->size;
+}
+
+// Places the entry without checking the load factor; does not touch the count.
+static void map_insert(map* container, map_entry e) {
+    size_t mask = container->size - 1;
+    size_t pos = map_home_slot(container, e.key);
+    unsigned char d = 1;
+    while (container->dist[pos] != 0) {
+        if (container->dist[pos] < d) { // rich entry gives way to the poor one
+            map_entry tmp_e = container->data[pos];
+            unsigned char tmp_d = container->dist[pos];
+            container->data[pos] = e;
+            container->dist[pos] = d;
+            e = tmp_e;
+            d = tmp_d;
+        }
+        pos = (pos + 1) & mask;
+        d++;
+        if (d == UCHAR_MAX) { // probe distances must fit the metadata; e is the only entry not in the table
+            map_resize(container, 2 * container->size);
+            map_insert(container, e);
+            return;
+        }
     }
-    return entry;
+    container->data[pos] = e;
+    container->dist[pos] = d;
 }
 
 bool map_contains(map* container, int key) {
-    return map_get_entry(container, key) != NULL;
+    return map_find(container, key) != container->size;
 }
 
 void* map_get(map* container, int key) {
-    map_entry* entry = map_get_entry(container, key);
-    assert(entry != NULL);
-    assert(entry->key == key);
-    return entry->data;
+    size_t pos = map_find(container, key);
+    assert(pos != container->size);
+    assert(container->data[pos].key == key);
+    return container->data[pos].data;
 }
 
 // Same as map_add, but works only if the element is already in the map
 void map_update(map* container, int key, void* data) {
-    map_entry* entry = map_get_entry(container, key);
-    assert(entry != NULL);
-    entry->data = data;
+    size_t pos = map_find(container, key);
+    assert(pos != container->size);
+    container->data[pos].data = data;
 }
 
 void map_add(map* container, int key, void* data) {
     assert(!map_contains(container, key));
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* new_entry = malloc(sizeof(map_entry));
-    new_entry->key = key;
-    new_entry->data = data;
-    new_entry->next = container->data[hash];
-    container->data[hash] = new_entry;
-    
-    container->count++;
-    
-    if (container->count > container->size + container->size / 2) {
+    if (4 * (container->count + 1) > 3 * container->size) {
         map_resize(container, 2 * container->size);
     }
+    map_entry e;
+    e.key = key;
+    e.data = data;
+    map_insert(container, e);
+    container->count++;
 }
 
 void map_resize(map* container, size_t new_size) {
 //    V4("Resizing container to size %zu\n", new_size);
+    new_size = map_round_size(new_size);
+    assert(4 * container->count <= 3 * new_size);
     size_t old_size = container->size;
-    map_entry** old_data = container->data;
-    
+    map_entry* old_data = container->data;
+    unsigned char* old_dist = container->dist;
+
     container->size = new_size;
-    container->data = calloc(sizeof(map_entry*), new_size);
-    
+    container->data = malloc(sizeof(map_entry) * new_size);
+    container->dist = calloc(sizeof(unsigned char), new_size);
+
     for (size_t i = 0; i < old_size; i++) {
-        map_entry* entry = old_data[i];
-        while (entry != NULL) {
-            map_entry* next = entry->next;
-            int new_hash = map_hash_function(entry->key, container->size);
-            assert(new_hash >= 0 && new_hash < (int) container->size);
-            
-            entry->next = container->data[new_hash];
-            container->data[new_hash] = entry;
-            
-            entry = next;
+        if (old_dist[i] != 0) {
+            map_insert(container, old_data[i]);
         }
     }
-    
+
     free(old_data);
+    free(old_dist);
 }
 
 void map_remove(map* container, int key) {
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* entry = container->data[hash];
-    map_entry* prev = NULL;
-    while (entry != NULL && entry->key != key) {
-        prev = entry;
-        entry = entry->next;
-    }
-    if (entry == NULL) {
+    size_t pos = map_find(container, key);
+    if (pos == container->size) {
         return;
     }
-    
-    if (prev == NULL) {
-        container->data[hash] = entry->next;
-    } else {
-        prev->next = entry->next;
+    container->count--;
+    // shift the following entries back until one is empty or in its home slot
+    size_t mask = container->size - 1;
+    size_t next = (pos + 1) & mask;
+    while (container->dist[next] > 1) {
+        container->data[pos] = container->data[next];
+        container->dist[pos] = (unsigned char) (container->dist[next] - 1);
+        pos = next;
+        next = (next + 1) & mask;
     }
-    
-    free(entry);
+    container->dist[pos] = 0;
 }
 
 void map_reset(map* container) {
-    for (size_t i = 0; i < container->size; i++) {
-        map_entry* next_e;
-        for (map_entry* e = container->data[i]; e != NULL; e = next_e) {
-            next_e = e->next;
-            free(e);
-        }
-        container->data[i] = 0;
+    if (container->count == 0) {
+        return;
     }
+    memset(container->dist, 0, container->size);
     container->count = 0;
 }
 
 void map_free(map* container) {
-    map_reset(container);
     free(container->data);
+    free(container->dist);
     free(container);
 }
 
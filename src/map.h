@@ -1,22 +1,25 @@
+
+// Hash map from ints to pointers. Open addressing with linear probing and
+// Robin Hood ordering: entries are stored inline, lookups stop as soon as they
+// pass the slot the key would have displaced, and removal shifts the following
+// entries back instead of leaving tombstones.
+
 #ifndef MAP_H
 #define MAP_H
 
 #include <stdlib.h>
 #include <stdbool.h>
 
-struct map_entry;
-typedef struct map_entry map_entry;
-
-struct map_entry {
+typedef struct {
     int        key;
     void*      data;
-    map_entry* next;
-};
+} map_entry;
 
 struct map {
-    map_entry** data;
-    size_t      size;
-    size_t      count;
+    map_entry*     data;
+    unsigned char* dist; // 0 for empty slots, otherwise 1 + distance to the slot the key hashes to
+    size_t         size; // power of two
+    size_t         count;
 };
 
 typedef struct map map;
@@ -45,20 +45,34 @@
  email: m-mat @ math.sci.hiroshima-u.ac.jp (remove space)
  */
 
+#include "mersenne_twister.h"
+
 #include <stdio.h>
+#include <stdlib.h>
 
 /* Period parameters */
-#define N 624
+#define N MERSENNE_TWISTER_N
 #define M 397
 #define MATRIX_A 0x9908b0dfUL   /* constant vector a */
 #define UPPER_MASK 0x80000000UL /* most significant w-r bits */
 #define LOWER_MASK 0x7fffffffUL /* least significant r bits */
 
-static unsigned long mt[N]; /* the array for the state vector  */
-static int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
+/* The state lives in MersenneTwister objects, so that solver instances do not share it. */
+#define mt (rng->mt)
+#define mti (rng->mti)
+
+MersenneTwister* mersenne_twister_init(unsigned long s) {
+    MersenneTwister* rng = malloc(sizeof(MersenneTwister));
+    init_genrand(rng, s);
+    return rng;
+}
+
+void mersenne_twister_free(MersenneTwister* rng) {
+    free(rng);
+}
 
 /* initializes mt[N] with a seed */
-void init_genrand(unsigned long s)
+void init_genrand(MersenneTwister* rng, unsigned long s)
 {
     mt[0]= s & 0xffffffffUL;
     for (mti=1; mti<N; mti++) {
@@ -77,10 +91,10 @@ void init_genrand(unsigned long s)
 /* init_key is the array for initializing keys */
 /* key_length is its length */
 /* slight change for C++, 2004/2/26 */
-void init_by_array(unsigned long init_key[], int key_length)
+void init_by_array(MersenneTwister* rng, unsigned long init_key[], int key_length)
 {
     int i, j, k;
-    init_genrand(19650218UL);
+    init_genrand(rng, 19650218UL);
     i=1; j=0;
     k = (N>key_length ? N : key_length);
     for (; k; k--) {
@@ -103,17 +117,17 @@ void init_by_array(unsigned long init_key[], int key_length)
 }
 
 /* generates a random number on [0,0xffffffff]-interval */
-unsigned long genrand_int32(void)
+unsigned long genrand_int32(MersenneTwister* rng)
 {
     unsigned long y;
-    static unsigned long mag01[2]={0x0UL, MATRIX_A};
+    static const unsigned long mag01[2]={0x0UL, MATRIX_A};
     /* mag01[x] = x * MATRIX_A  for x=0,1 */
     
     if (mti >= N) { /* generate N words at one time */
         int kk;
         
         if (mti == N+1)   /* if init_genrand() has not been called, */
-            init_genrand(5489UL); /* a default initial seed is used */
+            init_genrand(rng, 5489UL); /* a default initial seed is used */
         
         for (kk=0;kk<N-M;kk++) {
             y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
@@ -141,36 +155,36 @@ unsigned long genrand_int32(void)
 }
 
 /* generates a random number on [0,0x7fffffff]-interval */
-long genrand_int31(void)
+long genrand_int31(MersenneTwister* rng)
 {
-    return (long)(genrand_int32()>>1);
+    return (long)(genrand_int32(rng)>>1);
 }
 
 /* generates a random number on [0,1]-real-interval */
-double genrand_real1(void)
+double genrand_real1(MersenneTwister* rng)
 {
-    return genrand_int32()*(1.0/4294967295.0);
+    return genrand_int32(rng)*(1.0/4294967295.0);
     /* divided by 2^32-1 */
 }
 
 /* generates a random number on [0,1)-real-interval */
-double genrand_real2(void)
+double genrand_real2(MersenneTwister* rng)
 {
-    return genrand_int32()*(1.0/4294967296.0);
+    return genrand_int32(rng)*(1.0/4294967296.0);
     /* divided by 2^32 */
 }
 
 /* generates a random number on (0,1)-real-interval */
-double genrand_real3(void)
+double genrand_real3(MersenneTwister* rng)
 {
-    return (((double)genrand_int32()) + 0.5)*(1.0/4294967296.0);
+    return (((double)genrand_int32(rng)) + 0.5)*(1.0/4294967296.0);
     /* divided by 2^32 */
 }
 
 /* generates a random number on [0,1) with 53-bit resolution*/
-double genrand_res53(void)
+double genrand_res53(MersenneTwister* rng)
 {
-    unsigned long a=genrand_int32()>>5, b=genrand_int32()>>6;
+    unsigned long a=genrand_int32(rng)>>5, b=genrand_int32(rng)>>6;
     return(a*67108864.0+b)*(1.0/9007199254740992.0);
 }
 /* These real versions are due to Isaku Wada, 2002/01/09 added */
@@ -9,13 +9,23 @@
 #ifndef mersenne_twister_h
 #define mersenne_twister_h
 
+#define MERSENNE_TWISTER_N 624
+
+typedef struct {
+    unsigned long mt[MERSENNE_TWISTER_N]; /* the array for the state vector  */
+    int mti; /* mti==N+1 means mt[N] is not initialized */
+} MersenneTwister;
+
+MersenneTwister* mersenne_twister_init(unsigned long s);
+void mersenne_twister_free(MersenneTwister*);
+
 /* initializes mt[N] with a seed. Default seed is 5489UL. */
-void init_genrand(unsigned long s);
+void init_genrand(MersenneTwister*, unsigned long s);
 
 /* generates a random number on [0,0xffffffff]-interval */
-unsigned long genrand_int32(void);
+unsigned long genrand_int32(MersenneTwister*);
 
 /* generates a random number on [0,0x7fffffff]-interval */
-long genrand_int31(void);
+long genrand_int31(MersenneTwister*);
 
 #endif /* mersenne_twister_h */
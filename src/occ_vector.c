@@ -0,0 +1,71 @@
+//
+//  occ_vector.c
+//  cadet
+//
+
+#include "occ_vector.h"
+#include "log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Clause** occ_vector_elements(occ_vector* v) {
+    return v->size > OCC_VECTOR_INLINE ? v->data : v->inline_data;
+}
+
+void occ_vector_init_struct(occ_vector* v) {
+    memset(v, 0, sizeof(occ_vector));
+}
+
+void occ_vector_free_data(occ_vector* v) {
+    if (v->size > OCC_VECTOR_INLINE) {
+        free(v->data);
+    }
+    occ_vector_init_struct(v);
+}
+
+unsigned occ_vector_count(occ_vector* v) {
+    return v->count;
+}
+
+Clause* occ_vector_get(occ_vector* v, unsigned i) {
+    assert(i < v->count);
+    return occ_vector_elements(v)[i];
+}
+
+void occ_vector_add(occ_vector* v, Clause* c) {
+    if (v->count == OCC_VECTOR_INLINE && v->size <= OCC_VECTOR_INLINE) { // spill to the heap
+        Clause** data = malloc(sizeof(Clause*) * 2 * OCC_VECTOR_INLINE);
+        memcpy(data, v->inline_data, sizeof(Clause*) * OCC_VECTOR_INLINE);
+        v->data = data;
+        v->size = 2 * OCC_VECTOR_INLINE;
+    } else if (v->count == v->size && v->size > OCC_VECTOR_INLINE) {
+        v->size *= 2;
+        v->data = realloc(v->data, sizeof(Clause*) * v->size);
+    }
+    occ_vector_elements(v)[v->count] = c;
+    v->count += 1;
+}
+
+bool occ_vector_contains(occ_vector* v, Clause* c) {
+    Clause** elements = occ_vector_elements(v);
+    for (unsigned i = 0; i < v->count; i++) {
+        if (elements[i] == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool occ_vector_remove_unsorted(occ_vector* v, Clause* c) {
+    Clause** elements = occ_vector_elements(v);
+    for (unsigned i = 0; i < v->count; i++) {
+        if (elements[i] == c) {
+            elements[i] = elements[v->count - 1];
+            v->count--;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+//
+//  occ_vector.h
+//  cadet
+//
+//  Occurrence lists of literals. Most variables occur in only a few clauses
+//  per polarity, so the first OCC_VECTOR_INLINE clauses are stored inside the
+//  struct and the list moves to the heap only when it grows beyond that.
+//  An all-zero occ_vector is a valid empty list.
+//
+
+#ifndef occ_vector_h
+#define occ_vector_h
+
+#include <stdbool.h>
+
+struct Clause;
+typedef struct Clause Clause;
+
+#define OCC_VECTOR_INLINE 4
+
+typedef struct {
+    unsigned count;
+    unsigned size; // capacity of data; the elements are inline while size <= OCC_VECTOR_INLINE
+    union {
+        Clause* inline_data[OCC_VECTOR_INLINE];
+        Clause** data;
+    };
+} occ_vector;
+
+void occ_vector_init_struct(occ_vector*);
+void occ_vector_free_data(occ_vector*); // frees the heap storage, if any, and empties the list
+unsigned occ_vector_count(occ_vector*);
+Clause* occ_vector_get(occ_vector*, unsigned i);
+void occ_vector_add(occ_vector*, Clause*);
+bool occ_vector_contains(occ_vector*, Clause*);
+bool occ_vector_remove_unsorted(occ_vector*, Clause*);
+
+#endif /* occ_vector_h */
@@ -35,10 +35,20 @@ Options* default_options() {
     // Computational enginges
     o->cegar = true;
     o->cegar_only = false;
+    o->cegar_core_generalization = true;
+    o->portfolio_workers = 0;
+    o->portfolio_clause_sharing = true;
+    o->batch = false;
+    o->batch_workers = 4;
+    o->batch_cache_size = 256;
+    o->job_time_limit = 0.0;
+    o->batch_memory_limit = 0;
     o->use_qbf_engine_also_for_propositional_problems = false;
     o->casesplits = false;
     o->casesplits_cubes = false;
     o->random_decisions = false;
+    o->polarity = POLARITY_JEROSLOW_WANG;
+    o->decision_policy_file_name = NULL;
 
     // Examples domain
     o->examples_max_num = 0; // 0 corresponds to not doing examples at all
@@ -58,8 +68,12 @@ Options* default_options() {
     o->plaisted_greenbaum_completion = false; // pure literal detection is better
     o->qbce = false;
     o->miniscoping = false;
+    o->miniscoping_threads = 4;
     o->find_smallest_reason = true;
     o->minimize_learnt_clauses = true;
+    o->chronological_backtracking = false;
+    o->subsumption = true;
+    o->preprocess = false;
     o->delete_clauses_on_restarts = false;
     o->pure_literals = true;
     o->enhanced_pure_literals = false;
@@ -73,13 +87,18 @@ Options* default_options() {
     o->trace_learnt_clauses = false;
     o->trace_for_visualization = false;
     o->trace_for_profiling = false;
+    o->profile_file_name = NULL;
     o->reinforcement_learning = false;
     o->rl_advanced_rewards = false;
     o->rl_vsids_rewards = false;
     o->rl_slim_state = false;
     o->reinforcement_learning_mock = false;
+    o->rl_socket_path = NULL;
     o->hard_decision_limit = 0;  // 0 means no limit
+    o->time_limit = 0.0;
+    o->conflict_limit = 0;
     o->verify = 1;
+    o->validation_threads = 4;
     return o;
 }
 
@@ -103,24 +122,69 @@ char* options_get_help() {
     "\t--debugging \t\tEasy debugging configuration (default %d)\n"
     "\t--cegar\t\t\tUse CEGAR refinements in addition to clause learning\n\t\t\t\t(default %d)\n"
     "\t--cegar_only\t\tUse CEGAR strategy exclusively (default %d)\n"
+    "\t--cegar_cores\t\tGeneralize CEGAR cubes via unsat cores (default %d)\n"
     "\t--case_splits \t\tCase distinctions (default %d) \n"
     "\t--sat_by_qbf\t\tUse QBF engine also for propositional problems\n\t\t\t\t(default %d)\n"
-    "\t--miniscoping \t\tEnables miniscoping (default %d)\n"
+    "\t--miniscoping \t\tSolve independent partitions of the formula separately\n\t\t\t\t(default %d)\n"
+    "\t--miniscoping_threads [N]\tThreads for solving the partitions (default %u)\n"
     "\t--minimize \t\tConflict minimization (default %d) \n"
+    "\t--chrono \t\tChronological backtracking for long backjumps\n\t\t\t\t(default %d)\n"
+    "\t--subsumption \t\tSubsumption and strengthening at restarts (default %d)\n"
+    "\t--preprocess \t\tPreprocess 2QBF: variable elimination, equivalences,\n\t\t\t\tand blocked clauses (default %d)\n"
     "\t--pure_literals\t\tUse pure literal detection (default %d)\n"
+    "\t--polarity [jw|phase|pos|neg]\tPolarity of decisions: Jeroslow-Wang, phase\n\t\t\t\tsaving, positive, or negative (default jw)\n"
+    "\t--decision_policy [file]\tPick decision variables by a learned linear model\n\t\t\t\tor MLP instead of activity (see c2_policy.h)\n"
     "\t--fresh_seed\t\tUse a fresh random seed for every initialization of\n\t\t\t\tthe solver (default false)\n"
     "\t-l [N]\t\t\tStop after N decisions; return UNKNONW (30).\n"
+    "\t--time_limit [N]\tStop after N seconds; return UNKNOWN (30).\n"
+    "\t--conflict_limit [N]\tStop after N conflicts; return UNKNOWN (30).\n"
+    "\t--portfolio [N]\t\tRun N diversified configurations in parallel threads;\n\t\t\t\tthe first result wins (default %u)\n"
+    "\t--portfolio_sharing\tShare short learnt clauses between portfolio workers\n\t\t\t\t(default %d)\n"
+    "\t--batch\t\t\tSolve the files listed in the input (one per line);\n\t\t\t\tprint one JSON line per file (default %d)\n"
+    "\t--batch_workers [N]\tNumber of worker threads in batch mode (default %u)\n"
+    "\t--job_time_limit [N]\tSeconds per job in batch mode; 0 for none (default %.1f)\n"
+    "\t--batch_memory_limit [N]\tMegabytes for the whole process in batch mode; when\n\t\t\t\texceeded, cancels the longest running job; 0 for none\n\t\t\t\t(default %u)\n"
 //    "\t--enhanced_pure_literals\tUse enhanced pure literal detection (default %d)\n"
 //    "\t--qbce\t\t\tBlocked clause elimination (default %d)\n"
 //    "\t--pg\t\t\tPlaisted Greenbaum completion (default %d).\n"
+    ,
+    debug_verbosity,
+    o->easy_debugging,
+    o->cegar,
+    o->cegar_only,
+    o->cegar_core_generalization,
+    o->casesplits,
+    o->use_qbf_engine_also_for_propositional_problems,
+    o->miniscoping,
+    o->miniscoping_threads,
+    o->minimize_learnt_clauses,
+    o->chronological_backtracking,
+    o->subsumption,
+    o->preprocess,
+    o->pure_literals,
+    o->portfolio_workers,
+    o->portfolio_clause_sharing,
+    o->batch,
+    o->batch_workers,
+    o->job_time_limit,
+    o->batch_memory_limit
+//    o->enhanced_pure_literals,
+//    o->qbce,
+//    o->plaisted_greenbaum_completion,
+    );
+    
+    // Split in two, as ISO C only guarantees string literals of up to 4095 characters
+    sprintf(options_string + strlen(options_string),
     "\n  Output options\n"
     "\t--qdimacs_out\t\tOutput compliant with QDIMACS standard\n"
     "\t--miniscoping_info \tPrint additional info on miniscoping (default %d)\n"
     "\t--trace_learnt_clauses\tPrint (colored) learnt clauses.\n"
     "\t--trace_for_vis\t\tPrint trace of solver states at every conflict point.\n"
     "\t--trace_for_profiling\tPrint trace of learnt clauses with timestamps\n\t\t\t\tand SAT solver time consumption.\n"
+    "\t--profile [file]\tProfile the phases of the solver in cycles; export\n\t\t\t\tas JSON periodically and at the end.\n"
     "\t--print_variable_names\tReplace variable numbers by names where available\n\t\t\t\t(default %d)\n"
     "\t--dontverify\t\tDo not verify results.\n"
+    "\t--validation_threads [N]\tThreads for the SAT checks validating certificates\n\t\t\t\t(default %u)\n"
     "\n  Aiger options\n"
     "\t--aiger_controllable_inputs [string]\tSet prefix of controllable inputs in QAIGER\n\t\t\t\t(default '%s')\n"
     "  Reinforcement Learning\n"
@@ -128,26 +192,16 @@ char* options_get_help() {
     "\t--rl_advanced_rewards\tReward necessary actions (default %d)\n"
     "\t--rl_vsids_rewards\tReward actions that are similar to VSIDS (default %d)\n"
     "\t--rl_slim_state\t\tPrint rl state without statistics (default %d)\n"
+    "\t--rl_socket [path]\tReinforcement learning mode with the binary protocol\n\t\t\t\tover a Unix domain socket (see c2_rl.h)\n"
     "\t--rl_completion_reward \t\t(default %f)\n"
     "\t--rl_reward_per_decision \t\t(default %f)\n"
     "\t--rl_vsids_similarity_reward_factor \t\t(default %f)\n"
     "\t--rl_total_reward_for_necessary_conflicts \t\t(default %f)\n"
     "\t--rl_self_reward_factor \t\t(default %f)\n"
     "\n",
-    debug_verbosity,
-    o->easy_debugging,
-    o->cegar,
-    o->cegar_only,
-    o->casesplits,
-    o->use_qbf_engine_also_for_propositional_problems,
-    o->miniscoping,
-    o->minimize_learnt_clauses,
-    o->pure_literals,
-//    o->enhanced_pure_literals,
-//    o->qbce,
-//    o->plaisted_greenbaum_completion,
     o->print_detailed_miniscoping_stats,
     o->print_variable_names,
+    o->validation_threads,
     o->aiger_controllable_input_prefix,
     o->reinforcement_learning,
     o->rl_advanced_rewards,
@@ -165,6 +219,13 @@ char* options_get_help() {
 
 void options_print(Options* o) {
     V1("Decision limit: %u\n", o->hard_decision_limit);
+    V1("Time limit: %.1f\n", o->time_limit);
+    V1("Conflict limit: %u\n", o->conflict_limit);
+    V1("Validation threads: %u\n", o->validation_threads);
+    V1("Miniscoping threads: %u\n", o->miniscoping_threads);
+    if (o->decision_policy_file_name) {
+        V1("Decision policy: %s\n", o->decision_policy_file_name);
+    }
 }
 
 void options_free(Options* o) {
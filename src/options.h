@@ -19,6 +19,13 @@ typedef enum {
     QAIGER
 } function_output_format;
 
+typedef enum {
+    POLARITY_JEROSLOW_WANG, // positive phase during the first restarts, then Jeroslow-Wang
+    POLARITY_PHASE_SAVING, // last value of the variable before backtracking; falls back to Jeroslow-Wang
+    POLARITY_POSITIVE,
+    POLARITY_NEGATIVE
+} decision_polarity;
+
 typedef struct {
     float completion_reward;
     float reward_per_decision;
@@ -37,7 +44,10 @@ typedef struct {
     bool rl_vsids_rewards;
     bool rl_slim_state;
     bool reinforcement_learning_mock; // for testing reinforcement learning code
+    const char* rl_socket_path; // Unix domain socket for the binary RL protocol; NULL for the text protocol on stdin and stdout
     unsigned hard_decision_limit;
+    double time_limit; // seconds per call of c2_sat; 0 for no limit
+    unsigned conflict_limit; // conflicts per call of c2_sat; 0 for no limit
     bool verify;
     
     // Use a configuration of CADET 2 that is easier to debug than the
@@ -47,9 +57,19 @@ typedef struct {
     // Computational enginge
     bool cegar;
     bool cegar_only;
+    bool cegar_core_generalization;
+    unsigned portfolio_workers; // number of threads with diversified configurations; 0 or 1 to solve sequentially
+    bool portfolio_clause_sharing;
+    bool batch; // solve the formulas listed in the input file, one per line; print JSON lines
+    unsigned batch_workers;
+    unsigned batch_cache_size; // number of parsed formulas kept for repeated queries
+    double job_time_limit; // seconds per job in batch mode; 0 for no limit
+    unsigned batch_memory_limit; // megabytes for the whole process in batch mode, shared by all jobs; 0 for no limit
     bool use_qbf_engine_also_for_propositional_problems;
     unsigned examples_max_num;
     bool random_decisions;
+    decision_polarity polarity;
+    const char* decision_policy_file_name; // learned decision policy (see c2_policy.h); NULL for the activity heuristic
     
     // Aiger interpretations
     const char* aiger_controllable_input_prefix;
@@ -61,6 +81,7 @@ typedef struct {
     bool certify_SAT;
     const char* certificate_file_name;
     function_output_format certificate_type;
+    unsigned validation_threads; // for the SAT checks validating certificates in debug builds
     
     // Case splits
     bool casesplits;
@@ -70,8 +91,11 @@ typedef struct {
     bool plaisted_greenbaum_completion;
     bool qbce;
     bool miniscoping;
+    unsigned miniscoping_threads; // for solving the partitions of the formula
     bool find_smallest_reason;
     bool minimize_learnt_clauses;
+    bool chronological_backtracking;
+    bool subsumption;
     bool preprocess;
     bool delete_clauses_on_restarts;
     bool pure_literals;
@@ -88,6 +112,7 @@ typedef struct {
     bool trace_learnt_clauses;
     bool trace_for_visualization;
     bool trace_for_profiling;
+    const char* profile_file_name; // JSON export of the phase profile; NULL if not profiling
 } Options;
 
 Options* default_options();
@@ -36,6 +36,7 @@
 
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 
 inline static void skip_space(char* buffer, size_t* pos) {
@@ -46,10 +47,11 @@ inline static void skip_space(char* buffer, size_t* pos) {
 
 static inline int create_lit(int var, bool negated) { return negated ? -var : var; }
 
-inline static int get_next_lit(char* buffer, size_t* pos, int line_num) {
+// Returns false if the buffer does not continue with a literal.
+inline static bool get_next_lit(char* buffer, size_t* pos, int line_num, int* lit) {
     if (!(buffer[*pos] == '-' || (buffer[*pos] >= '0' && buffer[*pos] <= '9'))) {
         V1("Unexpected character: %c (ascii: %d) in line %d char %zu\n",buffer[*pos],buffer[*pos],line_num,*pos);
-        assert(false);
+        return false;
     }
     bool negated = (buffer[*pos] == '-');
     if (negated) {
@@ -58,24 +60,34 @@ inline static int get_next_lit(char* buffer, size_t* pos, int line_num) {
     int var = 0;
     if (!(buffer[*pos] >= '0' && buffer[*pos] <= '9')) {
         V1("Unexpected digit: %c (ascii: %d) in line %d char %zu\n",buffer[*pos],buffer[*pos],line_num,*pos);
-        abort();
+        return false;
     }
     while (buffer[*pos] >= '0' && buffer[*pos] <= '9') {
+        if (var > (INT_MAX - 9) / 10) {
+            V1("Variable too large in line %d char %zu\n", line_num, *pos);
+            return false;
+        }
         var = (var * 10) + (buffer[*pos] - '0');
         (*pos)++;
     }
-    return create_lit(var, negated);
+    *lit = create_lit(var, negated);
+    return true;
 }
 
 // Has to be called with line being the header from the QDIMACS file.
-C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int line_num) {
+// Returns NULL and sets error if the file is malformed.
+C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int line_num, const char** error) {
     assert(header != NULL);
-    C2* c2 = c2_init(options);
     
     // Parse number of variables and number of clauses.
     size_t var_num;
     size_t clause_num;
-    sscanf(header, "p cnf %zd %zd", &var_num, &clause_num);
+    if (sscanf(header, "p cnf %zu %zu", &var_num, &clause_num) != 2 || var_num > INT_MAX / 64) {
+        V1("Malformed header in line %d\n", line_num);
+        *error = "malformed header";
+        return NULL;
+    }
+    C2* c2 = c2_init(options);
     int log_of_var_num = 0;
     size_t var_num_copy = var_num;
     while (var_num_copy >>= 1) log_of_var_num++;
@@ -141,13 +153,18 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
         
         while (line[pos] != '\n' && line[pos] != '\r' && line[pos] != '\0') {
             skip_space(line, &pos);
-            int next_lit = get_next_lit(line, &pos, line_num);
+            int next_lit = 0;
+            if (! get_next_lit(line, &pos, line_num, &next_lit)) {
+                *error = "malformed quantifier";
+                goto parse_error;
+            }
             if (next_lit == 0) {
                 break;
             }
             if (next_lit < 0) {
-                V0("Error: Quantifier introduces negative number as a variable name (line %d). Abort.\n", line_num);
-                abort();
+                V1("Error: Quantifier introduces negative number as a variable name (line %d).\n", line_num);
+                *error = "negative variable in quantifier";
+                goto parse_error;
             }
             
             if (is_dependency_quantifier) {
@@ -155,8 +172,9 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
                     int_vector_add(dependency_variables, next_lit);
                 } else {
                     if (!qcnf_var_exists(c2->qcnf, (unsigned) next_lit)) {
-                        V0("Error: Variable %d in line %d must be introduced as universal variable before it occurs in the scope of a dependency quantifier.\n",next_lit,line_num);
-                        abort();
+                        V1("Error: Variable %d in line %d must be introduced as universal variable before it occurs in the scope of a dependency quantifier.\n",next_lit,line_num);
+                        *error = "unknown variable in dependency set";
+                        goto parse_error;
                     }
                     int_vector_add(vector_get(dependency_sets, vector_count(dependency_sets) - 1), next_lit);
                 }
@@ -164,8 +182,9 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
                 bool is_universal = qlvl % 2 == 1;
                 
                 if (qcnf_var_exists(c2->qcnf, (unsigned) next_lit)) {
-                    V0("Error: line %d contains duplicate variable %d.\n", line_num, next_lit);
-                    abort();
+                    V1("Error: line %d contains duplicate variable %d.\n", line_num, next_lit);
+                    *error = "duplicate variable in quantifier";
+                    goto parse_error;
                 }
                 c2_new_variable(c2, is_universal, qlvl / 2 + (is_universal ? 1 : 0), (unsigned) next_lit);
             }
@@ -183,11 +202,11 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
             for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
                 Var* v = var_vector_get(c2->qcnf->vars, i);
                 if (v->var_id && v->is_universal) {
-                    abortif(vector_count(&v->pos_occs) || vector_count(&v->neg_occs), "Universal variables shouldn't have any occurrences in a propositional problem.");
+                    abortif(occ_vector_count(&v->pos_occs) || occ_vector_count(&v->neg_occs), "Universal variables shouldn't have any occurrences in a propositional problem.");
                     v->var_id = 0;
                     v->is_universal = 0;
-                    free(v->pos_occs.data);
-                    free(v->neg_occs.data);
+                    occ_vector_free_data(&v->pos_occs);
+                    occ_vector_free_data(&v->neg_occs);
                 }
             }
         }
@@ -208,6 +227,11 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
             c2_new_variable(c2, false, dependency_scope_id, dep_var_id);
         }
     }
+    // The dependency sets are now owned by the scopes.
+    vector_free(dependency_sets);
+    int_vector_free(dependency_variables);
+    dependency_sets = NULL;
+    dependency_variables = NULL;
 
     if (debug_verbosity >= VERBOSITY_ALL) {
         V4("Detected the following quantifier hierarchy:\n");
@@ -228,8 +252,16 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
         }
         while (line[pos] != '\n' && line[pos] != '\r' && line[pos] != '\0') {
             skip_space(line, &pos);
-            int next_lit = get_next_lit(line, &pos, line_num);
-            abortif(pos >= (size_t)len, "Clause was way too long. Cannot parse.\n");
+            int next_lit = 0;
+            if (! get_next_lit(line, &pos, line_num, &next_lit)) {
+                *error = "malformed clause";
+                goto parse_error;
+            }
+            if (pos >= (size_t) len) {
+                V1("Clause in line %d was way too long. Cannot parse.\n", line_num);
+                *error = "clause too long";
+                goto parse_error;
+            }
             if (next_lit != 0 && !qcnf_var_exists(c2->qcnf, lit_to_var(next_lit))) {
                 c2_new_variable(c2, 0, 0, lit_to_var(next_lit));
             }
@@ -237,9 +269,27 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
             skip_space(line, &pos);
         }
     } while (fgets(line, len, file));
-    abortif(int_vector_count(c2->qcnf->new_clause) != 0, "Last clause was not closed by 0.");
+    if (int_vector_count(c2->qcnf->new_clause) != 0) {
+        V1("Last clause was not closed by 0.\n");
+        *error = "last clause not closed by 0";
+        free(line);
+        c2_free(c2);
+        return NULL;
+    }
     free(line);
     return c2;
+
+parse_error:
+    if (dependency_sets) {
+        for (unsigned i = 0; i < vector_count(dependency_sets); i++) {
+            int_vector_free(vector_get(dependency_sets, i));
+        }
+        vector_free(dependency_sets);
+        int_vector_free(dependency_variables);
+    }
+    free(line);
+    c2_free(c2);
+    return NULL;
 }
 
 
@@ -496,43 +546,72 @@ C2* c2_from_qaiger(aiger* aig, Options* options) {
     return c2;
 }
 
-C2* c2_from_file(FILE* file, Options* options) {
-    if (!options) {options = default_options();}
+C2* c2_parse_file(FILE* file, Options* options, bool* is_aiger, const char** error) {
+    assert(options);
+    *is_aiger = false;
+    *error = NULL;
     int len = 1000; // max 1kb for the first line
     char *line = malloc((size_t)len);
+    C2* solver = NULL;
     
-    abortif(!cautious_readline(line, len, file), "Could not read first line");
+    if (!cautious_readline(line, len, file)) {
+        *error = "could not read first line";
+        goto done;
+    }
     
     int line_num = 1;
     
     // Skip comment lines
     while (line[0] == 'c') {
         line_num++;
-        abortif(!cautious_readline(line, len, file), "Expected header after comments ending in line %d", line_num);
+        if (!cautious_readline(line, len, file)) {
+            V1("Expected header after comments ending in line %d\n", line_num);
+            *error = "missing header";
+            goto done;
+        }
     }
     
     char* qcnf_header_start = "p cnf ";
     char* aiger_header_start = "aig ";
     char* aiger_ascii_header_start = "aag ";
-    C2* solver = NULL;
     if (strncmp(qcnf_header_start, line, strlen(qcnf_header_start)) == 0) {
-        solver = c2_from_qdimacs_and_header(options, file, line, line_num);
+        solver = c2_from_qdimacs_and_header(options, file, line, line_num, error);
     } else if (   strncmp(aiger_header_start, line, strlen(aiger_header_start)) == 0
                || strncmp(aiger_ascii_header_start, line, strlen(aiger_ascii_header_start)) == 0) {
-        
+        *is_aiger = true;
+        if (file == stdin) {
+            *error = "AIGER input currently does not work from stdin";
+            goto done;
+        }
         aiger* aig = aiger_init();
-        abortif(file == stdin, "AIGER input currently coes not work from stdin.");
         fseek(file, 0, SEEK_SET);
         const char* err = aiger_read_from_file(aig, file);
-        
-        abortif(err, "Error while reading aiger file:\n %s", err);
-        
-        solver = c2_from_qaiger(aig, options);
-        options->certificate_type = QAIGER;
+        if (err) {
+            V1("Error while reading aiger file:\n %s\n", err);
+            *error = "malformed aiger file";
+        } else {
+            solver = c2_from_qaiger(aig, options);
+        }
+        aiger_reset(aig);
     } else {
-        abortif(true, "Cannot identify header of the file. Wrong file format? Some line must start with 'p cnf', 'aig', or 'aag'.");
+        V1("Cannot identify header of the file. Some line must start with 'p cnf', 'aig', or 'aag'.\n");
+        *error = "unknown file format";
     }
     
+done:
     free(line);
+    assert((solver == NULL) == (*error != NULL));
+    return solver;
+}
+
+C2* c2_from_file(FILE* file, Options* options) {
+    if (!options) {options = default_options();}
+    bool is_aiger = false;
+    const char* error = NULL;
+    C2* solver = c2_parse_file(file, options, &is_aiger, &error);
+    abortif(!solver, "Could not parse file: %s", error);
+    if (is_aiger) {
+        options->certificate_type = QAIGER;
+    }
     return solver;
 }
@@ -122,9 +122,9 @@ Lit partial_assignment_is_clause_satisfied(PartialAssignment* pa, Clause* c) {
 
 void update_clause_worklist(PartialAssignment* pa, QCNF* qcnf, int unassigned_lit) {
     Var* v = var_vector_get(qcnf->vars, lit_to_var(unassigned_lit));
-    vector* occs = unassigned_lit > 0 ? &v->neg_occs : &v->pos_occs;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        worklist_push(pa->clauses_to_check, vector_get(occs, i));
+    occ_vector* occs = unassigned_lit > 0 ? &v->neg_occs : &v->pos_occs;
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        worklist_push(pa->clauses_to_check, occ_vector_get(occs, i));
     }
 }
 
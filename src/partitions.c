@@ -22,10 +22,53 @@ unsigned c2_analysis_follow_partition_numbers(int_vector* partition_numbers, uns
     return pn;
 }
 
-void c2_analysis_determine_number_of_partitions(C2* c2) {
+// Universals and the existentials that are deterministic on dlvl0 are shared by all partitions. An existential
+// is only shared if its function is forced by the clauses: pure variables are excluded, and so is every variable
+// that occurs in a clause together with an existential that is not shared. Then all clauses containing shared
+// existentials belong to every partition, and the Skolem functions of all partitions agree on the shared variables.
+static int_vector* c2_analysis_shared_variables(C2* c2) {
+    int_vector* shared = int_vector_init();
+    for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
+        bool is_shared = false;
+        if (qcnf_var_exists(c2->qcnf, i)) {
+            skolem_var sv = skolem_get_info(c2->skolem, i);
+            is_shared = qcnf_is_universal(c2->qcnf, i) || (skolem_is_deterministic(c2->skolem, i) && ! sv.pure_pos && ! sv.pure_neg);
+        }
+        int_vector_add(shared, is_shared);
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
+            Clause* c = vector_get(c2->qcnf->all_clauses, i);
+            if (! c->original || ! c->active) {
+                continue;
+            }
+            bool has_unshared = false;
+            for (unsigned j = 0; j < c->size && ! has_unshared; j++) {
+                has_unshared = ! int_vector_get(shared, lit_to_var(c->occs[j]));
+            }
+            if (has_unshared) {
+                for (unsigned j = 0; j < c->size; j++) {
+                    unsigned var_id = lit_to_var(c->occs[j]);
+                    if (int_vector_get(shared, var_id) && qcnf_is_existential(c2->qcnf, var_id)) {
+                        int_vector_set(shared, var_id, false);
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return shared;
+}
+
+// Returns the partition number of each variable: 0 for shared variables (see above), otherwise 1 to number_of_partitions.
+// Only the active original clauses are considered.
+int_vector* c2_analysis_determine_partitions(C2* c2, unsigned* number_of_partitions_out) {
+    int_vector* shared = c2_analysis_shared_variables(c2);
     int_vector* partition_numbers = int_vector_init();
     for (unsigned i = 0; i < var_vector_count(c2->qcnf->vars); i++) {
-        if (i > 0 && ! skolem_is_deterministic(c2->skolem, i)) {
+        if (qcnf_var_exists(c2->qcnf, i) && ! int_vector_get(shared, i)) {
             int_vector_add(partition_numbers, (int) i);
         } else {
             int_vector_add(partition_numbers, (int) 0);
@@ -36,29 +79,29 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
     // Connect all vars to the minimal pn in each clause.
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c->original && c->active) {
+            // find the minimal root of the partitions of the variables in the clause
             unsigned minimal_pn = UINT_MAX;
             for (unsigned j = 0; j < c->size; j++) {
                 unsigned var_id = lit_to_var(c->occs[j]);
-                unsigned pn = (unsigned) int_vector_get(partition_numbers, var_id);
-                if (pn != 0 && pn < minimal_pn) {
-                    minimal_pn = pn;
+                if (int_vector_get(partition_numbers, var_id) != 0) {
+                    unsigned root = c2_analysis_follow_partition_numbers(partition_numbers, var_id, 0);
+                    if (root < minimal_pn) {
+                        minimal_pn = root;
+                    }
                 }
             }
             
             // set pn for all literals in the clause (all that are not excluded)
             if (minimal_pn != UINT_MAX) {
-                // follow minimal_pn to minimize further, not strictly required
-                minimal_pn = c2_analysis_follow_partition_numbers(partition_numbers,minimal_pn,0);
-                
                 for (unsigned j = 0; j < c->size; j++) {
                     unsigned var_id = lit_to_var(c->occs[j]);
-                    unsigned pn = (unsigned) int_vector_get(partition_numbers, var_id);
-                    if (pn != 0) {
-                        assert(! skolem_is_deterministic(c2->skolem, var_id));
-                        // connect partition of var_id to minimal_pn
-                        int_vector_set(partition_numbers, pn, (int) minimal_pn);
-                        // optional, but also set partition of var_id explicitly to minimal_pn (was pointing to pn)
+                    if (int_vector_get(partition_numbers, var_id) != 0) {
+                        assert(! int_vector_get(shared, var_id));
+                        // connect the root of the partition of var_id to minimal_pn; roots only point to smaller roots
+                        unsigned root = c2_analysis_follow_partition_numbers(partition_numbers, var_id, 0);
+                        int_vector_set(partition_numbers, root, (int) minimal_pn);
+                        // optional, but also set partition of var_id explicitly to minimal_pn
                         int_vector_set(partition_numbers, var_id, (int) minimal_pn);
                     }
                 }
@@ -90,7 +133,7 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
 #ifdef DEBUG
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c->original && c->active) {
             unsigned clause_pn = 0;
             for (unsigned j = 0; j < c->size; j++) {
                 unsigned var_id = lit_to_var(c->occs[j]);
@@ -116,8 +159,8 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
     }
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
-            bool contains_deterministic = false;
+        if (c->original && c->active) {
+            bool contains_shared = false;
             unsigned clause_partition_number = 0;
             for (unsigned j = 0; j < c->size; j++) {
                 unsigned var_id = lit_to_var(c->occs[j]);
@@ -127,18 +170,18 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
                 } else {
                     assert(pn == 0 || pn == clause_partition_number);
                 }
-                if (!contains_deterministic && skolem_is_deterministic(c2->skolem, var_id)) {
-                    contains_deterministic = true;
+                if (!contains_shared && int_vector_get(shared, var_id)) {
+                    contains_shared = true;
                 }
             }
             
             if (clause_partition_number != 0) {
                 int old_num = int_vector_get(clauses_per_partition, clause_partition_number - 1);
                 int_vector_set(clauses_per_partition, clause_partition_number - 1, old_num + 1);
-                if (contains_deterministic) {
+                if (contains_shared) {
                     for (unsigned j = 0; j < c->size; j++) {
                         unsigned var_id = lit_to_var(c->occs[j]);
-                        if (skolem_is_deterministic(c2->skolem, var_id)) {
+                        if (int_vector_get(shared, var_id)) {
                             int_vector_add((int_vector*) vector_get(interface_vars_per_partition, clause_partition_number - 1), (int) var_id);
                         }
                     }
@@ -186,5 +229,7 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
         int_vector_free(vector_get(interface_vars_per_partition, i));
     }
     vector_free(interface_vars_per_partition);
-    int_vector_free(partition_numbers);
+    int_vector_free(shared);
+    *number_of_partitions_out = number_of_partitions;
+    return partition_numbers;
 }
@@ -0,0 +1,105 @@
+//
+//  profiler.c
+//  cadet
+//
+
+#include "profiler.h"
+#include "util.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* profiler_phase_names[PROFILER_PHASES_NUM] = {
+    "constant_propagation",
+    "determinicity_check",
+    "local_conflict_check",
+    "global_conflict_check",
+    "conflict_analysis",
+    "minimization",
+    "cegar_round",
+    "case_split_probe",
+    "examples_propagation",
+    "certificate"
+};
+
+Profiler* profiler_init(const char* file_name) {
+    Profiler* p = malloc(sizeof(Profiler));
+    for (unsigned i = 0; i < PROFILER_PHASES_NUM; i++) {
+        p->phases[i] = statistics_init(1.0);
+        p->phase_start[i] = 0;
+    }
+    p->file_name = file_name;
+    p->start_time = get_seconds();
+    p->start_cycles = profiler_cycles();
+    p->last_export_time = p->start_time;
+    p->export_interval = 10.0;
+    return p;
+}
+
+void profiler_free(Profiler* p) {
+    for (unsigned i = 0; i < PROFILER_PHASES_NUM; i++) {
+        statistics_free(p->phases[i]);
+    }
+    free(p);
+}
+
+void profiler_print(Profiler* p) {
+    V0("  Profile (cycles):\n");
+    for (unsigned i = 0; i < PROFILER_PHASES_NUM; i++) {
+        Stats* s = p->phases[i];
+        if (s->calls_num == 0) {
+            continue;
+        }
+        V0("    %-24s %10zu calls, %14.0f total, %10.0f avg, %12.0f max\n",
+           profiler_phase_names[i], s->calls_num, s->accumulated_value, s->accumulated_value / (double) s->calls_num, s->max);
+    }
+}
+
+static void profiler_write_json(Profiler* p, FILE* f) {
+    double seconds = get_seconds() - p->start_time;
+    double cycles = (double) (profiler_cycles() - p->start_cycles);
+    fprintf(f, "{\n  \"seconds\": %.3f,\n  \"cycles\": %.0f,\n", seconds, cycles);
+    fprintf(f, "  \"histogram_buckets\": \"bucket i counts calls of at most 2^i cycles\",\n");
+    fprintf(f, "  \"phases\": {");
+    for (unsigned i = 0; i < PROFILER_PHASES_NUM; i++) {
+        Stats* s = p->phases[i];
+        fprintf(f, "%s\n    \"%s\": {\"count\": %zu, \"cycles\": %.0f, \"min\": %.0f, \"max\": %.0f, \"histogram\": [",
+                i == 0 ? "" : ",", profiler_phase_names[i], s->calls_num, s->accumulated_value, s->min, s->max);
+        for (unsigned j = 0; j < int_vector_count(s->exponential_histogram); j++) {
+            fprintf(f, "%s%d", j == 0 ? "" : ", ", int_vector_get(s->exponential_histogram, j));
+        }
+        fprintf(f, "]}");
+    }
+    fprintf(f, "\n  }\n}\n");
+}
+
+void profiler_export(Profiler* p) {
+    p->last_export_time = get_seconds();
+    if (p->file_name == NULL) {
+        return;
+    }
+    // Readers never see a partial document
+    size_t len = strlen(p->file_name) + 5;
+    char* tmp_name = malloc(len);
+    snprintf(tmp_name, len, "%s.tmp", p->file_name);
+    FILE* f = fopen(tmp_name, "w");
+    if (f == NULL) {
+        LOG_WARNING("Cannot write profile to \"%s\".", tmp_name);
+        free(tmp_name);
+        return;
+    }
+    profiler_write_json(p, f);
+    fclose(f);
+    if (rename(tmp_name, p->file_name) != 0) {
+        LOG_WARNING("Cannot write profile to \"%s\".", p->file_name);
+    }
+    free(tmp_name);
+}
+
+void profiler_export_periodically(Profiler* p) {
+    if (get_seconds() - p->last_export_time >= p->export_interval) {
+        profiler_export(p);
+    }
+}
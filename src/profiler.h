@@ -0,0 +1,83 @@
+//
+//  profiler.h
+//  cadet
+//
+//  Cycle-accurate profile of the main phases of the solver. Each phase keeps
+//  its count and a log-bucketed latency histogram (see statistics.h). The
+//  profile is printed with the statistics and exported as a JSON document.
+//
+//  Profiling is always compiled in; a NULL profiler disables it, so the hot
+//  paths only pay for a branch.
+//
+
+#ifndef profiler_h
+#define profiler_h
+
+#include "statistics.h"
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef enum {
+    PROFILER_CONSTANT_PROPAGATION,
+    PROFILER_DETERMINICITY_CHECK,
+    PROFILER_LOCAL_CONFLICT_CHECK,
+    PROFILER_GLOBAL_CONFLICT_CHECK,
+    PROFILER_CONFLICT_ANALYSIS,
+    PROFILER_MINIMIZATION,
+    PROFILER_CEGAR_ROUND,
+    PROFILER_CASE_SPLIT_PROBE,
+    PROFILER_EXAMPLES_PROPAGATION,
+    PROFILER_CERTIFICATE,
+    PROFILER_PHASES_NUM
+} profiler_phase;
+
+typedef struct {
+    Stats* phases[PROFILER_PHASES_NUM]; // values are cycles
+    uint64_t phase_start[PROFILER_PHASES_NUM];
+    const char* file_name; // JSON export; NULL if none
+    double start_time;
+    uint64_t start_cycles;
+    double last_export_time;
+    double export_interval; // seconds between periodic exports
+} Profiler;
+
+Profiler* profiler_init(const char* file_name);
+void profiler_free(Profiler*);
+
+// Time stamp counter where available, nanoseconds otherwise
+static inline uint64_t profiler_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// Phases must not be nested into themselves.
+static inline void profiler_begin(Profiler* p, profiler_phase phase) {
+    if (p) {
+        p->phase_start[phase] = profiler_cycles();
+    }
+}
+
+static inline void profiler_end(Profiler* p, profiler_phase phase) {
+    if (p) {
+        uint64_t cycles = profiler_cycles() - p->phase_start[phase];
+        statistic_add_value(p->phases[phase], (double) (cycles > 0 ? cycles : 1));
+    }
+}
+
+void profiler_print(Profiler*);
+// Writes the JSON document to the file; replaces previous exports atomically.
+void profiler_export(Profiler*);
+// Exports only if the export interval has passed since the last export.
+void profiler_export_periodically(Profiler*);
+
+#endif /* profiler_h */
@@ -98,9 +98,9 @@ bool qcnf_is_duplicate(QCNF* qcnf, Clause* c) {
     }
     Lit first = c->occs[0];
     Var* v = var_vector_get(qcnf->vars, lit_to_var(first));
-    vector* occs = first > 0 ? &v->pos_occs : &v->neg_occs;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* other = vector_get(occs, i);
+    occ_vector* occs = first > 0 ? &v->pos_occs : &v->neg_occs;
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* other = occ_vector_get(occs, i);
         if (c != other && c->size == other->size) {
             bool all_equal = true;
             for (unsigned j = 0; j < c->size; j++) {
@@ -134,12 +134,43 @@ bool qcnf_is_original(QCNF* qcnf, unsigned var_id) {
     return v->original;
 }
 
-vector* qcnf_get_occs_of_lit(QCNF* qcnf, Lit lit) {
+occ_vector* qcnf_get_occs_of_lit(QCNF* qcnf, Lit lit) {
     assert(lit != 0);
     Var* v = var_vector_get(qcnf->vars, lit_to_var(lit));
     return lit > 0 ? &v->pos_occs : &v->neg_occs;
 }
 
+// JEROSLOW-WANG WEIGHTS
+
+unsigned qcnf_lit_weight_idx(Lit lit) {
+    return 2 * lit_to_var(lit) + (lit < 0 ? 1 : 0);
+}
+
+// The weight of a literal is the sum over its clauses of 2^-size for short clauses plus a small constant
+// per occurrence. The short clause part is kept as an integer in units of 2^-JW_MAX_SHORT_CLAUSE_SIZE, so
+// that the incremental updates are exact; the constant part is the size of the occurrence list.
+#define JW_MAX_SHORT_CLAUSE_SIZE 10
+#define JW_OCCURRENCE_WEIGHT 0.05
+
+void qcnf_update_Jeroslow_Wang_weights(QCNF* qcnf, Clause* c, int factor) {
+    if (c->size > JW_MAX_SHORT_CLAUSE_SIZE) {
+        return;
+    }
+    int clause_weight = factor * (1 << (JW_MAX_SHORT_CLAUSE_SIZE - c->size));
+    for (unsigned i = 0; i < c->size; i++) {
+        unsigned idx = qcnf_lit_weight_idx(c->occs[i]);
+        int weight = int_vector_get(qcnf->lit_weights, idx) + clause_weight;
+        assert(weight >= 0);
+        int_vector_set(qcnf->lit_weights, idx, weight);
+    }
+}
+
+double qcnf_get_Jeroslow_Wang_weight(QCNF* qcnf, Lit lit) {
+    assert(qcnf_var_exists(qcnf, lit_to_var(lit)));
+    double short_clauses = (double) int_vector_get(qcnf->lit_weights, qcnf_lit_weight_idx(lit)) / (double) (1 << JW_MAX_SHORT_CLAUSE_SIZE);
+    return short_clauses + JW_OCCURRENCE_WEIGHT * (double) occ_vector_count(qcnf_get_occs_of_lit(qcnf, lit));
+}
+
 // DOMAINS
 
 unsigned qcnf_scope_init(QCNF* qcnf, int_vector* vars) {
@@ -194,7 +225,7 @@ int qcnf_compare_clauses_by_size (const void * a, const void * b) {
 int qcnf_compare_variables_by_occ_num (const void * a, const void * b) {
     Var* v1 = (Var*) a;
     Var* v2 = (Var*) b;
-    return ((int)vector_count(&v1->pos_occs) + (int)vector_count(&v1->neg_occs)) - ((int)vector_count(&v2->pos_occs) + (int)vector_count(&v2->neg_occs));
+    return ((int)occ_vector_count(&v1->pos_occs) + (int)occ_vector_count(&v1->neg_occs)) - ((int)occ_vector_count(&v2->pos_occs) + (int)occ_vector_count(&v2->neg_occs));
 }
 
 int qcnf_compare_literal_pointers_by_var_id(const void * a, const void * b) {
@@ -206,8 +237,6 @@ int qcnf_compare_literals_by_var_id(const void * a, const void * b) {
     return ( abs((int)a) - abs((int)b) );
 }
 
-QCNF* static_qcnf_variable_for_sorting = NULL; // TODO: this prevents C2 from being concurrent
-
 int qcnf_compare_scope_ids(QCNF* qcnf, unsigned scope_id1, unsigned scope_id2) {
     if (!qcnf_is_DQBF(qcnf)) {
         return (int) scope_id1 - (int) scope_id2;
@@ -235,9 +264,29 @@ int qcnf_compare_occurrence_by_qtype_then_scope_size_then_var_id(QCNF* qcnf, con
     }
     return (int)v1->var_id - (int)v2->var_id;
 }
-// this version does not need qcnf as an argument but uses the (hacky) static variable "static_qcnf_variable_for_sorting"
-int qcnf_compare_occurrence_by_qtype_then_scope_size_then_var_id__static_qcnf(const void * a, const void * b) {
-    return qcnf_compare_occurrence_by_qtype_then_scope_size_then_var_id(static_qcnf_variable_for_sorting, a, b);
+
+// Sort key that orders literals like qcnf_compare_occurrence_by_qtype_then_scope_size_then_var_id:
+// existentials flag in the highest bit, then the scope rank, the var_id, and the sign in the lowest bit.
+// Lets qsort work without access to the qcnf.
+uint64_t qcnf_occurrence_sort_key(QCNF* qcnf, Lit lit) {
+    Var* v = var_vector_get(qcnf->vars, lit_to_var(lit));
+    uint64_t scope_rank = 0;
+    if (! v->is_universal) {
+        if (qcnf_is_DQBF(qcnf)) {
+            Scope* d = vector_get(qcnf->scopes, v->scope_id);
+            scope_rank = int_vector_count(d->vars);
+        } else {
+            scope_rank = v->scope_id;
+        }
+    }
+    assert(scope_rank < (1ull << 30));
+    return ((uint64_t) ! v->is_universal << 63) | (scope_rank << 33) | ((uint64_t) v->var_id << 1) | (lit < 0 ? 1 : 0);
+}
+
+int qcnf_compare_sort_keys(const void * a, const void * b) {
+    uint64_t k1 = *(uint64_t*) a;
+    uint64_t k2 = *(uint64_t*) b;
+    return k1 < k2 ? -1 : (k1 > k2 ? 1 : 0);
 }
 
 QCNF* qcnf_init() {
@@ -263,6 +312,10 @@ QCNF* qcnf_init() {
     
     qcnf->variable_names = vector_init();
     
+    qcnf->lit_weights = int_vector_init();
+    int_vector_add(qcnf->lit_weights, 0); // for var_id 0
+    int_vector_add(qcnf->lit_weights, 0);
+    
     // Statistics
     qcnf->universal_reductions = 0;
     qcnf->deleted_clauses = 0;
@@ -345,8 +398,14 @@ Var* qcnf_new_var(QCNF* qcnf, bool is_universal, unsigned scope_id, unsigned var
     var->original = true;
     var->scope_id = (unsigned short) scope_id;
     var->is_universal = is_universal;
-    vector_init_struct(&var->pos_occs);
-    vector_init_struct(&var->neg_occs);
+    occ_vector_init_struct(&var->pos_occs);
+    occ_vector_init_struct(&var->neg_occs);
+    
+    while (int_vector_count(qcnf->lit_weights) <= 2 * var_id + 1) {
+        int_vector_add(qcnf->lit_weights, 0);
+    }
+    int_vector_set(qcnf->lit_weights, 2 * var_id,     0);
+    int_vector_set(qcnf->lit_weights, 2 * var_id + 1, 0);
     
     stack_push_op(qcnf->stack, QCNF_OP_NEW_VAR, (void*) (size_t) var->var_id);
     
@@ -357,8 +416,17 @@ bool qcnf_var_exists(QCNF* qcnf, unsigned var_id) {
     return var_id < var_vector_count(qcnf->vars) && var_vector_get(qcnf->vars, var_id)->var_id != 0;
 }
 
-void qcnf_universal_reduction(QCNF* qcnf, Clause* clause) {
-    if (!qcnf_is_DQBF(qcnf)) {
+// Replaces an active clause by a copy without its reducible universal literals and returns the copy.
+// Returns the clause itself if nothing can be reduced, and NULL if the reduced clause is a duplicate.
+// Clauses with only universals are left untouched; they are handled by the solver.
+Clause* qcnf_universal_reduction(QCNF* qcnf, Clause* clause) {
+    assert(clause->active);
+    int_vector* reducible = int_vector_init();
+    bool has_existential = false;
+    for (unsigned i = 0; i < clause->size; i++) {
+        has_existential = has_existential || qcnf_is_existential(qcnf, lit_to_var(clause->occs[i]));
+    }
+    if (has_existential && !qcnf_is_DQBF(qcnf)) {
         unsigned max_scope = 0;
         for (unsigned i = 0; i < clause->size; i++) {
             Lit lit = clause->occs[i];
@@ -371,48 +439,53 @@ void qcnf_universal_reduction(QCNF* qcnf, Clause* clause) {
             Lit lit = clause->occs[i];
             Var* v = var_vector_get(qcnf->vars, lit_to_var(lit));
             if (v->is_universal && v->scope_id > max_scope) {
-                qcnf->universal_reductions += 1;
-                // delete lit from this clause
-                for (unsigned j = i; j + 1 < clause->size; j++) {
-                    clause->occs[j] = clause->occs[j+1];
-                }
-                clause->size -= 1;
-                i -= 1;
+                int_vector_add(reducible, lit);
             }
         }
-    } else {
+    } else if (has_existential) {
         // delete universals that are in nobody's dependency set
-        for (unsigned i = 0; i < clause->size; i++) { // delete trailing universal variables
+        for (unsigned i = 0; i < clause->size; i++) {
             Lit lit = clause->occs[i];
             Var* v = var_vector_get(qcnf->vars, lit_to_var(lit));
-            if (v->is_universal) {
-                bool found_v_in_dependency_sets = false;
-                for (int j = clause->size - 1; j >= 0; j--) { // delete trailing universal variables
-                    Lit existential_lit = clause->occs[j];
-                    Var* existential_v = var_vector_get(qcnf->vars, lit_to_var(existential_lit));
-                    if ( ! existential_v->is_universal) {
-                        Scope* d = vector_get(qcnf->scopes, existential_v->scope_id);
-                        if (int_vector_contains_sorted(d->vars, (int) v->var_id)) {
-                            found_v_in_dependency_sets = true;
-                            break;
-                        }
-                    } else {
+            if (! v->is_universal) {
+                continue;
+            }
+            bool found_v_in_dependency_sets = false;
+            for (unsigned j = 0; j < clause->size; j++) {
+                Var* existential_v = var_vector_get(qcnf->vars, lit_to_var(clause->occs[j]));
+                if ( ! existential_v->is_universal) {
+                    Scope* d = vector_get(qcnf->scopes, existential_v->scope_id);
+                    if (int_vector_contains_sorted(d->vars, (int) v->var_id)) {
+                        found_v_in_dependency_sets = true;
                         break;
                     }
                 }
-                if (! found_v_in_dependency_sets) {
-                    V4("Universal reduction: literal %d is in nobody's dependency set.\n",v->var_id);
-                    for (unsigned k = i; k + 1 < clause->size; k++) {
-                        clause->occs[k] = clause->occs[k+1];
-                    }
-                    clause->size--;
-                    i--;
-                }
-            } else {
-                break;
             }
+            if (! found_v_in_dependency_sets) {
+                V4("Universal reduction: literal %d is in nobody's dependency set.\n",v->var_id);
+                int_vector_add(reducible, lit);
+            }
+        }
+    }
+    
+    if (int_vector_count(reducible) == 0) {
+        int_vector_free(reducible);
+        return clause;
+    }
+    
+    qcnf->universal_reductions += int_vector_count(reducible);
+    qcnf_unregister_clause(qcnf, clause);
+    for (unsigned i = 0; i < clause->size; i++) {
+        if (! int_vector_contains(reducible, clause->occs[i])) {
+            qcnf_add_lit(qcnf, clause->occs[i]);
         }
     }
+    int_vector_free(reducible);
+    Clause* reduced = qcnf_close_clause(qcnf);
+    if (reduced) {
+        reduced->original = clause->original;
+    }
+    return reduced;
 }
 
 Clause* qcnf_new_clause(QCNF* qcnf, int_vector* literals) {
@@ -460,14 +533,17 @@ Clause* qcnf_new_clause(QCNF* qcnf, int_vector* literals) {
         V4("clause %u, lit is %d\n", c->clause_idx, lit);
     }
     
-    // Sort literals in variable ... sorry for the awkward use of global variables to simulate partial function evaluation
-    abortif(static_qcnf_variable_for_sorting != NULL, "Memory curruption or concurrent usage of static variable static_qcnf_variable_for_sorting.");
-    static_qcnf_variable_for_sorting = qcnf; // sorry for this hack; need to reference qcnf from within the sorting procedure
-    qsort(c->occs,
-          c->size,
-          sizeof(int),
-          qcnf_compare_occurrence_by_qtype_then_scope_size_then_var_id__static_qcnf);
-    static_qcnf_variable_for_sorting = NULL;
+    // Sort literals by quantifier type, scope, and var_id
+    uint64_t* keys = malloc(sizeof(uint64_t) * c->size);
+    for (unsigned i = 0; i < c->size; i++) {
+        keys[i] = qcnf_occurrence_sort_key(qcnf, c->occs[i]);
+    }
+    qsort(keys, c->size, sizeof(uint64_t), qcnf_compare_sort_keys);
+    for (unsigned i = 0; i < c->size; i++) {
+        Lit var = (Lit) ((keys[i] >> 1) & 0xffffffff);
+        c->occs[i] = keys[i] & 1 ? - var : var;
+    }
+    free(keys);
     
     if (!qcnf_register_clause(qcnf, c)) {
         c = NULL;
@@ -509,8 +585,9 @@ bool qcnf_register_clause(QCNF* qcnf, Clause* c) {
     
     // Update the occurrence lists
     for (int i = 0; i < c->size; i++) {
-        vector_add(qcnf_get_occs_of_lit(qcnf, c->occs[i]), c);
+        occ_vector_add(qcnf_get_occs_of_lit(qcnf, c->occs[i]), c);
     }
+    qcnf_update_Jeroslow_Wang_weights(qcnf, c, 1);
     assert(!c->active);
     c->active = 1;
     if (!c->in_active_clause_vector) {
@@ -536,9 +613,10 @@ void qcnf_unregister_clause(QCNF* qcnf, Clause* c) {
     }
     // Update the occurrence lists
     for (int i = 0; i < c->size; i++) {
-        vector* occs = qcnf_get_occs_of_lit(qcnf, c->occs[i]);
-        vector_remove_unsorted(occs, c);
+        occ_vector* occs = qcnf_get_occs_of_lit(qcnf, c->occs[i]);
+        occ_vector_remove_unsorted(occs, c);
     }
+    qcnf_update_Jeroslow_Wang_weights(qcnf, c, -1);
     c->active = 0; // will be cleaned up by the clause iterators
     c2_rl_delete_clause(c);
 }
@@ -554,8 +632,8 @@ void qcnf_delete_clause(QCNF* qcnf, Clause* c) {
 
 void qcnf_free_var(Var* v) {
     assert(v);
-    free(v->pos_occs.data);
-    free(v->neg_occs.data);
+    occ_vector_free_data(&v->pos_occs);
+    occ_vector_free_data(&v->neg_occs);
     free(v);
 }
 
@@ -567,6 +645,11 @@ void qcnf_free(QCNF* qcnf) {
     vector_free(qcnf->all_clauses);
     vector_free(qcnf->active_clauses);
     stack_free(qcnf->stack);
+    for (unsigned i = 0; i < var_vector_count(qcnf->vars); i++) {
+        Var* v = var_vector_get(qcnf->vars, i);
+        occ_vector_free_data(&v->pos_occs);
+        occ_vector_free_data(&v->neg_occs);
+    }
     var_vector_free(qcnf->vars); // also deallocates the variables
     
     for (unsigned i = 0 ; i < vector_count(qcnf->scopes); i++) {
@@ -579,6 +662,7 @@ void qcnf_free(QCNF* qcnf) {
         free(str);
     }
     vector_free(qcnf->variable_names);
+    int_vector_free(qcnf->lit_weights);
     free(qcnf);
 }
 
@@ -604,10 +688,12 @@ void qcnf_undo_op(void* parent, char type, void* obj) {
             Var* v = var_vector_get(qcnf->vars, var_id);
             
             assert(v->var_id != 0 && v->var_id < var_vector_count(qcnf->vars));
-            assert(vector_count(&v->pos_occs) == 0);
-            assert(vector_count(&v->neg_occs) == 0);
+            assert(occ_vector_count(&v->pos_occs) == 0);
+            assert(occ_vector_count(&v->neg_occs) == 0);
             
             // make sure the variable "doesn't exist" any more
+            occ_vector_free_data(&v->pos_occs);
+            occ_vector_free_data(&v->neg_occs);
             var_vector_set(qcnf->vars, v->var_id, *var_vector_get(qcnf->vars, 0));
             
             // Clean up the variable vector. In particular this reduces the var_ids for future calls to qcnf_fresh_var:
@@ -797,8 +883,6 @@ void qcnf_check_invariants_variable(QCNF* qcnf, Var* v) {
         abortif(v->is_universal == 0,"");
         abortif(v->pos_occs.count == 0,"");
         abortif(v->neg_occs.count == 0,"");
-        abortif(v->pos_occs.data == 0,"");
-        abortif(v->neg_occs.data == 0,"");
     }
     
 }
@@ -895,8 +979,8 @@ validate_and_return: // check that the result is correct ... this function is to
 }
 
 bool qcnf_remove_literal(QCNF* qcnf, Clause* c, Lit l) {
-    vector* occs = qcnf_get_occs_of_lit(qcnf, l);
-    vector_remove_unsorted(occs, c);
+    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, l);
+    occ_vector_remove_unsorted(occs, c);
     unsigned i = 0;
     bool found = false;
     for (; i < c->size; i++) {
@@ -905,21 +989,27 @@ bool qcnf_remove_literal(QCNF* qcnf, Clause* c, Lit l) {
         }
     }
     found = i < c->size;
+    if (found && c->active) {
+        qcnf_update_Jeroslow_Wang_weights(qcnf, c, -1);
+    }
     for (unsigned j = i+1; j < c->size; j++) {
         c->occs[j-1] = c->occs[j];
     }
     if (found) {
         assert(c->size > 0);
         c->size -= 1;
+        if (c->active) {
+            qcnf_update_Jeroslow_Wang_weights(qcnf, c, 1);
+        }
     }
     return found;
 }
 
 
 bool qcnf_occus_only_in_binary_clauses(QCNF* qcnf, Lit lit) {
-    vector* occs = qcnf_get_occs_of_lit(qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = (Clause*) vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = (Clause*) occ_vector_get(occs, i);
         if (c->size != 2) {
             return false;
         }
@@ -942,12 +1032,12 @@ Lit qcnf_get_other_lit(Clause* c, Lit lit) {
 
 // Detects equivalences
 bool qcnf_occus_in_xor_halfdef(QCNF* qcnf, Lit this_lit) {
-    vector* occs = qcnf_get_occs_of_lit(qcnf, this_lit);
-    if (vector_count(occs) != 2) {
+    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this_lit);
+    if (occ_vector_count(occs) != 2) {
         return false;
     }
-    Clause* first = vector_get(occs, 0);
-    Clause* second = vector_get(occs, 1);
+    Clause* first = occ_vector_get(occs, 0);
+    Clause* second = occ_vector_get(occs, 1);
     if (first->size != 3 || second->size != 3) {
         return false;
     }
@@ -998,17 +1088,17 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
                 Lit this = polarity * (Lit) v->var_id;
                 
                 if (qcnf_occus_only_in_binary_clauses(qcnf, this)) {
-                    vector* binary_occs = qcnf_get_occs_of_lit(qcnf, this);
-                    unsigned cost = vector_count(binary_occs);
+                    occ_vector* binary_occs = qcnf_get_occs_of_lit(qcnf, this);
+                    unsigned cost = occ_vector_count(binary_occs);
                     if (cost <= add_long_clause_cost) {
                         only_binary_polarity = polarity;
                         add_long_clause_cost = cost;
                     }
                 }
                 
-                vector* occs = qcnf_get_occs_of_lit(qcnf, this);
-                if (vector_count(occs) == 1) {
-                    Clause* only_occ = vector_get(occs, 0);
+                occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this);
+                if (occ_vector_count(occs) == 1) {
+                    Clause* only_occ = occ_vector_get(occs, 0);
                     unsigned cost = only_occ->size;
                     if (cost < add_binary_clauses_cost) {
                         single_occurrence_polarity = polarity;
@@ -1017,8 +1107,8 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
                 }
                 
                 if (qcnf_occus_in_xor_halfdef(qcnf, this)) {
-                    vector* occs = qcnf_get_occs_of_lit(qcnf, this);
-                    unsigned cost = vector_count(occs);
+                    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this);
+                    unsigned cost = occ_vector_count(occs);
                     if (cost <= complete_xor_cost) {
                         xor_halfdef_polarity = polarity;
                         complete_xor_cost = cost;
@@ -1035,10 +1125,10 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
             // Pattern: (l x1 x2) (l -x1 -x2) being the only two clauses for literal
             if (xor_halfdef_polarity != 0) {
                 Lit this = xor_halfdef_polarity * (Lit) v->var_id;
-                vector* occs = qcnf_get_occs_of_lit(qcnf, this);
-                for (unsigned j = 0; j < vector_count(occs); j++) {
+                occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this);
+                for (unsigned j = 0; j < occ_vector_count(occs); j++) {
                     int countdown_to_flip = (int) j; // flip the j-th occurrence different than 'this'; can become negative
-                    Clause* c = vector_get(occs, j);
+                    Clause* c = occ_vector_get(occs, j);
                     for (unsigned k = 0 ; k < c->size; k++) {
                         if (c->occs[k] != this) {
                             if (countdown_to_flip == 0) {
@@ -1058,9 +1148,9 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
                     assert(only_binary_polarity);
                     Lit this = only_binary_polarity * (Lit) v->var_id;
                     
-                    vector* occs = qcnf_get_occs_of_lit(qcnf, this);
-                    for (unsigned j = 0; j < vector_count(occs); j++) {
-                        Clause* c = vector_get(occs, j);
+                    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this);
+                    for (unsigned j = 0; j < occ_vector_count(occs); j++) {
+                        Clause* c = occ_vector_get(occs, j);
                         assert(c->size == 2);
                         Lit other = qcnf_get_other_lit(c, this);
                         qcnf_add_lit(qcnf, - other);
@@ -1072,10 +1162,10 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
                 if (add_binary_clauses_cost < UINT_MAX && add_binary_clauses_cost <= add_long_clause_cost) {
                     assert(single_occurrence_polarity);
                     Lit this = single_occurrence_polarity * (Lit) v->var_id;
-                    vector* occs = qcnf_get_occs_of_lit(qcnf, this);
-                    assert(vector_count(occs) == 1);
+                    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, this);
+                    assert(occ_vector_count(occs) == 1);
                     
-                    Clause* c = (Clause*) vector_get(occs, 0);
+                    Clause* c = (Clause*) occ_vector_get(occs, 0);
                     for (unsigned j = 0; j < c->size; j++) {
                         Lit l = c->occs[j];
                         if (lit_to_var(l) != v->var_id) {
@@ -1094,9 +1184,9 @@ void qcnf_plaisted_greenbaum_completion(QCNF* qcnf) {
 
 bool qcnf_is_blocked_by_lit(QCNF* qcnf, Clause* c, Lit pivot) {
     assert(qcnf_contains_literal(c, pivot));
-    vector* occs = qcnf_get_occs_of_lit(qcnf, - pivot);
-    for (unsigned j = 0; j < vector_count(occs); j++) {
-        Clause* other = vector_get(occs, j);
+    occ_vector* occs = qcnf_get_occs_of_lit(qcnf, - pivot);
+    for (unsigned j = 0; j < occ_vector_count(occs); j++) {
+        Clause* other = occ_vector_get(occs, j);
         if ( ! qcnf_is_resolvent_tautological(qcnf, c, other, lit_to_var(pivot))) {
             return false;
         }
@@ -1104,29 +1194,48 @@ bool qcnf_is_blocked_by_lit(QCNF* qcnf, Clause* c, Lit pivot) {
     return true;
 }
 
-bool qcnf_is_blocked(QCNF* qcnf, Clause* c) {
+// Returns a literal of an innermost existential that blocks the clause, or 0 if there is none.
+// Restricting the pivots to innermost existentials allows us to reconstruct the Skolem functions
+// by flipping the pivot whenever the clause is falsified.
+Lit qcnf_blocking_literal(QCNF* qcnf, Clause* c) {
     for (unsigned i = 0; i < c->size; i++) {
         Lit pivot = c->occs[i];
-        if (qcnf_is_universal(qcnf, lit_to_var(pivot))) {
+        if (qcnf_is_universal(qcnf, lit_to_var(pivot)) || ! qcnf_var_has_unique_maximal_dependency(qcnf, lit_to_var(pivot))) {
             continue;
         }
         if (qcnf_is_blocked_by_lit(qcnf, c, pivot)) {
-            return true;
+            return pivot;
         }
     }
-    return false;
+    return 0;
 }
 
-void qcnf_blocked_clause_detection(QCNF* qcnf) {
-    Clause_Iterator ci = qcnf_get_clause_iterator(qcnf); Clause* c = NULL;
-    while ((c = qcnf_next_clause(&ci)) != NULL) {
-        if (qcnf_is_blocked(qcnf, c)) {
-            c->blocked = 1;
-            qcnf->blocked_clauses += 1;
-            qcnf_unregister_clause(qcnf, c);
-            
-            V1("Clause deleted: ");
-            if(debug_verbosity >= VERBOSITY_LOW) {qcnf_print_clause(c, stdout);}
+bool qcnf_is_blocked(QCNF* qcnf, Clause* c) {
+    return qcnf_blocking_literal(qcnf, c) != 0;
+}
+
+// Removes blocked clauses until fixpoint. Pushes pairs of clause_idx and blocking literal
+// onto the reconstruction stack (can be NULL), in the order of elimination.
+void qcnf_blocked_clause_detection(QCNF* qcnf, int_vector* reconstruction) {
+    bool removed_clause = true;
+    while (removed_clause) {
+        removed_clause = false;
+        Clause_Iterator ci = qcnf_get_clause_iterator(qcnf); Clause* c = NULL;
+        while ((c = qcnf_next_clause(&ci)) != NULL) {
+            Lit pivot = qcnf_blocking_literal(qcnf, c);
+            if (pivot != 0) {
+                c->blocked = 1;
+                qcnf->blocked_clauses += 1;
+                removed_clause = true;
+                if (reconstruction) {
+                    int_vector_add(reconstruction, (int) c->clause_idx);
+                    int_vector_add(reconstruction, pivot);
+                }
+                qcnf_unregister_clause(qcnf, c);
+                
+                V2("Clause deleted: ");
+                if(debug_verbosity >= VERBOSITY_MEDIUM) {qcnf_print_clause(c, stdout);}
+            }
         }
     }
     V1("Removed %u blocked clauses.\n", qcnf->blocked_clauses);
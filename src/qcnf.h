@@ -12,6 +12,7 @@
 #include "int_vector.h"
 #include "vector.h"
 #include "var_vector.h"
+#include "occ_vector.h"
 #include "map.h"
 #include "undo_stack.h"
 
@@ -66,9 +67,9 @@ struct Var {
     char is_universal; // just a boolean value
     char original; // just a boolean value
     
-    vector pos_occs; // vector of Clause*
-    vector neg_occs;
-}; // should have length of 48 byte because of 64 bit alignment
+    occ_vector pos_occs;
+    occ_vector neg_occs;
+}; // 88 bytes with 64 bit alignment; no allocations for up to OCC_VECTOR_INLINE occurrences per polarity
 
 
 // Set of universals.
@@ -93,6 +94,10 @@ struct QCNF {
     
     vector* variable_names;
     
+    // Short clause part of the Jeroslow-Wang weights of the literals; indexed by 2 * var_id + (lit < 0).
+    // Maintained incrementally on clause (un)registration; see qcnf_get_Jeroslow_Wang_weight.
+    int_vector* lit_weights;
+    
     // Stats
     unsigned universal_reductions;
     unsigned deleted_clauses;
@@ -138,7 +143,8 @@ unsigned qcnf_fresh_universal(QCNF*);
 bool qcnf_is_existential(QCNF* qcnf, unsigned var_id);
 bool qcnf_is_universal(QCNF* qcnf, unsigned var_id);
 bool qcnf_is_original(QCNF* qcnf, unsigned var_id);
-vector* qcnf_get_occs_of_lit(QCNF* qcnf, Lit lit);
+occ_vector* qcnf_get_occs_of_lit(QCNF* qcnf, Lit lit);
+double qcnf_get_Jeroslow_Wang_weight(QCNF* qcnf, Lit lit);
 
 void qcnf_add_lit(QCNF*, int lit);
 Clause* qcnf_close_clause(QCNF*);
@@ -191,8 +197,10 @@ bool qcnf_remove_literal(QCNF*, Clause*, Lit);
 void qcnf_delete_clause(QCNF*, Clause*);
 
 void qcnf_plaisted_greenbaum_completion(QCNF* qcnf);
-void qcnf_blocked_clause_detection(QCNF* qcnf);
+Clause* qcnf_universal_reduction(QCNF* qcnf, Clause* c);
+void qcnf_blocked_clause_detection(QCNF* qcnf, int_vector* reconstruction);
 bool qcnf_is_blocked_by_lit(QCNF* qcnf, Clause* c, Lit pivot);
+Lit qcnf_blocking_literal(QCNF* qcnf, Clause* c);
 bool qcnf_is_blocked(QCNF* qcnf, Clause* c);
 
 Clause_Iterator qcnf_get_clause_iterator(QCNF*);
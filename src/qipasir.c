@@ -20,7 +20,9 @@ const char * qipasir_signature () {
 }
 
 void * qipasir_init () {
-    C2* c2 = c2_init(default_options());
+    Options* o = default_options();
+    o->pure_literals = false; // pure literals are chosen for the current clauses and would conflict with existential assumptions
+    C2* c2 = c2_init(o);
     return c2;
 }
 
@@ -68,17 +70,14 @@ int qipasir_val (void * solver, int lit) {
     return c2_val(c2,lit);
 }
 
-//void qipasir_assume (void * solver, int lit) {
-//    V0("Not implemented");
-//    abort();
-//}
+void qipasir_assume (void * solver, int lit) {
+    c2_assume(solver, lit);
+}
 
-//int qipasir_failed (void * solver, int lit) {
-//    V0("Not implemented");
-//    abort();
-//}
+int qipasir_failed (void * solver, int lit) {
+    return c2_is_core(solver, lit) ? 1 : 0;
+}
 
-//void qipasir_set_terminate (void * solver, void * state, int (*terminate)(void * state)) {
-//    V0("Not implemented");
-//    abort();
-//}
+void qipasir_set_terminate (void * solver, void * state, int (*terminate)(void * state)) {
+    c2_set_terminate(solver, state, terminate);
+}
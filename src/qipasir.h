@@ -115,9 +115,11 @@ int qipasir_val (void * solver, int lit);
  * Check if the given assumption literal was used to prove the
  * unsatisfiability of the formula under the assumptions
  * used for the last call to qipasir_solve. Return 1 if so, 0 otherwise.
+ * After a SAT result, reports the universal assumptions that the
+ * satisfiability depends on.
  *
- * Required state: UNSAT
- * State after: UNSAT
+ * Required state: SAT or UNSAT
+ * State after: SAT or UNSAT
  */
 int qipasir_failed (void * solver, int lit);
 
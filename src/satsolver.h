@@ -68,6 +68,9 @@ void satsolver_set_more_important_lit (SATSolver*, int lit);
 
 const int* satsolver_next_maximal_satisfiable_subset_of_assumptions(SATSolver* solver);
 
+// satsolver_sat returns SATSOLVER_UNKNOWN once terminate(state) returns non-zero; NULL removes the hook.
+void satsolver_set_terminate(SATSolver*, void* state, int (*terminate)(void* state));
+
 void satsolver_set_global_default_phase(SATSolver* s, int phase);
 void satsolver_set_default_phase_lit (SATSolver* s, int lit, int phase);
 
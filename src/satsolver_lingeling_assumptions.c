@@ -331,6 +331,10 @@ double satsolver_seconds(SATSolver* solver) {
     return res;
 }
 
+void satsolver_set_terminate(SATSolver* solver, void* state, int (*terminate)(void* state)) {
+    lglseterm(solver->lgl, terminate, state);
+}
+
 void satsolver_set_global_default_phase(SATSolver* solver, int phase) {
     abort(); // not implemented
 }
@@ -140,6 +140,10 @@ int satsolver_deref_partial(SATSolver* solver, int lit) {
 //    return satsolver_deref(solver, lit);
 }
 
+void satsolver_set_terminate(SATSolver* solver, void* state, int (*terminate)(void* state)) {
+    // Not supported by this backend; termination is only checked between SAT calls.
+}
+
 void satsolver_set_global_default_phase(SATSolver* solver, int phase) {
     NOT_IMPLEMENTED();
 }
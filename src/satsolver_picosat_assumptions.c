@@ -391,6 +391,10 @@ double satsolver_seconds(SATSolver* solver) {
     return res;
 }
 
+void satsolver_set_terminate(SATSolver* solver, void* state, int (*terminate)(void* state)) {
+    picosat_set_interrupt(solver->ps, state, terminate);
+}
+
 void satsolver_set_global_default_phase(SATSolver* solver, int phase) {
     picosat_set_global_default_phase(solver->ps, phase);
     
@@ -11,40 +11,23 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include <assert.h>
 
 
 #define INITIAL_SET_SIZE 8
 
-// From https://gist.github.com/badboy/6267743
-//int hash32shiftmult(int key) {
-//    int c2 = 0x27d4eb2d; // a prime or an odd constant
-//    key = (key ^ 61) ^ (key >> 16);
-//    key = key + (key << 3);
-//    key = key ^ (key >> 4);
-//    key = key * c2;
-//    key = key ^ (key >> 15);
-//    return key;
-//}
-
-//long hash64shift(void* k) {
-//    assert(sizeof(long) == 4);
-//    assert(sizeof(long long) == 8);
-//    assert(sizeof(void*) == 8);
-//    long long key = (long long) k;
-//    key = (~key) + (key << 21); // key = (key << 21) - key - 1;
-//    key = key ^ (key >> 24);
-//    key = (key + (key << 3)) + (key << 8); // key * 265
-//    key = key ^ (key >> 14);
-//    key = (key + (key << 2)) + (key << 4); // key * 21
-//    key = key ^ (key >> 28);
-//    key = key + (key << 31);
-//    return key;
-//}
-
-
-int set_hash_function(void* key, size_t size) {
-    return abs(hash6432shift(key)) % (int) size;
+static size_t set_home_slot(set* container, void* key) {
+    return (size_t) (unsigned) hash6432shift(key) & (container->size - 1);
+}
+
+static size_t set_round_size(size_t size) {
+    size_t s = INITIAL_SET_SIZE;
+    while (s < size) {
+        s *= 2;
+    }
+    return s;
 }
 
 set* set_init() {
@@ -53,110 +36,117 @@ set* set_init() {
 
 set* set_init_size(size_t size) {
     set* container = malloc(sizeof(set));
-    container->data = calloc(sizeof(set_entry*), size);
+    container->size = set_round_size(size);
+    container->data = malloc(sizeof(void*) * container->size);
+    container->dist = calloc(sizeof(unsigned char), container->size);
     container->count = 0;
-    container->size = size;
     return container;
 }
 
-set_entry* set_get_entry(set* container, void* key) {
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* entry = container->data[hash];
-    while (entry != NULL && entry->key != key) {
-        entry = entry->next;
+// Returns the slot of the key, or container->size if the key is not in the set
+static size_t set_find(set* container, void* key) {
+    size_t mask = container->size - 1;
+    size_t pos = set_home_slot(container, key);
+    for (unsigned d = 1; container->dist[pos] >= d; d++) {
+        if (container->data[pos] == key) {
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return container->size;
+}
+
+// Places the key without checking the load factor; does not touch the count.
+static void set_insert(set* container, void* key) {
+    size_t mask = container->size - 1;
+    size_t pos = set_home_slot(container, key);
+    unsigned char d = 1;
+    while (container->dist[pos] != 0) {
+        if (container->dist[pos] < d) { // rich entry gives way to the poor one
+            void* tmp_key = container->data[pos];
+            unsigned char tmp_d = container->dist[pos];
+            container->data[pos] = key;
+            container->dist[pos] = d;
+            key = tmp_key;
+            d = tmp_d;
+        }
+        pos = (pos + 1) & mask;
+        d++;
+        if (d == UCHAR_MAX) { // probe distances must fit the metadata; key is the only one not in the table
+            set_resize(container, 2 * container->size);
+            set_insert(container, key);
+            return;
+        }
     }
-    return entry;
+    container->data[pos] = key;
+    container->dist[pos] = d;
 }
 
 bool set_contains(set* container, void* key) {
-    return set_get_entry(container, key) != NULL;
+    return set_find(container, key) != container->size;
 }
 
 void set_add(set* container, void* key) {
     assert(!set_contains(container, key));
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* new_entry = malloc(sizeof(set_entry));
-    new_entry->key = key;
-    new_entry->next = container->data[hash];
-    container->data[hash] = new_entry;
-    
-    container->count++;
-    
-    if (container->count > container->size + container->size / 2) {
+    if (4 * (container->count + 1) > 3 * container->size) {
         set_resize(container, 2 * container->size);
     }
+    set_insert(container, key);
+    container->count++;
 }
 
 void set_resize(set* container, size_t new_size) {
 //    V4("Resizing container to size %zu\n", new_size);
+    new_size = set_round_size(new_size);
+    assert(4 * container->count <= 3 * new_size);
     size_t old_size = container->size;
-    set_entry** old_data = container->data;
-    
+    void** old_data = container->data;
+    unsigned char* old_dist = container->dist;
+
     container->size = new_size;
-    container->data = calloc(sizeof(set_entry*), new_size);
-    
+    container->data = malloc(sizeof(void*) * new_size);
+    container->dist = calloc(sizeof(unsigned char), new_size);
+
     for (size_t i = 0; i < old_size; i++) {
-        set_entry* entry = old_data[i];
-        while (entry != NULL) {
-            set_entry* next = entry->next;
-            int new_hash = set_hash_function(entry->key, container->size);
-            assert(new_hash >= 0 && new_hash < (int) container->size);
-            
-            entry->next = container->data[new_hash];
-            container->data[new_hash] = entry;
-            
-            entry = next;
+        if (old_dist[i] != 0) {
+            set_insert(container, old_data[i]);
         }
     }
-    
+
     free(old_data);
+    free(old_dist);
 }
 
 void set_remove(set* container, void* key) {
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* entry = container->data[hash];
-    set_entry* prev = NULL;
-    while (entry != NULL && entry->key != key) {
-        prev = entry;
-        entry = entry->next;
-    }
-    if (entry == NULL) {
+    size_t pos = set_find(container, key);
+    if (pos == container->size) {
         V4("Warning: trying to remove non-existent set element.\n");
         return;
     }
     container->count--;
-    if (prev == NULL) {
-        container->data[hash] = entry->next;
-    } else {
-        prev->next = entry->next;
+    // shift the following entries back until one is empty or in its home slot
+    size_t mask = container->size - 1;
+    size_t next = (pos + 1) & mask;
+    while (container->dist[next] > 1) {
+        container->data[pos] = container->data[next];
+        container->dist[pos] = (unsigned char) (container->dist[next] - 1);
+        pos = next;
+        next = (next + 1) & mask;
     }
-    free(entry);
+    container->dist[pos] = 0;
 }
 
 void set_reset(set* container) {
     if (set_count(container) == 0) {
         return;
     }
-    for (size_t i = 0; i < container->size; i++) {
-        set_entry* next_e;
-        for (set_entry* e = container->data[i]; e != NULL; e = next_e) {
-            next_e = e->next;
-            free(e);
-        }
-        container->data[i] = 0;
-    }
+    memset(container->dist, 0, container->size);
     container->count = 0;
 }
 
 void set_free(set* container) {
-    set_reset(container);
     free(container->data);
+    free(container->dist);
     free(container);
 }
 
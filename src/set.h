@@ -7,6 +7,7 @@
 //
 
 // This is a version of the hash map that saves memory by not storing data.
+// Keys are pointers; the table layout is the same as in map.h.
 
 #ifndef set_h
 #define set_h
@@ -14,18 +15,11 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-struct set_entry;
-typedef struct set_entry set_entry;
-
-struct set_entry {
-    void*      key;
-    set_entry* next;
-};
-
 struct set {
-    set_entry** data;
-    size_t      size;
-    size_t      count;
+    void**         data;
+    unsigned char* dist; // 0 for empty slots, otherwise 1 + distance to the slot the key hashes to
+    size_t         size; // power of two
+    size_t         count;
 };
 
 typedef struct set set;
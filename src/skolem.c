@@ -31,6 +31,7 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     
     s->state = SKOLEM_STATE_READY;
     s->decision_lvl = 0;
+    s->level0_epoch = 0;
     
     s->satlit_true = satsolver_inc_max_var(s->skolem);
     satsolver_add(s->skolem, s->satlit_true);
@@ -43,6 +44,10 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     
     s->record_conflicts = false;
     s->ignore_universal_conflicts = false;
+    s->terminate = NULL;
+    s->terminate_state = NULL;
+    s->interrupted = false;
+    s->profiler = NULL;
     
     if (qcnf_is_DQBF(s->qcnf)) {
         s->empty_dependencies.dependencies = int_vector_init();
@@ -50,8 +55,8 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
         s->empty_dependencies.dependence_lvl = 0;
     }
     
-    s->determinicity_queue = pqueue_init(); // worklist_init(qcnf_compare_variables_by_occ_num);
-    s->pure_var_queue = pqueue_init();
+    s->determinicity_queue = var_queue_init();
+    s->pure_var_queue = var_queue_init();
     s->potential_conflicts_satlits = int_vector_init();
     s->potentially_conflicted_variables = int_vector_init();
     s->unique_consequence = int_vector_init();
@@ -62,6 +67,8 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     s->decision_satlits = int_vector_init();
     s->decisions = int_vector_init();
     s->determinization_order = int_vector_init();
+    s->nondeterministic_vars = int_vector_init();
+    s->nondeterministic_vars_idx = int_vector_init();
     s->universals_assumptions = int_vector_init();
     
     // Statistics
@@ -83,6 +90,7 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     s->magic.conflict_potential_threshold = 0.8f; // (0..1)
     s->magic.conflict_potential_offset = 0.00f;
     s->magic.blocked_clause_occurrence_cutoff = 20;
+    s->magic.propagations_between_termination_checks = 64;
     
     // initialize the initially deterministic variables; these are usually the universals
     for (unsigned i = 1; i < var_vector_count(qcnf->vars); i++) {
@@ -98,11 +106,16 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     return s;
 }
 
+void skolem_set_terminate(Skolem* s, void* state, int (*terminate)(void* state)) {
+    s->terminate = terminate;
+    s->terminate_state = state;
+}
+
 void skolem_free(Skolem* s) {
     if(s->skolem) {satsolver_free(s->skolem);}
     skolem_var_vector_free(s->infos);
-    pqueue_free(s->determinicity_queue);
-    pqueue_free(s->pure_var_queue);
+    var_queue_free(s->determinicity_queue);
+    var_queue_free(s->pure_var_queue);
     vector_free(s->clauses_to_check);
     int_vector_free(s->potential_conflicts_satlits);
     int_vector_free(s->potentially_conflicted_variables);
@@ -110,6 +123,9 @@ void skolem_free(Skolem* s) {
     int_vector_free(s->decisions);
     int_vector_free(s->universals_assumptions);
     int_vector_free(s->decision_satlits);
+    int_vector_free(s->determinization_order);
+    int_vector_free(s->nondeterministic_vars);
+    int_vector_free(s->nondeterministic_vars_idx);
     stack_free(s->stack);
     free(s);
 }
@@ -117,19 +133,19 @@ void skolem_free(Skolem* s) {
 void skolem_push(Skolem* s) {
     stack_push(s->stack);
     satsolver_push(s->skolem);
-    abortif(pqueue_count(s->determinicity_queue) != 0, "s->determinicity_queue nonempty upon push. Serious because the remaining elements might be forgotten to be tracked upon a pop.");
-    abortif(pqueue_count(s->pure_var_queue), "s->pure_var_queue nonempty on push. Serious because the remaining elements might be forgotten to be tracked upon a pop.");
+    abortif(var_queue_count(s->determinicity_queue) != 0, "s->determinicity_queue nonempty upon push. Serious because the remaining elements might be forgotten to be tracked upon a pop.");
+    abortif(var_queue_count(s->pure_var_queue), "s->pure_var_queue nonempty on push. Serious because the remaining elements might be forgotten to be tracked upon a pop.");
     abortif(vector_count(s->clauses_to_check) != 0, "s->clauses_to_check nonempty upon push. Serious because the remaining elements might be forgotten to be tracked upon a pop.");
 }
 void skolem_pop(Skolem* s) {
     if (vector_count(s->clauses_to_check) > 0) {
         vector_reset(s->clauses_to_check);
     }
-    if (pqueue_count(s->determinicity_queue) > 0) {
-        pqueue_reset(s->determinicity_queue);
+    if (var_queue_count(s->determinicity_queue) > 0) {
+        var_queue_reset(s->determinicity_queue);
     }
-    if (pqueue_count(s->pure_var_queue) > 0) {
-        pqueue_reset(s->pure_var_queue);
+    if (var_queue_count(s->pure_var_queue) > 0) {
+        var_queue_reset(s->pure_var_queue);
     }
     stack_pop(s->stack, s);
     satsolver_pop(s->skolem);
@@ -143,6 +159,7 @@ void skolem_update_state(Skolem* s, SKOLEM_STATE state) {
 void skolem_new_clause(Skolem* s, Clause* c) {
     abortif(c == NULL, "Clause pointer is NULL in skolem_new_clause.\n");
     assert(skolem_get_unique_consequence(s, c) == 0);
+    s->level0_epoch += 1; // the clause stays when backtracking
     
     if (skolem_clause_satisfied(s, c)) {
         return;
@@ -168,8 +185,11 @@ void skolem_new_clause(Skolem* s, Clause* c) {
                 satsolver_add(s->skolem, skolem_get_satsolver_lit(s, c->occs[i]));
             }
             satsolver_clause_finished_for_context(s->skolem, 0);
+        } else if (skolem_is_conflicted(s)) {
+            V2("Added deterministic clause to a conflicted domain.\n"); // the first conflict stays the refutation
         } else {
             V2("Added deterministic clause.\n");
+            satsolver_push(s->skolem); // popped with the conflict, as for global conflict checks
             for (unsigned i = 0; i < c->size; i++) {
                 satsolver_assume(s->skolem, skolem_get_satsolver_lit(s, - c->occs[i]));
             }
@@ -182,6 +202,7 @@ void skolem_new_clause(Skolem* s, Clause* c) {
                 s->conflict_var_id = lit_to_var(lastlit);
                 stack_push_op(s->stack, SKOLEM_OP_SKOLEM_CONFLICT, NULL);
             } else {
+                satsolver_pop(s->skolem);
                 V2("Deterministic clause that was added is consistent.\n");
                 if (debug_verbosity >= VERBOSITY_MEDIUM) {
                     qcnf_print_clause(c, stdout);
@@ -225,12 +246,15 @@ void skolem_new_variable(Skolem* s, unsigned var_id) {
         skolem_update_dependencies(s, var_id, dep);
     }
     if (qcnf_is_existential(s->qcnf, var_id)) {
+        if (!skolem_is_deterministic(s, var_id)) {
+            skolem_nondeterministic_vars_add(s, var_id);
+        }
         // to make sure we don't miss pure variables
-        unsigned pos_count = vector_count(qcnf_get_occs_of_lit(s->qcnf,   (Lit) var_id));
-        unsigned neg_count = vector_count(qcnf_get_occs_of_lit(s->qcnf, - (Lit) var_id));
-        pqueue_push(s->pure_var_queue,
-                    (int) (pos_count + neg_count),
-                    (void*) (size_t) var_id);
+        unsigned pos_count = occ_vector_count(qcnf_get_occs_of_lit(s->qcnf,   (Lit) var_id));
+        unsigned neg_count = occ_vector_count(qcnf_get_occs_of_lit(s->qcnf, - (Lit) var_id));
+        var_queue_push(s->pure_var_queue,
+                       (int) (pos_count + neg_count),
+                       var_id);
     }
 
 }
@@ -277,7 +301,7 @@ bool skolem_is_potentially_conflicted(Skolem* s){
     return int_vector_count(s->potential_conflicts_satlits) != 0;
 }
 bool skolem_can_propagate(Skolem* s) {
-    return (vector_count(s->clauses_to_check) || pqueue_count(s->determinicity_queue) || pqueue_count(s->pure_var_queue))
+    return (vector_count(s->clauses_to_check) || var_queue_count(s->determinicity_queue) || var_queue_count(s->pure_var_queue))
            && ! skolem_is_conflicted(s);
 }
 bool skolem_has_empty_domain(Skolem* s) {
@@ -384,9 +408,9 @@ bool skolem_has_unique_consequence(Skolem* s, Clause* c) {
 
 void skolem_check_occs_for_unique_consequences(Skolem* s, Lit lit) {
     assert(lit != 0);
-    vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         
         if (skolem_has_unique_consequence(s,c)) {  // || partial_assignment_is_clause_satisfied(pa, c) // we are ignoring the possibility that the clause might be satisfied ..
             continue;
@@ -412,9 +436,9 @@ void skolem_check_for_unique_consequence(Skolem* s, Clause* c) {
     if (undecided_lit != 0) {
         skolem_set_unique_consequence(s, c, undecided_lit);
         Var* unique = var_vector_get(s->qcnf->vars, lit_to_var(undecided_lit));
-        pqueue_push(s->determinicity_queue,
-                    (int) (vector_count(&unique->pos_occs) + vector_count(&unique->neg_occs)),
-                    (void*) (size_t) unique->var_id);
+        var_queue_push(s->determinicity_queue,
+                       (int) (occ_vector_count(&unique->pos_occs) + occ_vector_count(&unique->neg_occs)),
+                       unique->var_id);
     }
 }
 
@@ -426,10 +450,10 @@ void skolem_check_for_unique_consequence(Skolem* s, Clause* c) {
  * which is used for determinicity checks.
  */
 bool skolem_add_occurrences_for_determinicity_check(Skolem* s, SATSolver* sat,
-                                           unsigned var_id, vector* occs) {
+                                           unsigned var_id, occ_vector* occs) {
     bool case_exists = false;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         Lit uc = skolem_get_unique_consequence(s, c);
         if (uc
             && lit_to_var(uc) == var_id
@@ -447,9 +471,9 @@ bool skolem_add_occurrences_for_determinicity_check(Skolem* s, SATSolver* sat,
     return case_exists;
 }
 
-void skolem_add_clauses_using_existing_satlits(Skolem* s, unsigned var_id, vector* occs) {
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+void skolem_add_clauses_using_existing_satlits(Skolem* s, unsigned var_id, occ_vector* occs) {
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         Lit uc = skolem_get_unique_consequence(s, c);
         
         if (uc
@@ -494,13 +518,13 @@ bool skolem_clause_is_blocked_by_lit(Skolem* s, Clause* c, Lit lit) {
     assert(qcnf_contains_literal(c, lit));
     assert(! skolem_clause_satisfied(s, c)); // No problem, but it does not make sense to call this function
     
-    vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
-    if (vector_count(opp_occs) > s->magic.blocked_clause_occurrence_cutoff) {
+    occ_vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
+    if (occ_vector_count(opp_occs) > s->magic.blocked_clause_occurrence_cutoff) {
         return false;
     }
     
-    for (unsigned i = 0; i < vector_count(opp_occs); i++) {
-        Clause* other = vector_get(opp_occs, i);
+    for (unsigned i = 0; i < occ_vector_count(opp_occs); i++) {
+        Clause* other = occ_vector_get(opp_occs, i);
         assert(qcnf_contains_literal(other, - lit));
         if (! skolem_clause_satisfied(s, other) && //skolem_get_unique_consequence(s, other) == - lit && 
             ! qcnf_is_resolvent_tautological(s->qcnf, c, other, lit_to_var(lit))) {
@@ -515,13 +539,13 @@ bool skolem_clause_satisfied_when_in_doubt(Skolem* s, Clause* c, Lit lit) {
     assert(qcnf_is_existential(s->qcnf, lit_to_var(lit)));
     assert(qcnf_contains_literal(c, lit));
     assert(! skolem_clause_satisfied(s, c)); // No problem, but it does not make sense to call this function
-    vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
-    if (vector_count(opp_occs) > s->magic.blocked_clause_occurrence_cutoff) {
+    occ_vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
+    if (occ_vector_count(opp_occs) > s->magic.blocked_clause_occurrence_cutoff) {
         return false;
     }
     
-    for (unsigned i = 0; i < vector_count(opp_occs); i++) {
-        Clause* other = vector_get(opp_occs, i);
+    for (unsigned i = 0; i < occ_vector_count(opp_occs); i++) {
+        Clause* other = occ_vector_get(opp_occs, i);
         assert(qcnf_contains_literal(other, - lit));
         if (skolem_get_unique_consequence(s, other) == - lit && ! skolem_clause_satisfied(s, other) &&
             qcnf_antecedent_subsubsumed(s->qcnf, other, c, lit_to_var(lit))) {
@@ -537,9 +561,9 @@ bool skolem_clause_satisfied_when_in_doubt(Skolem* s, Clause* c, Lit lit) {
  * Disregarding clauses that are satisfied whenever a UC of -lit fires.
  */
 bool skolem_is_lit_pure(Skolem* s, Lit lit) {
-    vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         if ((skolem_get_unique_consequence(s, c) != lit || skolem_has_illegal_dependence(s, c) ) &&
             ! skolem_clause_satisfied(s, c)) { // std condition for pure vars
             if (s->options->enhanced_pure_literals && skolem_clause_is_blocked_by_lit(s, c, lit)) {
@@ -559,10 +583,10 @@ bool skolem_is_lit_pure(Skolem* s, Lit lit) {
 bool skolem_fix_lit_for_unique_antecedents(Skolem* s, Lit lit, bool define_both_sides) {
     assert(lit != 0);
     
-    vector* lit_occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    occ_vector* lit_occs = qcnf_get_occs_of_lit(s->qcnf, lit);
     bool case_exists = false;
-    for (unsigned i = 0; i < vector_count(lit_occs); i++) {
-        Clause* c = vector_get(lit_occs, i);
+    for (unsigned i = 0; i < occ_vector_count(lit_occs); i++) {
+        Clause* c = occ_vector_get(lit_occs, i);
         assert( - lit != skolem_get_unique_consequence(s, c));
         if (lit != skolem_get_unique_consequence(s, c) || skolem_clause_satisfied(s, c)) {
             continue;
@@ -580,9 +604,9 @@ void skolem_add_unique_antecedents_of_v_local_conflict_check(Skolem* s, SATSolve
     
     int_vector* conjunction_vars = int_vector_init();
     
-    vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         Lit uc = skolem_get_unique_consequence(s, c);
         if (uc && lit_to_var(uc) == lit_to_var(lit)) {
             switch (c->size) {
@@ -638,6 +662,7 @@ bool skolem_is_locally_conflicted(Skolem* s, unsigned var_id) {
     
     V3("Checking for conflicts for var %d:", var_id);
     s->statistics.local_conflict_checks++;
+    profiler_begin(s->profiler, PROFILER_LOCAL_CONFLICT_CHECK);
     
     SATSolver* sat = satsolver_init();
     satsolver_set_max_var(sat, satsolver_get_max_var(s->skolem));
@@ -650,6 +675,7 @@ bool skolem_is_locally_conflicted(Skolem* s, unsigned var_id) {
     //    }
     sat_res result = satsolver_sat(sat);
     satsolver_free(sat);
+    profiler_end(s->profiler, PROFILER_LOCAL_CONFLICT_CHECK);
     if (result == SATSOLVER_SAT) {
         V3(" locally conflicted\n");
     } else {
@@ -667,7 +693,10 @@ void skolem_propagate_determinicity(Skolem* s, unsigned var_id) {
     Var* v = var_vector_get(s->qcnf->vars, var_id);
     assert(v->var_id == var_id);
     
-    if (skolem_check_for_local_determinicity(s, v)) {
+    profiler_begin(s->profiler, PROFILER_DETERMINICITY_CHECK);
+    bool deterministic = skolem_check_for_local_determinicity(s, v);
+    profiler_end(s->profiler, PROFILER_DETERMINICITY_CHECK);
+    if (deterministic) {
         V3("Var %u is deterministic.\n", var_id);
         s->statistics.propagations += 1;
         skolem_update_decision_lvl(s, var_id, s->decision_lvl);
@@ -690,7 +719,7 @@ void skolem_propagate_determinicity(Skolem* s, unsigned var_id) {
             satsolver_clause_finished(s->skolem);
             
             skolem_global_conflict_check(s, var_id);
-            if (skolem_is_conflicted(s)) {
+            if (skolem_is_conflicted(s) || s->interrupted) {
                 return;
             }
         }
@@ -702,9 +731,9 @@ void skolem_propagate_determinicity(Skolem* s, unsigned var_id) {
         skolem_check_occs_for_unique_consequences(s,   (Lit) var_id);
         skolem_check_occs_for_unique_consequences(s, - (Lit) var_id);
     } else {
-        pqueue_push(s->pure_var_queue,
-                    (int)(vector_count(&v->pos_occs) + vector_count(&v->neg_occs)),
-                    (void*) (size_t) var_id);
+        var_queue_push(s->pure_var_queue,
+                       (int)(occ_vector_count(&v->pos_occs) + occ_vector_count(&v->neg_occs)),
+                       var_id);
     }
 }
 
@@ -739,11 +768,11 @@ void skolem_propagate_pure_variable(Skolem* s, unsigned var_id) {
             
             // also triggers checks for new unique consequences
             if (pure_polarity > 0) {
-                assert(vector_count(&v->pos_occs) == 0 || si.pos_lit != 0);
+                assert(occ_vector_count(&v->pos_occs) == 0 || si.pos_lit != 0);
                 skolem_update_neg_lit(s, var_id, - si.pos_lit);
                 skolem_update_pure_pos(s, var_id, 1);
             } else {
-                assert(vector_count(&v->neg_occs) == 0 || si.neg_lit != 0);
+                assert(occ_vector_count(&v->neg_occs) == 0 || si.neg_lit != 0);
                 skolem_update_pos_lit(s, var_id, - si.neg_lit);
                 skolem_update_pure_neg(s, var_id, 1);
             }
@@ -757,7 +786,7 @@ void skolem_propagate_pure_variable(Skolem* s, unsigned var_id) {
             skolem_var si = skolem_get_info(s, var_id);
             int new_opposite_sat_lit = satsolver_inc_max_var(s->skolem);
             if (pure_polarity > 0) {
-                assert(vector_count(&v->pos_occs) == 0 || si.pos_lit != 0);
+                assert(occ_vector_count(&v->pos_occs) == 0 || si.pos_lit != 0);
                 
                 // define the remaining cases false
                 satsolver_add(s->skolem, - skolem_get_satsolver_lit(s,   (Lit) var_id));
@@ -778,7 +807,7 @@ void skolem_propagate_pure_variable(Skolem* s, unsigned var_id) {
                 skolem_update_neg_lit(s, var_id, new_opposite_sat_lit);
                 skolem_update_pure_pos(s, var_id, 1);
             } else {
-                assert(vector_count(&v->neg_occs) == 0 || si.neg_lit != 0);
+                assert(occ_vector_count(&v->neg_occs) == 0 || si.neg_lit != 0);
                 
                 // define the remaining cases false
                 satsolver_add(s->skolem, - skolem_get_satsolver_lit(s, - (Lit) var_id));
@@ -808,7 +837,7 @@ void skolem_propagate_pure_variable(Skolem* s, unsigned var_id) {
             satsolver_clause_finished(s->skolem);
             
             skolem_global_conflict_check(s, var_id);
-            if (skolem_is_conflicted(s)) {
+            if (skolem_is_conflicted(s) || s->interrupted) {
                 return;
             }
             skolem_update_deterministic(s, var_id);
@@ -952,13 +981,23 @@ unsigned skolem_global_conflict_check(Skolem* s, unsigned var_id) {
     V4("Global conflit check for var %u\n", var_id);
     
     double time_stamp_start = get_seconds();
+    profiler_begin(s->profiler, PROFILER_GLOBAL_CONFLICT_CHECK);
     satsolver_push(s->skolem);
     skolem_encode_global_conflict_check(s);
     s->statistics.global_conflict_checks++;
+    if (s->terminate) {satsolver_set_terminate(s->skolem, s->terminate_state, s->terminate);}
     sat_res result = satsolver_sat(s->skolem);
+    if (s->terminate) {satsolver_set_terminate(s->skolem, NULL, NULL);}
     double time_stamp_end = get_seconds();
+    profiler_end(s->profiler, PROFILER_GLOBAL_CONFLICT_CHECK);
     
-    if (result == SATSOLVER_SAT) {
+    if (result == SATSOLVER_UNKNOWN) {
+        V2("Global conflict check for var %u was interrupted.\n", var_id);
+        satsolver_pop(s->skolem);
+        int_vector_reset(s->potential_conflicts_satlits);
+        int_vector_reset(s->potentially_conflicted_variables);
+        s->interrupted = true;
+    } else if (result == SATSOLVER_SAT) {
         V3("Conflict for variable %u\n", var_id);
         statistic_add_value(s->statistics.global_conflict_checks_sat, time_stamp_end - time_stamp_start);
         
@@ -971,7 +1010,7 @@ unsigned skolem_global_conflict_check(Skolem* s, unsigned var_id) {
         
 #ifdef DEBUG
         for (unsigned i = 0; i < var_vector_count(s->qcnf->vars); i++) {
-            if (qcnf_var_exists(s->qcnf, i) && skolem_is_deterministic(s, i)) {
+            if (qcnf_var_exists(s->qcnf, i) && skolem_is_deterministic(s, i) && i != var_id) { // constants may be assigned to deterministic vars
                 int val_pos_lit = satsolver_deref(s->skolem, skolem_get_satsolver_lit(s,   (Lit) i));
                 int val_neg_lit = satsolver_deref(s->skolem, skolem_get_satsolver_lit(s, - (Lit) i));
                 assert(val_pos_lit != 1 || val_neg_lit != 1);
@@ -1030,6 +1069,9 @@ void skolem_undo(void* parent, char type, void* obj) {
             if (si->deterministic && (unsigned) suu.sus.val == 0) {
                 int_vector_pop(s->determinization_order);
                 c2_rl_update_D(suu.sus.var_id, false);
+                if (qcnf_is_existential(s->qcnf, suu.sus.var_id)) {
+                    skolem_nondeterministic_vars_add(s, suu.sus.var_id);
+                }
             }
             si->deterministic = (unsigned) suu.sus.val;
             break;
@@ -1160,7 +1202,7 @@ void skolem_print_statistics(Skolem* s) {
 }
 
 void skolem_print_debug_info(Skolem* s) {
-    V1("Skolem state\n  Worklist count: %u+%u\n  Stack height: %zu\n  Unique consequences: clause_id -> Lit\n  ", pqueue_count(s->determinicity_queue), pqueue_count(s->pure_var_queue), s->stack->op_count);
+    V1("Skolem state\n  Worklist count: %u+%u\n  Stack height: %zu\n  Unique consequences: clause_id -> Lit\n  ", var_queue_count(s->determinicity_queue), var_queue_count(s->pure_var_queue), s->stack->op_count);
     int j = 0;
     for (unsigned i = 0; i < int_vector_count(s->unique_consequence); i++) {
         Lit l = int_vector_get(s->unique_consequence, i);
@@ -1256,6 +1298,9 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
     
     V3("Skolem: Assign value %d.\n", lit);
     unsigned var_id = lit_to_var(lit);
+    if (s->decision_lvl == 0) {
+        s->level0_epoch += 1;
+    }
     skolem_update_reason_for_constant(s, var_id, reason ? reason->clause_idx : INT_MAX, s->decision_lvl);
     
     if (propagation_deps.dependence_lvl == 1) {
@@ -1274,9 +1319,9 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
         if (qcnf_is_universal(s->qcnf, var_id)) {
             potentially_conflicted = true;
         } else {
-            vector* occs = qcnf_get_occs_of_lit(s->qcnf, -lit);
-            for (unsigned i = 0; i < vector_count(occs); i++) {
-                Clause* c = vector_get(occs, i);
+            occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, -lit);
+            for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+                Clause* c = occ_vector_get(occs, i);
                 if (skolem_get_unique_consequence(s, c) == -lit && ! skolem_clause_satisfied(s, c)) {
                     potentially_conflicted = true;
                     break;
@@ -1302,7 +1347,7 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
         // Callee has to check for conflict state.
         skolem_global_conflict_check(s, var_id);
         
-        if (skolem_is_conflicted(s)) {
+        if (skolem_is_conflicted(s) || s->interrupted) {
             return; // no tests for unique consequences needed, so we can quit here
         }
     }
@@ -1317,25 +1362,25 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
     skolem_update_dependencies(s, var_id, propagation_deps);
     
     // Queue potentially new constants
-    vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
-    for (unsigned i = 0; i < vector_count(opp_occs); i++) {
-        Clause* c = (Clause*) vector_get(opp_occs, i);
+    occ_vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
+    for (unsigned i = 0; i < occ_vector_count(opp_occs); i++) {
+        Clause* c = (Clause*) occ_vector_get(opp_occs, i);
         vector_add(s->clauses_to_check, c);
     }
     
     // Queue potentially new pure variables
-    vector* this_occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(this_occs); i++) {
-        Clause* c = (Clause*) vector_get(this_occs, i);
+    occ_vector* this_occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(this_occs); i++) {
+        Clause* c = (Clause*) occ_vector_get(this_occs, i);
         for (unsigned j = 0; j < c->size; j++) {
             Lit occ = c->occs[j];
             unsigned occ_var = lit_to_var(occ);
             if (! skolem_is_deterministic(s, occ_var)) { // includes -lit
-                unsigned pos_num = vector_count(qcnf_get_occs_of_lit(s->qcnf,   occ));
-                unsigned neg_num = vector_count(qcnf_get_occs_of_lit(s->qcnf, - occ));
-                pqueue_push(s->pure_var_queue,
-                            (int)(pos_num + neg_num),
-                            (void*) (size_t) occ_var);
+                unsigned pos_num = occ_vector_count(qcnf_get_occs_of_lit(s->qcnf,   occ));
+                unsigned neg_num = occ_vector_count(qcnf_get_occs_of_lit(s->qcnf, - occ));
+                var_queue_push(s->pure_var_queue,
+                               (int)(pos_num + neg_num),
+                               occ_var);
             }
         }
     }
@@ -1542,21 +1587,28 @@ void skolem_decision(Skolem* s, Lit decision_lit) {
 
 void skolem_propagate(Skolem* s) {
     V3("Propagating in Skolem domain\n");
-    while (vector_count(s->clauses_to_check) || pqueue_count(s->determinicity_queue) || pqueue_count(s->pure_var_queue)) {
+    unsigned steps = 0;
+    while (vector_count(s->clauses_to_check) || var_queue_count(s->determinicity_queue) || var_queue_count(s->pure_var_queue)) {
         if (skolem_is_conflicted(s)) {
             V4("Skolem domain is in conflict state; stopping propagation.\n");
             return;
         }
+        if (s->interrupted || (s->terminate && ++steps % s->magic.propagations_between_termination_checks == 0 && s->terminate(s->terminate_state))) {
+            V3("Stopping propagation on request.\n");
+            return; // the worklists are kept
+        }
         
         if (vector_count(s->clauses_to_check)) {
             Clause* c = vector_pop(s->clauses_to_check);
             if (!c->active) {continue;}
+            profiler_begin(s->profiler, PROFILER_CONSTANT_PROPAGATION);
             skolem_propagate_constants_over_clause(s, c);
-        } else if (pqueue_count(s->determinicity_queue)) {
-            unsigned var_id = (unsigned) pqueue_pop(s->determinicity_queue);
+            profiler_end(s->profiler, PROFILER_CONSTANT_PROPAGATION);
+        } else if (var_queue_count(s->determinicity_queue)) {
+            unsigned var_id = var_queue_pop(s->determinicity_queue);
             skolem_propagate_determinicity(s, var_id);
-        } else if (pqueue_count(s->pure_var_queue)) {
-            unsigned var_id = (unsigned) pqueue_pop(s->pure_var_queue);
+        } else if (var_queue_count(s->pure_var_queue)) {
+            unsigned var_id = var_queue_pop(s->pure_var_queue);
             skolem_propagate_pure_variable(s, var_id);
         }
     }
@@ -15,12 +15,13 @@
 #include "satsolver.h"
 #include "partial_assignment.h"
 #include "util.h"
-#include "pqueue.h"
+#include "var_queue.h"
 #include "skolem_var_vector.h"
 #include "skolem_dependencies.h"
 #include "skolem_var.h"
 #include "options.h"
 #include "statistics.h"
+#include "profiler.h"
 
 #include <stdio.h>
 
@@ -61,6 +62,7 @@ struct Skolem_Magic_Values {
     float conflict_potential_threshold;
     float conflict_potential_offset;
     unsigned blocked_clause_occurrence_cutoff;
+    unsigned propagations_between_termination_checks;
 };
 
 struct Skolem {
@@ -73,6 +75,7 @@ struct Skolem {
     
     // Core Skolem state and data structures
     unsigned decision_lvl;
+    size_t level0_epoch; // increases when a clause is added or a constant is assigned on decision level 0
     SKOLEM_STATE state;
     unsigned conflict_var_id; // only assigned in case of conflict
     Clause* conflicted_clause; // only assigned in case of conflict
@@ -87,6 +90,9 @@ struct Skolem {
     int_vector* decision_satlits; // contains var_id of temporary vars; required e.g. for functional synthesis
     int_vector* decisions;
     int_vector* determinization_order; // stores all determinizations in the order they happened
+    // Sparse set of the existentials that are not yet deterministic; allows O(1) random picks
+    int_vector* nondeterministic_vars; // contains var_ids in no particular order
+    int_vector* nondeterministic_vars_idx; // indexed by var_id; position in nondeterministic_vars, or -1
     int_vector* universals_assumptions;
     
     /* Propagation worklists:
@@ -96,13 +102,20 @@ struct Skolem {
      * if they are pure.
      */
     vector* clauses_to_check; // stores clauses to check for constant propagation
-    pqueue* determinicity_queue; // contains unsigned var_id
-    pqueue* pure_var_queue; // contains unsigned var_id
+    var_queue* determinicity_queue;
+    var_queue* pure_var_queue;
     
     // Configuration
     bool ignore_universal_conflicts;
     bool record_conflicts;
     
+    // Cooperative termination; checked during propagation and passed to the global conflict checks
+    int (*terminate)(void* state); // NULL if unused
+    void* terminate_state;
+    bool interrupted; // a global conflict check was interrupted; the domain is incomplete and must be rebuilt
+    
+    Profiler* profiler; // NULL if not profiling
+    
     // Static objects
     // Helper variables in the SAT solver
     int satlit_true; // this satlit represents constant true; so far always assigned 1
@@ -121,6 +134,7 @@ struct Skolem {
 
 Skolem* skolem_init(QCNF*, Options*);
 void skolem_free(Skolem*);
+void skolem_set_terminate(Skolem*, void* state, int (*terminate)(void* state));
 
 // INTERACTION WITH CONFLICT ANALYSIS
 bool skolem_is_legal_dependence_for_conflict_analysis(void* s, unsigned var_id, unsigned depending_on);
@@ -120,9 +120,9 @@ void skolem_update_dependencies_for_lit(Skolem* s, union Dependencies* aggregate
 }
 
 void skolem_compute_dependencies_for_occs(Skolem* s, union Dependencies* aggregate_dependencies, Lit lit) {
-    vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         Lit uc = skolem_get_unique_consequence(s, c);
         if (uc
             && lit_to_var(uc) == lit_to_var(lit)
@@ -193,9 +193,9 @@ bool skolem_occs_contain_illegal_dependence(Skolem* s, Lit lit) {
     if (qcnf_is_propositional(s->qcnf) || qcnf_is_2QBF(s->qcnf) || qcnf_var_has_unique_maximal_dependency(s->qcnf,lit_to_var(lit))) {
         return false;
     }
-    vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        Clause* c = vector_get(occs, i);
+    occ_vector* occs = qcnf_get_occs_of_lit(s->qcnf, lit);
+    for (unsigned i = 0; i < occ_vector_count(occs); i++) {
+        Clause* c = occ_vector_get(occs, i);
         if (skolem_get_unique_consequence(s, c) == lit) {
             if (skolem_has_illegal_dependence(s, c)) {
                 return true;
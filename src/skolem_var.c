@@ -264,6 +264,44 @@ void skolem_update_deterministic(Skolem* s, unsigned var_id) {
     
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     sv->deterministic = 1;
+    skolem_nondeterministic_vars_remove(s, var_id);
+}
+
+// Not undoable by itself; the set follows the deterministic flag, which is undone in skolem_undo.
+void skolem_nondeterministic_vars_add(Skolem* s, unsigned var_id) {
+    while (int_vector_count(s->nondeterministic_vars_idx) <= var_id) {
+        int_vector_add(s->nondeterministic_vars_idx, -1);
+    }
+    if (int_vector_get(s->nondeterministic_vars_idx, var_id) != -1) {
+        return;
+    }
+    int_vector_set(s->nondeterministic_vars_idx, var_id, (int) int_vector_count(s->nondeterministic_vars));
+    int_vector_add(s->nondeterministic_vars, (int) var_id);
+}
+
+// Swaps the last element into the gap
+void skolem_nondeterministic_vars_remove(Skolem* s, unsigned var_id) {
+    if (var_id >= int_vector_count(s->nondeterministic_vars_idx)
+        || int_vector_get(s->nondeterministic_vars_idx, var_id) == -1) {
+        return;
+    }
+    unsigned idx = (unsigned) int_vector_get(s->nondeterministic_vars_idx, var_id);
+    unsigned last = (unsigned) int_vector_pop(s->nondeterministic_vars);
+    if (last != var_id) {
+        int_vector_set(s->nondeterministic_vars, idx, (int) last);
+        int_vector_set(s->nondeterministic_vars_idx, last, (int) idx);
+    }
+    int_vector_set(s->nondeterministic_vars_idx, var_id, -1);
+}
+
+unsigned skolem_nondeterministic_vars_count(Skolem* s) {
+    return int_vector_count(s->nondeterministic_vars);
+}
+
+unsigned skolem_nondeterministic_vars_get(Skolem* s, unsigned idx) {
+    unsigned var_id = (unsigned) int_vector_get(s->nondeterministic_vars, idx);
+    assert(!skolem_is_deterministic(s, var_id));
+    return var_id;
 }
 void skolem_update_decision(Skolem* s, Lit lit) {
     int_vector_add(s->decisions, lit);
@@ -58,6 +58,10 @@ void skolem_update_satlit(Skolem* s, Lit lit, int new_satlit);
 void skolem_update_pure_pos(Skolem*, unsigned var_id, unsigned pos_lit);
 void skolem_update_pure_neg(Skolem*, unsigned var_id, unsigned pos_lit);
 void skolem_update_deterministic(Skolem*, unsigned var_id);
+void skolem_nondeterministic_vars_add(Skolem*, unsigned var_id);
+void skolem_nondeterministic_vars_remove(Skolem*, unsigned var_id);
+unsigned skolem_nondeterministic_vars_count(Skolem*);
+unsigned skolem_nondeterministic_vars_get(Skolem*, unsigned idx);
 void skolem_update_decision(Skolem*, Lit lit);
 void skolem_update_dependencies(Skolem*, unsigned var_id, union Dependencies deps);
 void skolem_undo_dependencies(Skolem*, void* data);
@@ -6,14 +6,32 @@
 //  Copyright © 2018 UC Berkeley. All rights reserved.
 //
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "log.h"
 #include "util.h"
 #include "cadet2.h"
+#include "cadet_internal.h"
+#include "aiger_utils.h"
+#include "map.h"
+#include "set.h"
+#include "var_queue.h"
+#include "pqueue.h"
+#include "occ_vector.h"
+#include "mersenne_twister.h"
+#include "c2_policy.h"
+#include "c2_rl.h"
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
 
 
 void test_read_and_solve(char* file_name) {
@@ -36,6 +54,479 @@ void test_repeated_solving() {
     }
 }
 
+// forall x exists y. (y | x) & (-y | -x), extended step by step
+void test_incremental_solving() {
+    Options* o = default_options();
+    o->pure_literals = false; // required for existential assumptions
+    C2* c2 = c2_init(o);
+    c2_new_2QBF_variable(c2, true, 1);
+    c2_new_2QBF_variable(c2, false, 2);
+    c2_add_lit(c2, 2); c2_add_lit(c2, 1); c2_add_lit(c2, 0);
+    c2_add_lit(c2, -2); c2_add_lit(c2, -1); c2_add_lit(c2, 0);
+    abortif(c2_sat(c2) != CADET_RESULT_SAT, "Expected SAT.");
+    
+    c2_assume(c2, 2);
+    abortif(c2_sat(c2) != CADET_RESULT_UNSAT, "Expected UNSAT under existential assumption.");
+    abortif(! c2_is_core(c2, 2), "Existential assumption must be in the core.");
+    abortif(c2_val(c2, 1) == -1, "Refutation must not set the universal to false.");
+    abortif(c2_sat(c2) != CADET_RESULT_SAT, "Expected SAT after dropping the assumption.");
+    
+    c2_add_lit(c2, 2); c2_add_lit(c2, -1); c2_add_lit(c2, 0);
+    c2_assume(c2, -1);
+    abortif(c2_sat(c2) != CADET_RESULT_SAT, "Expected SAT under universal assumption.");
+    abortif(! c2_is_core(c2, -1), "Universal assumption must be in the core.");
+    abortif(c2_sat(c2) != CADET_RESULT_UNSAT, "Expected UNSAT after adding a clause.");
+    abortif(c2_val(c2, 1) == -1, "Refutation must not set the universal to false.");
+    c2_free(c2);
+    V0("Incremental solving test passed.\n");
+}
+
+// forall x1 x2 exists y. (x1 | -y) propagates -y on lvl 1; the learnt clause (x1 | y) was
+// inserted on lvl 2 above its backjumping lvl 1 and is in conflict when re-added on lvl 1.
+void test_out_of_order_conflict() {
+    Options* o = default_options();
+    o->pure_literals = false;
+    C2* c2 = c2_init(o);
+    c2_new_2QBF_variable(c2, true, 1);
+    c2_new_2QBF_variable(c2, true, 2);
+    c2_new_2QBF_variable(c2, false, 3);
+    c2_add_lit(c2, 1); c2_add_lit(c2, -3); c2_add_lit(c2, 0);
+    skolem_propagate(c2->skolem);
+    for (Lit assumption = -1; assumption >= -2; assumption--) {
+        skolem_push(c2->skolem);
+        examples_push(c2->examples);
+        skolem_increase_decision_lvl(c2->skolem);
+        skolem_make_universal_assumption(c2->skolem, assumption);
+        skolem_propagate(c2->skolem);
+    }
+    abortif(skolem_is_conflicted(c2->skolem), "Expected no conflict on lvl 2.");
+    
+    qcnf_add_lit(c2->qcnf, 1); qcnf_add_lit(c2->qcnf, 3);
+    Clause* learnt = qcnf_close_clause(c2->qcnf);
+    learnt->original = false;
+    int_vector_add(c2->out_of_order_clauses, (int) learnt->clause_idx);
+    int_vector_add(c2->out_of_order_clauses, 1);
+    int_vector_add(c2->out_of_order_clauses, 2);
+    
+    abortif(c2_backtrack_to_decision_lvl(c2, 1), "Backtracking must report the conflict of the re-added clause.");
+    abortif(c2->skolem->decision_lvl != 1, "The conflict is on the backjumping lvl.");
+    abortif(c2->state != C2_SKOLEM_CONFLICT, "A conflict above the restart base lvl is not permanent.");
+    abortif(! c2_backtrack_to_decision_lvl(c2, 0), "The clause is in order on lvl 0.");
+    abortif(c2->state != C2_READY, "Expected to be ready on lvl 0.");
+    abortif(int_vector_count(c2->out_of_order_clauses) != 0, "Clauses on their backjumping lvl are in order.");
+    c2_free(c2);
+    options_free(o);
+    V0("Out-of-order clause test passed.\n");
+}
+
+// forall x exists y2 y3 y4 y5. two independent partitions {y2, y4} and {y3, y5}
+void test_miniscoping() {
+    for (unsigned refute = 0; refute < 2; refute++) {
+        Options* o = default_options();
+        o->miniscoping = true;
+        C2* c2 = c2_init(o);
+        c2_new_2QBF_variable(c2, true, 1);
+        for (unsigned var_id = 2; var_id <= 5; var_id++) {
+            c2_new_2QBF_variable(c2, false, var_id);
+        }
+        for (int y = 2; y <= 3; y++) {
+            c2_add_lit(c2, y); c2_add_lit(c2, y + 2); c2_add_lit(c2, 1); c2_add_lit(c2, 0);
+            c2_add_lit(c2, -y); c2_add_lit(c2, -y - 2); c2_add_lit(c2, -1); c2_add_lit(c2, 0);
+        }
+        if (refute) {
+            c2_add_lit(c2, 3); c2_add_lit(c2, 5); c2_add_lit(c2, 0);
+            c2_add_lit(c2, -3); c2_add_lit(c2, -5); c2_add_lit(c2, 0);
+            c2_add_lit(c2, 3); c2_add_lit(c2, -5); c2_add_lit(c2, 0);
+            c2_add_lit(c2, -3); c2_add_lit(c2, 5); c2_add_lit(c2, 0);
+        }
+        cadet_res expected = refute ? CADET_RESULT_UNSAT : CADET_RESULT_SAT;
+        abortif(c2_sat(c2) != expected, "Expected %s for the partitioned formula.", refute ? "UNSAT" : "SAT");
+        c2_free(c2);
+        options_free(o);
+    }
+    V0("Miniscoping test passed.\n");
+}
+
+void test_decision_policy() {
+    // Linear: prefers negative occurrences. MLP: one hidden unit passing on the positive occurrences.
+    const char* policies[2] = {
+        "cadet_policy 6 0\n0 0 1 0 0 0\n0\n",
+        "cadet_policy 6 1\n0 1 0 0 0 0\n0\n1\n0\n"
+    };
+    int expected_picks[2] = {3, 2};
+    for (unsigned k = 0; k < 2; k++) {
+        char file_name[] = "/tmp/cadet_policy_XXXXXX";
+        int fd = mkstemp(file_name);
+        abortif(fd < 0, "Could not create temporary policy file.");
+        FILE* f = fdopen(fd, "w");
+        fputs(policies[k], f);
+        fclose(f);
+
+        for (unsigned refute = 0; refute < 2; refute++) {
+            Options* o = default_options();
+            o->decision_policy_file_name = file_name;
+            C2* c2 = c2_init(o);
+            c2_new_2QBF_variable(c2, true, 1);
+            for (unsigned var_id = 2; var_id <= 5; var_id++) {
+                c2_new_2QBF_variable(c2, false, var_id);
+            }
+            // var 2 occurs positively three times, var 3 occurs negatively three times
+            c2_add_lit(c2, 2); c2_add_lit(c2, 4); c2_add_lit(c2, 1); c2_add_lit(c2, 0);
+            c2_add_lit(c2, 2); c2_add_lit(c2, -3); c2_add_lit(c2, 5); c2_add_lit(c2, 0);
+            c2_add_lit(c2, 2); c2_add_lit(c2, -3); c2_add_lit(c2, -5); c2_add_lit(c2, 0);
+            c2_add_lit(c2, -3); c2_add_lit(c2, -4); c2_add_lit(c2, -1); c2_add_lit(c2, 0);
+            if (refute) {
+                c2_add_lit(c2, -2); c2_add_lit(c2, 0);
+                c2_add_lit(c2, 3); c2_add_lit(c2, 0);
+            }
+            if (!refute) {
+                Var* picked = c2_pick_policy_variable(c2);
+                abortif(picked == NULL || picked->var_id != (unsigned) expected_picks[k],
+                        "Decision policy picked the wrong variable.");
+            }
+            cadet_res expected = refute ? CADET_RESULT_UNSAT : CADET_RESULT_SAT;
+            abortif(c2_sat(c2) != expected, "Wrong result with decision policy.");
+            c2_free(c2);
+            options_free(o);
+        }
+        remove(file_name);
+    }
+    V0("Decision policy test passed.\n");
+}
+
+// Evaluates the first output of the aiger; values is indexed by variables and holds the inputs
+static bool test_evaluate_aiger(aiger* a, bool* values) {
+    values[0] = false;
+    for (unsigned i = 0; i < a->num_ands; i++) {
+        aiger_and g = a->ands[i];
+        bool rhs0 = values[aiger_lit2var(g.rhs0)] != aiger_sign(g.rhs0);
+        bool rhs1 = values[aiger_lit2var(g.rhs1)] != aiger_sign(g.rhs1);
+        values[aiger_lit2var(g.lhs)] = rhs0 && rhs1;
+    }
+    unsigned out = a->outputs[0].lit;
+    return values[aiger_lit2var(out)] != aiger_sign(out);
+}
+
+// Uncontrollable inputs x1 (2) and x2 (4), controllable input y (6)
+void test_quantifier_elimination() {
+    for (unsigned contradiction = 0; contradiction < 2; contradiction++) {
+        aiger* aig = aiger_init();
+        aiger_add_input(aig, 2, "x1");
+        aiger_add_input(aig, 4, "x2");
+        aiger_add_input(aig, 6, "2 y");
+        aiger_add_and(aig, 8, 2, 6);   // x1 & y
+        aiger_add_and(aig, 10, 4, 7);  // x2 & !y
+        if (contradiction) {
+            aiger_add_and(aig, 12, 8, 10);
+            aiger_add_output(aig, 12, "out");
+        } else {
+            aiger_add_and(aig, 12, 9, 11);
+            aiger_add_output(aig, 13, "out"); // (x1 & y) | (x2 & !y)
+        }
+        
+        Options* o = default_options();
+        aiger* projection = c2_qaiger_quantifier_elimination(aig, NULL, o);
+        abortif(projection == NULL, "Quantifier elimination was interrupted.");
+        abortif(projection->num_inputs != 2 || projection->num_outputs != 1, "Projection must have the uncontrollable inputs and one output.");
+        for (unsigned x = 0; x < 4; x++) {
+            bool* values = calloc(projection->maxvar + 1, sizeof(bool));
+            values[1] = x & 1;
+            values[2] = (x >> 1) & 1;
+            bool expected = contradiction ? false : (values[1] || values[2]);
+            abortif(test_evaluate_aiger(projection, values) != expected, "Wrong projection for x1=%u x2=%u.", x & 1, x >> 1);
+            free(values);
+        }
+        aiger_reset(projection);
+        aiger_reset(aig);
+        options_free(o);
+    }
+    V0("Quantifier elimination test passed.\n");
+}
+
+typedef struct {
+    int fd;
+    char* file_name;
+    unsigned file_requests;
+    unsigned states;
+    unsigned decisions;
+    int result;
+    unsigned rewards;
+} RL_Test_Trainer;
+
+static bool test_rl_read_words(int fd, int* words, unsigned num) {
+    char* data = (char*) words;
+    size_t remaining = sizeof(int) * num;
+    while (remaining > 0) {
+        ssize_t received = recv(fd, data, remaining, 0);
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        remaining -= (size_t) received;
+    }
+    return true;
+}
+
+static void test_rl_send_record(int fd, rl_record_type type, int* payload, unsigned payload_words) {
+    int header[2] = {(int) type, (int) payload_words};
+    abortif(send(fd, header, sizeof(header), 0) != sizeof(header), "Trainer could not send a record.");
+    if (payload_words > 0) {
+        ssize_t size = (ssize_t) (sizeof(int) * payload_words);
+        abortif(send(fd, payload, (size_t) size, 0) != size, "Trainer could not send a record.");
+    }
+}
+
+// Plays the trainer: sends one file, takes the default decision in every state, and ends the session
+// on the next file request.
+static void* test_rl_trainer(void* arg) {
+    RL_Test_Trainer* t = arg;
+    int header[2];
+    int payload[1024];
+    while (test_rl_read_words(t->fd, header, 2)) {
+        abortif(header[1] < 0 || header[1] > 1024, "Unexpected record length %d.", header[1]);
+        abortif(! test_rl_read_words(t->fd, payload, (unsigned) header[1]), "Connection closed within a record.");
+        switch ((rl_record_type) header[0]) {
+            case RL_RECORD_FILE_REQUEST:
+                t->file_requests += 1;
+                if (t->file_requests == 1) {
+                    int file[64] = {0};
+                    size_t length = strlen(t->file_name);
+                    abortif(length >= sizeof(file) - sizeof(int), "File name too long.");
+                    file[0] = (int) length;
+                    memcpy(file + 1, t->file_name, length);
+                    test_rl_send_record(t->fd, RL_RECORD_FILE, file, 1 + (unsigned) (length + sizeof(int) - 1) / sizeof(int));
+                } else {
+                    int end = 0;
+                    test_rl_send_record(t->fd, RL_RECORD_FILE, &end, 1);
+                }
+                break;
+            case RL_RECORD_STATE:
+                t->states += 1;
+                test_rl_send_record(t->fd, RL_RECORD_DEFAULT_DECISION, NULL, 0);
+                break;
+            case RL_RECORD_DECISION_TAKEN:
+                t->decisions += 1;
+                break;
+            case RL_RECORD_RESULT:
+                t->result = payload[0];
+                break;
+            case RL_RECORD_REWARDS:
+                t->rewards += 1;
+                abortif((unsigned) header[1] != t->decisions, "Expected one reward per decision.");
+                break;
+            default:
+                break;
+        }
+    }
+    close(t->fd);
+    return NULL;
+}
+
+// forall x exists y2 y3. (y2 | y3 | x) & (-y2 | -y3); without pure literals, y2 and y3 need decisions
+void test_rl_socket() {
+    char file_name[] = "/tmp/cadet_rl_test_XXXXXX";
+    int file_fd = mkstemp(file_name);
+    abortif(file_fd < 0, "Could not create a temporary file: %s", strerror(errno));
+    const char* formula = "p cnf 3 2\na 1 0\ne 2 3 0\n2 3 1 0\n-2 -3 0\n";
+    abortif(write(file_fd, formula, strlen(formula)) != (ssize_t) strlen(formula), "Could not write the formula.");
+    close(file_fd);
+    
+    int fds[2];
+    abortif(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0, "Could not create a socket pair: %s", strerror(errno));
+    RL_Test_Trainer t = {fds[1], file_name, 0, 0, 0, -1, 0};
+    pthread_t trainer;
+    abortif(pthread_create(&trainer, NULL, test_rl_trainer, &t) != 0, "Could not start the trainer.");
+    
+    Options* o = default_options();
+    o->reinforcement_learning = true;
+    o->pure_literals = false;
+    o->cegar = false;
+    o->casesplits = false;
+    rl_socket_attach(fds[0]);
+    c2_rl_run_c2(o);
+    pthread_join(trainer, NULL);
+    options_free(o);
+    unlink(file_name);
+    
+    abortif(t.file_requests != 2, "Expected a file request before and after the episode.");
+    abortif(t.states == 0 || t.decisions != t.states, "Expected a decision for every state.");
+    abortif(t.result != CADET_RESULT_SAT, "Expected SAT as the result of the episode.");
+    abortif(t.rewards != 1, "Expected the rewards of the episode.");
+    V0("RL socket test passed.\n");
+}
+
+// Inputs 2, 4, 6
+void test_aiger_builder() {
+    AigerBuilder* b = aigeru_builder_init(6);
+    aigeru_add_input(b, 2, "x");
+    aigeru_add_input(b, 4, "y");
+    aigeru_add_input(b, 6, "z");
+    unsigned x = 2, y = 4, z = 6;
+    abortif(aigeru_AND(b, x, aiger_true) != x, "Constant folding failed.");
+    abortif(aigeru_AND(b, x, negate(x)) != aiger_false, "Complementary inputs must fold to false.");
+    unsigned xy = aigeru_AND(b, x, y);
+    abortif(aigeru_AND(b, y, x) != xy, "Structural hashing failed.");
+    abortif(aigeru_AND(b, xy, x) != xy, "Idempotence rule failed.");
+    abortif(aigeru_AND(b, xy, negate(y)) != aiger_false, "Contradiction rule failed.");
+    abortif(aigeru_AND(b, negate(xy), negate(x)) != negate(x), "Subsumption rule failed.");
+    abortif(aigeru_AND(b, negate(xy), x) != aigeru_AND(b, x, negate(y)), "Substitution rule failed.");
+    unsigned xz = aigeru_AND(b, x, z);
+    unsigned x_notz = aigeru_AND(b, x, negate(z));
+    abortif(aigeru_AND(b, negate(xz), negate(x_notz)) != negate(x), "Resolution rule failed.");
+    abortif(aigeru_gates_num(b) != 4, "Expected exactly four gates.");
+    
+    // Both formats must read back as the same circuit
+    aigeru_add_output(b, negate(aigeru_OR(b, negate(xz), y)), "o");
+    for (unsigned binary = 0; binary <= 1; binary++) {
+        FILE* file = tmpfile();
+        abortif(!aigeru_write(b, file, binary), "Writing the AIG failed.");
+        rewind(file);
+        aiger* a = aiger_init();
+        const char* err = aiger_read_from_file(a, file);
+        abortif(err, "Cannot read written AIG: %s", err);
+        abortif(a->num_inputs != 3 || a->num_outputs != 1 || a->num_ands != 5, "Written AIG differs.");
+        abortif(strcmp(a->inputs[1].name, "y") != 0 || strcmp(a->outputs[0].name, "o") != 0, "Symbols missing.");
+        aiger_reset(a);
+        fclose(file);
+    }
+    aigeru_builder_free(b);
+    V0("AIG builder test passed.\n");
+}
+
+// Random operations against a reference array; removals exercise the backward shift
+void test_map_and_set() {
+    const int keys = 1000;
+    void** reference = calloc((size_t) keys, sizeof(void*));
+    char* members = calloc((size_t) keys, sizeof(char));
+    MersenneTwister* mt = mersenne_twister_init(1);
+    map* m = map_init();
+    set* s = set_init();
+    size_t count = 0;
+    for (unsigned i = 0; i < 200000; i++) {
+        int k = (int) (genrand_int32(mt) % (unsigned) keys);
+        int key = k - keys / 2; // negative keys, too
+        void* ptr = &members[k];
+        switch (genrand_int32(mt) % 8) {
+            case 0: case 1: case 2:
+                if (reference[k] == NULL) {
+                    reference[k] = (void*) (size_t) (i + 1);
+                    map_add(m, key, reference[k]);
+                    set_add(s, ptr);
+                    count++;
+                }
+                break;
+            case 3: case 4:
+                if (reference[k] != NULL) {
+                    reference[k] = NULL;
+                    count--;
+                }
+                map_remove(m, key);
+                if (set_contains(s, ptr)) {set_remove(s, ptr);}
+                break;
+            case 5:
+                if (reference[k] != NULL) {
+                    reference[k] = (void*) (size_t) (i + 1);
+                    map_update(m, key, reference[k]);
+                }
+                break;
+            default:
+                break;
+        }
+        if (i % 10000 == 7) {
+            map_reset(m);
+            set_reset(s);
+            memset(reference, 0, sizeof(void*) * (size_t) keys);
+            count = 0;
+        }
+        abortif(map_count(m) != count || set_count(s) != count, "Wrong count in map or set.");
+        abortif(map_contains(m, key) != (reference[k] != NULL), "Map membership differs from reference.");
+        abortif(set_contains(s, ptr) != (reference[k] != NULL), "Set membership differs from reference.");
+        abortif(reference[k] != NULL && map_get(m, key) != reference[k], "Map returned wrong data.");
+    }
+    for (int k = 0; k < keys; k++) {
+        abortif(map_contains(m, k - keys / 2) != (reference[k] != NULL), "Map membership differs from reference.");
+        abortif(set_contains(s, &members[k]) != (reference[k] != NULL), "Set membership differs from reference.");
+    }
+    map_free(m);
+    set_free(s);
+    mersenne_twister_free(mt);
+    free(members);
+    free(reference);
+    V0("Map and set test passed.\n");
+}
+
+// Pops must come in the order of pqueue, which var_queue replaced in the Skolem domain
+void test_var_queue() {
+    var_queue* q = var_queue_init();
+    pqueue* reference = pqueue_init();
+    MersenneTwister* mt = mersenne_twister_init(1);
+    for (unsigned round = 0; round < 100; round++) {
+        for (unsigned i = 0; i < 300; i++) {
+            unsigned v = genrand_int32(mt) % 100;
+            int priority = (int) (genrand_int32(mt) % 50);
+            var_queue_push(q, priority, v);
+            pqueue_push(reference, priority, (void*) (size_t) (v + 1));
+            abortif(! var_queue_contains(q, v), "Pushed variable must be in the queue.");
+            if (i % 7 == 6) { // interleave pops with the pushes
+                unsigned popped = var_queue_pop(q);
+                abortif(popped + 1 != (size_t) pqueue_pop(reference), "Variable popped out of order.");
+                abortif(var_queue_contains(q, popped), "Popped variable must not be in the queue.");
+            }
+        }
+        abortif(var_queue_count(q) != pqueue_count(reference), "Queue has the wrong size.");
+        if (round % 2 == 1) {
+            var_queue_reset(q);
+            pqueue_reset(reference);
+            for (unsigned v = 0; v < 100; v++) {
+                abortif(var_queue_contains(q, v), "Queue must be empty after reset.");
+            }
+            continue;
+        }
+        while (var_queue_count(q) > 0) {
+            unsigned v = var_queue_pop(q);
+            abortif(v + 1 != (size_t) pqueue_pop(reference), "Variable popped out of order.");
+        }
+    }
+    mersenne_twister_free(mt);
+    pqueue_free(reference);
+    var_queue_free(q);
+    V0("Variable queue test passed.\n");
+}
+
+// Grows an occurrence list past the inline storage and shrinks it again
+void test_occ_vector() {
+    Clause* clauses[3 * OCC_VECTOR_INLINE];
+    occ_vector v;
+    occ_vector_init_struct(&v);
+    for (unsigned i = 0; i < 3 * OCC_VECTOR_INLINE; i++) {
+        clauses[i] = (Clause*) (size_t) (16 * (i + 1));
+        occ_vector_add(&v, clauses[i]);
+        for (unsigned j = 0; j <= i; j++) {
+            abortif(occ_vector_get(&v, j) != clauses[j], "Occurrence list lost an element.");
+        }
+    }
+    for (unsigned i = 0; i < 3 * OCC_VECTOR_INLINE; i += 2) {
+        abortif(! occ_vector_remove_unsorted(&v, clauses[i]), "Could not remove occurrence.");
+    }
+    abortif(occ_vector_count(&v) != 3 * OCC_VECTOR_INLINE / 2, "Wrong number of occurrences.");
+    for (unsigned i = 0; i < 3 * OCC_VECTOR_INLINE; i++) {
+        abortif(occ_vector_contains(&v, clauses[i]) != (i % 2 == 1), "Wrong occurrences after removal.");
+    }
+    occ_vector_free_data(&v);
+    abortif(occ_vector_count(&v) != 0, "Occurrence list not empty after freeing.");
+    V0("Occurrence list test passed.\n");
+}
+
 void test_all() {
+    test_map_and_set();
+    test_var_queue();
+    test_occ_vector();
+    test_aiger_builder();
+    test_incremental_solving();
+    test_out_of_order_conflict();
+    test_miniscoping();
+    test_decision_policy();
+    test_quantifier_elimination();
+    test_rl_socket();
     test_repeated_solving();
 }
@@ -0,0 +1,113 @@
+//
+//  var_queue.c
+//  cadet
+//
+
+#include "var_queue.h"
+#include "log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+var_queue* var_queue_init() {
+    var_queue* q = malloc(sizeof(var_queue));
+    q->size = 16;
+    q->nodes = malloc(sizeof(var_queue_node) * q->size);
+    q->len = 0;
+    q->position_size = 16;
+    q->position = calloc(q->position_size, sizeof(unsigned));
+    return q;
+}
+
+void var_queue_free(var_queue* q) {
+    free(q->nodes);
+    free(q->position);
+    free(q);
+}
+
+unsigned var_queue_count(var_queue* q) {
+    return q->len;
+}
+
+bool var_queue_contains(var_queue* q, unsigned var_id) {
+    return var_id < q->position_size && q->position[var_id] != 0;
+}
+
+static void var_queue_place(var_queue* q, unsigned i, var_queue_node n) {
+    q->nodes[i] = n;
+    q->position[n.var_id] = i;
+}
+
+static void var_queue_sift_up(var_queue* q, unsigned i, var_queue_node n) {
+    unsigned j = i / 2;
+    while (i > 1 && q->nodes[j].priority > n.priority) {
+        var_queue_place(q, i, q->nodes[j]);
+        i = j;
+        j = j / 2;
+    }
+    var_queue_place(q, i, n);
+}
+
+void var_queue_push(var_queue* q, int priority, unsigned var_id) {
+    if (var_id >= q->position_size) {
+        unsigned old_size = q->position_size;
+        while (q->position_size <= var_id) {
+            q->position_size *= 2;
+        }
+        q->position = realloc(q->position, sizeof(unsigned) * q->position_size);
+        memset(q->position + old_size, 0, sizeof(unsigned) * (q->position_size - old_size));
+    }
+    var_queue_node n;
+    n.priority = priority;
+    n.var_id = var_id;
+    if (q->position[var_id] != 0) {
+        return;
+    }
+    if (q->len + 1 >= q->size) {
+        q->size *= 2;
+        q->nodes = realloc(q->nodes, sizeof(var_queue_node) * q->size);
+    }
+    q->len++;
+    var_queue_sift_up(q, q->len, n);
+}
+
+unsigned var_queue_pop(var_queue* q) {
+    abortif(q->len == 0, "var_queue is empty!");
+    unsigned var_id = q->nodes[1].var_id;
+    q->position[var_id] = 0;
+    var_queue_node last = q->nodes[q->len];
+    q->len--;
+    if (q->len == 0) {
+        return var_id;
+    }
+    // The order of pqueue_pop, which the propagation order was tuned with: below the root the
+    // children are compared to the child that moved up, not to the last element.
+    unsigned i = 1;
+    while (true) {
+        unsigned k = i;
+        unsigned j = 2 * i;
+        int k_priority = i == 1 ? last.priority : q->nodes[i].priority;
+        if (j <= q->len && q->nodes[j].priority < k_priority) {
+            k = j;
+            k_priority = q->nodes[j].priority;
+        }
+        if (j + 1 <= q->len && q->nodes[j + 1].priority < k_priority) {
+            k = j + 1;
+        }
+        if (k == i) {
+            break;
+        }
+        var_queue_place(q, i, q->nodes[k]);
+        i = k;
+    }
+    var_queue_place(q, i, last);
+    return var_id;
+}
+
+void var_queue_reset(var_queue* q) {
+    for (unsigned i = 1; i <= q->len; i++) {
+        q->position[q->nodes[i].var_id] = 0;
+    }
+    q->len = 0;
+}
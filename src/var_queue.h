@@ -0,0 +1,40 @@
+//
+//  var_queue.h
+//  cadet
+//
+//  Priority queue over variable ids for the worklists of the Skolem domain.
+//  A binary heap whose positions are indexed by var_id, so membership and
+//  duplicate suppression need no hashing. Resetting the queue only touches
+//  the variables it contains. Pushes and pops visit the variables in exactly
+//  the order of pqueue.
+//
+
+#ifndef var_queue_h
+#define var_queue_h
+
+#include <stdbool.h>
+
+typedef struct {
+    int priority;
+    unsigned var_id;
+} var_queue_node;
+
+typedef struct {
+    var_queue_node* nodes; // 1-based heap
+    unsigned len;
+    unsigned size;
+    unsigned* position; // heap position of each var_id; 0 if not in the queue
+    unsigned position_size;
+} var_queue;
+
+var_queue* var_queue_init();
+void var_queue_free(var_queue*);
+unsigned var_queue_count(var_queue*);
+bool var_queue_contains(var_queue*, unsigned var_id);
+// Adds the variable unless it is already in the queue
+void var_queue_push(var_queue*, int priority, unsigned var_id);
+// Returns the variable pqueue_pop would return; usually one of minimal priority
+unsigned var_queue_pop(var_queue*);
+void var_queue_reset(var_queue*);
+
+#endif /* var_queue_h */